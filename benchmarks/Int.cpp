@@ -0,0 +1,91 @@
+#include "gauss/Algebra/Int.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Compares the 30 bits and the 62 bits backends of bint, every
+// operation is timed on random numbers with the same number of bits.
+
+typedef bint<30> bint30;
+__extension__ typedef bint<62, uint64_t, unsigned __int128, int64_t, __int128>
+    bint62;
+
+template <typename B> B *random_bint(size_t bits, unsigned long long *seed) {
+  const size_t exp = sizeof(typename B::digit_t) == 8 ? 62 : 30;
+
+  size_t n = (bits + exp - 1) / exp;
+
+  B *a = new B();
+
+  a->resize(n);
+
+  for (size_t i = 0; i < n; i++) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    unsigned long long v = *seed >> 32;
+
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    v = (v << 32) | (*seed >> 32);
+
+    a->digit[i] = (typename B::digit_t)(v & ((1ULL << exp) - 1));
+  }
+
+  a->digit[n - 1] |= 1;
+  a->trim();
+
+  return a;
+}
+
+template <typename F> double time(F f) {
+  size_t reps = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  auto t1 = t0;
+
+  do {
+    f();
+    reps++;
+    t1 = std::chrono::steady_clock::now();
+  } while (std::chrono::duration<double>(t1 - t0).count() < 0.2);
+
+  return std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+}
+
+template <typename B> void run(const char *name, size_t bits) {
+  unsigned long long seed = 42;
+
+  B *a = random_bint<B>(bits, &seed);
+  B *b = random_bint<B>(bits / 2, &seed);
+  B *c = new B();
+  B *d = new B();
+
+  double add = time([&]() { B::add(a, b, c); });
+  double mul = time([&]() { B::mul(a, a, c); });
+  double div = time([&]() { B::div(a, b, c, d); });
+  double gcd = time([&]() { delete B::gcd(a, b); });
+  double str = time([&]() { a->to_string(); });
+
+  printf("%-7s %8zu %10.2f %12.2f %12.2f %12.2f %12.2f\n", name, bits, add,
+         mul, div, gcd, str);
+
+  delete a;
+  delete b;
+  delete c;
+  delete d;
+}
+
+int main() {
+  size_t bits[] = {128, 256, 1024, 8192, 65536, 524288};
+
+  printf("%-7s %8s %10s %12s %12s %12s %12s\n", "backend", "bits", "add(us)",
+         "sqr(us)", "div(us)", "gcd(us)", "string(us)");
+
+  for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); i++) {
+    run<bint30>("bint30", bits[i]);
+    run<bint62>("bint62", bits[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "Arena.hpp"
+
+#include <cstdlib>
+
+namespace alg {
+
+// Every allocation is preceded by a header telling where it came from,
+// so the memory can be released after the arena that was active when
+// it was allocated is not the current one anymore.
+static const size_t header = 16;
+
+static const size_t from_heap = 0;
+static const size_t from_arena = 1;
+
+static thread_local arena *active = 0;
+
+arena::arena(size_t block_size)
+    : block_size(block_size), bytes(0), top(0), end(0) {}
+
+arena::~arena() {
+  for (size_t i = 0; i < blocks.size(); i++) {
+    free(blocks[i]);
+  }
+}
+
+void *arena::alloc(size_t n) {
+  // keeps the returned addresses aligned to 16 bytes
+  n = (n + 15) & ~(size_t)15;
+
+  bytes += n;
+
+  if ((size_t)(end - top) < n) {
+    // big requests get their own block, so the current one is not
+    // wasted
+    if (n > block_size / 4) {
+      char *b = (char *)malloc(n);
+
+      if (!b) {
+        throw std::bad_alloc();
+      }
+
+      blocks.push_back(b);
+
+      return b;
+    }
+
+    top = (char *)malloc(block_size);
+
+    if (!top) {
+      throw std::bad_alloc();
+    }
+
+    end = top + block_size;
+
+    blocks.push_back(top);
+  }
+
+  void *p = top;
+
+  top += n;
+
+  return p;
+}
+
+arena *arena::current() { return active; }
+
+arena *arena::activate(arena *a) {
+  arena *p = active;
+
+  active = a;
+
+  return p;
+}
+
+void *arena_alloc(size_t bytes) {
+  char *p;
+
+  if (active) {
+    p = (char *)active->alloc(bytes + header);
+
+    *(size_t *)p = from_arena;
+  } else {
+    p = (char *)malloc(bytes + header);
+
+    if (!p) {
+      throw std::bad_alloc();
+    }
+
+    *(size_t *)p = from_heap;
+  }
+
+  return p + header;
+}
+
+void arena_free(void *p) {
+  if (!p) {
+    return;
+  }
+
+  char *h = (char *)p - header;
+
+  // arena memory is released with the arena
+  if (*(size_t *)h == from_heap) {
+    free(h);
+  }
+}
+
+bool arena_owned(const void *p) {
+  return *(const size_t *)((const char *)p - header) == from_arena;
+}
+
+} // namespace alg
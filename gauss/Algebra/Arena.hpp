@@ -0,0 +1,78 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace alg {
+
+// Bump allocator for the memory of the expressions created during a
+// computation. While an arena is active on a thread, the operand
+// buffers and the integer boxes of the expressions created on that
+// thread are allocated from it, freeing them does nothing, and all the
+// memory is released at once when the arena is destroyed. Arenas are
+// activated by gauss::ArenaScope.
+class arena {
+public:
+  arena(size_t block_size = 1 << 20);
+  ~arena();
+
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+
+  void *alloc(size_t bytes);
+
+  // total number of bytes handed out by the arena
+  size_t used() const { return bytes; }
+
+  // arena of the current thread, null if there is none
+  static arena *current();
+
+  // makes a the arena of the current thread and returns the previous
+  // one, that should be restored when a stops being used
+  static arena *activate(arena *a);
+
+private:
+  size_t block_size;
+  size_t bytes;
+
+  char *top;
+  char *end;
+
+  std::vector<char *> blocks;
+};
+
+// Stops the arena of the current thread from being used until it is
+// destroyed, the memory allocated meanwhile comes from the heap and
+// can outlive the arena.
+struct arena_suspend {
+  arena *saved;
+
+  arena_suspend() : saved(arena::activate(0)) {}
+  ~arena_suspend() { arena::activate(saved); }
+};
+
+// memory from the arena of the current thread, or from the heap if
+// there is none, it should be released with arena_free
+void *arena_alloc(size_t bytes);
+void arena_free(void *p);
+
+// true if p was returned by arena_alloc while an arena was active
+bool arena_owned(const void *p);
+
+template <class T, class... A> T *arena_new(A &&...args) {
+  return new (arena_alloc(sizeof(T))) T(std::forward<A>(args)...);
+}
+
+template <class T> void arena_delete(T *p) {
+  if (p) {
+    p->~T();
+    arena_free(p);
+  }
+}
+
+} // namespace alg
+
+#endif
@@ -4,6 +4,7 @@
 #include "Utils.hpp"
 #include "Sorting.hpp"
 #include "Reduction.hpp"
+#include "Memo.hpp"
 
 #include <iostream>
 #include <algorithm>
@@ -16,7 +17,9 @@
 #include <initializer_list>
 #include <limits>
 #include <math.h>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -36,6 +39,652 @@ Int columns(expr a) {
 }
 
 
+// Interned nodes by hash, the table is never destroyed since interned
+// expressions may be alive until the end of the program.
+struct node_table {
+  std::mutex lock;
+  std::unordered_multimap<size_t, expr_node *> nodes;
+};
+
+static node_table &interned() {
+  static node_table *t = new node_table();
+  return *t;
+}
+
+static inline size_t hash_combine(size_t h, size_t v) {
+  return h ^ (v + (size_t)0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+static size_t hash_int(const Int &v) {
+  long long x = v.x;
+
+  if (v.flag && Int::bint_t::to_long(v.val, &x) != 1) {
+    size_t h = v.val->sign;
+
+    for (size_t i = 0; i < v.val->size; i++) {
+      h = hash_combine(h, v.val->digit[i]);
+    }
+
+    return h;
+  }
+
+  return std::hash<long long>()(x);
+}
+
+// finalizer of splitmix64, spreads the bits of h before the hashes of
+// the operands are added
+static inline size_t mix(uint64_t h) {
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+
+  return (size_t)(h ^ (h >> 31));
+}
+
+size_t structural_hash(const expr &u);
+
+static size_t hash_of_items(const expr_node *n) {
+  size_t s = 0;
+
+  for (size_t i = 0; i < n->size; i++) {
+    s += mix(structural_hash(n->items()[i]));
+  }
+
+  return s ? s : 1;
+}
+
+// caches the hash of the items of n, the nodes below it whose hashes
+// are unknown are hashed first with a stack on the heap, so hashing
+// their items doesn't recurse
+static size_t hash_items(expr_node *n) {
+  struct frame {
+    expr_node *n;
+    size_t i;
+  };
+
+  work_stack<frame, 32> stack;
+
+  stack.push_back({n, 0});
+
+  while (!stack.empty()) {
+    frame &f = stack.back();
+
+    if (f.i < f.n->size) {
+      expr_node *m = f.n->items()[f.i++].expr_childs.node;
+
+      if (m && m->items_hash.load(std::memory_order_relaxed) == 0) {
+        stack.push_back({m, 0});
+      }
+    } else {
+      f.n->items_hash.store(hash_of_items(f.n), std::memory_order_relaxed);
+
+      stack.pop_back();
+    }
+  }
+
+  return n->items_hash.load(std::memory_order_relaxed);
+}
+
+size_t structural_hash(const expr &u) {
+  // integers and fractions with the same value are equal
+  if (u.kind_of == kind::INT) {
+    return hash_combine(kind::CONST, hash_int(*u.expr_int));
+  }
+
+  const operand_list &l = u.expr_childs;
+
+  if (u.kind_of == kind::FRAC && l.size() == 2 && l[0].kind_of == kind::INT &&
+      l[1].kind_of == kind::INT && *l[1].expr_int != 0) {
+    Rational v(*l[0].expr_int, *l[1].expr_int);
+
+    size_t h = hash_combine(kind::CONST, hash_int(v.num()));
+
+    return v.isInteger() ? h : hash_combine(h, hash_int(v.den()));
+  }
+
+  size_t h = u.kind_of;
+
+  switch (u.kind_of) {
+  case kind::SYM:
+    return hash_combine(h, u.expr_sym_id);
+
+  // lists and sets are compared member by member and matrices by their
+  // dimensions
+  case kind::LIST:
+    return hash_combine(h, u.expr_list->size());
+
+  case kind::SET:
+    return hash_combine(h, u.expr_set->size());
+
+  case kind::MAT:
+    return hash_combine(hash_combine(h, u.expr_mat->lines()),
+                        u.expr_mat->columns());
+
+  case kind::FUNC:
+    h = hash_combine(h, u.expr_sym_id);
+    break;
+
+  default:
+    break;
+  }
+
+  if (!l.node) {
+    return hash_combine(h, 1);
+  }
+
+  size_t s = l.node->items_hash.load(std::memory_order_relaxed);
+
+  if (s == 0) {
+    s = hash_items(l.node);
+  }
+
+  return hash_combine(h, s);
+}
+
+// hash of an operand whose operands are interned
+static size_t item_hash(const expr &a) {
+  size_t h = a.kind_of;
+
+  if (a.kind_of == kind::INT) {
+    return hash_combine(h, hash_int(*a.expr_int));
+  }
+
+  if (a.kind_of & (kind::SYM | kind::FUNC)) {
+    h = hash_combine(h, a.expr_sym_id);
+  }
+
+  if (a.expr_childs.node) {
+    h = hash_combine(h, a.expr_childs.node->hash);
+  }
+
+  return h;
+}
+
+// equality of two operands whose operands are interned
+static bool item_equals(const expr &a, const expr &b) {
+  if (a.kind_of != b.kind_of) {
+    return false;
+  }
+
+  if (a.kind_of == kind::INT) {
+    return *a.expr_int == *b.expr_int;
+  }
+
+  if ((a.kind_of & (kind::SYM | kind::FUNC)) &&
+      a.expr_sym_id != b.expr_sym_id) {
+    return false;
+  }
+
+  return a.expr_childs.node == b.expr_childs.node;
+}
+
+static bool shares_operands(const expr &a, const expr &b) {
+  return a.expr_childs.node && a.expr_childs.node == b.expr_childs.node &&
+         item_equals(a, b);
+}
+
+// node with room for n operands, interned nodes are allocated while the
+// arena is suspended since they may outlive it
+static expr_node *alloc_node(size_t n) {
+  n = n < 2 ? 2 : n;
+
+  expr_node *r = (expr_node *)arena_alloc(sizeof(expr_node) + n * sizeof(expr));
+
+  new (r) expr_node();
+
+  r->refs.store(0, std::memory_order_relaxed);
+  r->hash = 0;
+  r->items_hash.store(0, std::memory_order_relaxed);
+  r->size = 0;
+  r->capacity = (uint32_t)n;
+
+  return r;
+}
+
+// Copying and freeing the operands recurses on the subexpressions, past
+// max_depth nested calls the nodes are queued instead and handled by the
+// outermost call, so deep trees don't overflow the stack.
+static const unsigned max_depth = 64;
+
+static thread_local unsigned free_depth = 0;
+static thread_local unsigned copy_depth = 0;
+
+// nodes waiting to be freed, linked by their next pointers
+static thread_local expr_node *free_queue = 0;
+
+struct queued_copy {
+  expr_node *to;
+  const expr_node *from;
+
+  // the copies are allocated where the queued node was
+  arena *region;
+};
+
+static std::vector<queued_copy> &copy_queue() {
+  static thread_local std::vector<queued_copy> q;
+  return q;
+}
+
+static void destroy_node(expr_node *n) {
+  expr *e = n->items();
+
+  for (size_t i = 0; i < n->size; i++) {
+    e[i].~expr();
+  }
+
+  n->~expr_node();
+
+  arena_free(n);
+}
+
+static void free_node(expr_node *n) {
+  if (free_depth >= max_depth) {
+    n->next = free_queue;
+    free_queue = n;
+    return;
+  }
+
+  free_depth++;
+
+  destroy_node(n);
+
+  if (free_depth == 1) {
+    while (free_queue) {
+      expr_node *m = free_queue;
+
+      free_queue = m->next;
+
+      destroy_node(m);
+    }
+  }
+
+  free_depth--;
+}
+
+static void copy_items(expr_node *r, const expr_node *n) {
+  const expr *e = n->items();
+
+  for (size_t i = 0; i < n->size; i++) {
+    new (r->items() + i) expr(e[i]);
+    r->size++;
+  }
+
+  r->items_hash.store(n->items_hash.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+}
+
+// owned copy of the items of n with room for c operands
+static expr_node *copy_node(const expr_node *n, size_t c) {
+  expr_node *r = alloc_node(c);
+
+  if (copy_depth >= max_depth) {
+    copy_queue().push_back({r, n, arena::current()});
+    return r;
+  }
+
+  copy_depth++;
+
+  copy_items(r, n);
+
+  if (copy_depth == 1) {
+    std::vector<queued_copy> &q = copy_queue();
+
+    arena *a = arena::current();
+
+    while (!q.empty()) {
+      queued_copy t = q.back();
+
+      q.pop_back();
+
+      arena::activate(t.region);
+
+      copy_items(t.to, t.from);
+    }
+
+    arena::activate(a);
+  }
+
+  copy_depth--;
+
+  return r;
+}
+
+static void release(expr_node *n) {
+  size_t r = n->refs.load(std::memory_order_relaxed);
+
+  while (r > 1) {
+    if (n->refs.compare_exchange_weak(r, r - 1, std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+
+  // the last reference is released with the table locked, so no other
+  // thread can find the node while it is being removed
+  node_table &t = interned();
+
+  t.lock.lock();
+
+  if (n->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    t.lock.unlock();
+    return;
+  }
+
+  auto range = t.nodes.equal_range(n->hash);
+
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == n) {
+      t.nodes.erase(it);
+      break;
+    }
+  }
+
+  t.lock.unlock();
+
+  free_node(n);
+}
+
+operand_list::operand_list() : node(0) {}
+
+operand_list::operand_list(const operand_list &o) : node(0) {
+  if (o.frozen()) {
+    node = o.node;
+    node->refs.fetch_add(1, std::memory_order_relaxed);
+  } else if (o.node) {
+    node = copy_node(o.node, o.node->size);
+  }
+}
+
+operand_list::operand_list(operand_list &&o) : node(o.node) { o.node = 0; }
+
+operand_list::~operand_list() { clear(); }
+
+operand_list &operand_list::operator=(const operand_list &o) {
+  if (this != &o) {
+    operand_list t(o);
+
+    *this = std::move(t);
+  }
+
+  return *this;
+}
+
+operand_list &operand_list::operator=(operand_list &&o) {
+  if (this != &o) {
+    std::swap(node, o.node);
+  }
+
+  return *this;
+}
+
+operand_list &operand_list::operator=(const std::vector<expr> &v) {
+  clear();
+  reserve(v.size());
+
+  for (size_t i = 0; i < v.size(); i++) {
+    new (node->items() + i) expr(v[i]);
+    node->size++;
+  }
+
+  return *this;
+}
+
+operand_list &operand_list::operator=(std::vector<expr> &&v) {
+  clear();
+  reserve(v.size());
+
+  for (size_t i = 0; i < v.size(); i++) {
+    new (node->items() + i) expr(std::move(v[i]));
+    node->size++;
+  }
+
+  return *this;
+}
+
+operand_list &operand_list::operator=(std::initializer_list<expr> v) {
+  clear();
+  reserve(v.size());
+
+  for (const expr &a : v) {
+    new (node->items() + node->size) expr(a);
+    node->size++;
+  }
+
+  return *this;
+}
+
+void operand_list::thaw() {
+  expr_node *n = frozen();
+
+  if (!n) {
+    return;
+  }
+
+  // the items only hold interned operands, so the copies are cheap
+  node = copy_node(n, n->size);
+
+  release(n);
+}
+
+void operand_list::reserve(size_t n) {
+  thaw();
+
+  if (node && node->capacity >= n) {
+    return;
+  }
+
+  size_t c = node ? node->capacity : 0;
+
+  expr_node *r = alloc_node(n > 2 * c ? n : 2 * c);
+
+  if (node) {
+    expr *e = node->items();
+
+    for (size_t i = 0; i < node->size; i++) {
+      new (r->items() + i) expr(std::move(e[i]));
+      r->size++;
+    }
+
+    free_node(node);
+  }
+
+  node = r;
+}
+
+void operand_list::insert(size_t i, const expr &a) {
+  // a may be one of the operands, that move when the node grows
+  insert(i, expr(a));
+}
+
+void operand_list::insert(size_t i, expr &&a) {
+  reserve(size() + 1);
+
+  node->items_hash.store(0, std::memory_order_relaxed);
+
+  expr *e = node->items();
+
+  size_t n = node->size;
+
+  if (i == n) {
+    new (e + n) expr(std::move(a));
+  } else {
+    new (e + n) expr(std::move(e[n - 1]));
+
+    for (size_t j = n - 1; j > i; j--) {
+      e[j] = std::move(e[j - 1]);
+    }
+
+    e[i] = std::move(a);
+  }
+
+  node->size++;
+}
+
+void operand_list::push_back(const expr &a) { insert(size(), expr(a)); }
+
+void operand_list::push_back(expr &&a) { insert(size(), std::move(a)); }
+
+void operand_list::erase(size_t i) {
+  thaw();
+
+  node->items_hash.store(0, std::memory_order_relaxed);
+
+  expr *e = node->items();
+
+  for (size_t j = i; j + 1 < node->size; j++) {
+    e[j] = std::move(e[j + 1]);
+  }
+
+  e[--node->size].~expr();
+}
+
+void operand_list::pop_back() { erase(size() - 1); }
+
+void operand_list::clear() {
+  if (!node) {
+    return;
+  }
+
+  if (frozen()) {
+    release(node);
+  } else {
+    free_node(node);
+  }
+
+  node = 0;
+}
+
+// interns the owned operands of u, whose operands are interned
+static void intern_node(expr *u) {
+  operand_list &l = u->expr_childs;
+
+  expr *e = l.node->items();
+
+  size_t k = l.node->size;
+
+  size_t h = k;
+
+  for (size_t i = 0; i < k; i++) {
+    h = hash_combine(h, item_hash(e[i]));
+  }
+
+  if (arena_owned(l.node)) {
+    // interned nodes outlive the arena, so the items are copied to the
+    // heap
+    arena_suspend s;
+
+    expr_node *n = copy_node(l.node, k);
+
+    free_node(l.node);
+
+    l.node = n;
+    e = n->items();
+  }
+
+  node_table &t = interned();
+
+  t.lock.lock();
+
+  auto range = t.nodes.equal_range(h);
+
+  for (auto it = range.first; it != range.second; ++it) {
+    expr_node *n = it->second;
+
+    if (n->size != k) {
+      continue;
+    }
+
+    size_t i = 0;
+
+    while (i < k && item_equals(n->items()[i], e[i])) {
+      i++;
+    }
+
+    if (i == k) {
+      n->refs.fetch_add(1, std::memory_order_relaxed);
+
+      t.lock.unlock();
+
+      free_node(l.node);
+
+      l.node = n;
+
+      return;
+    }
+  }
+
+  expr_node *n = l.node;
+
+  n->refs.store(1, std::memory_order_relaxed);
+  n->hash = h;
+
+  t.nodes.insert(std::make_pair(h, n));
+
+  t.lock.unlock();
+}
+
+// returns false if u can't be interned, the owned operands are interned
+// deepest first with a stack on the heap
+static bool intern_rec(expr *u) {
+  if (is(u, kind::LIST | kind::SET | kind::MAT)) {
+    return false;
+  }
+
+  if (!u->expr_childs.node || u->expr_childs.frozen()) {
+    return true;
+  }
+
+  struct frame {
+    expr *u;
+    size_t i;
+    bool ok;
+  };
+
+  work_stack<frame, 32> stack;
+
+  stack.push_back({u, 0, true});
+
+  bool ok = true;
+
+  while (!stack.empty()) {
+    frame &f = stack.back();
+
+    expr_node *n = f.u->expr_childs.node;
+
+    if (f.i < n->size) {
+      expr *v = &n->items()[f.i++];
+
+      if (is(v, kind::LIST | kind::SET | kind::MAT)) {
+        f.ok = false;
+      } else if (v->expr_childs.node && !v->expr_childs.frozen()) {
+        stack.push_back({v, 0, true});
+      }
+    } else {
+      expr *v = f.u;
+
+      ok = f.ok;
+
+      stack.pop_back();
+
+      if (ok) {
+        intern_node(v);
+      }
+
+      if (!stack.empty()) {
+        stack.back().ok = stack.back().ok && ok;
+      }
+    }
+  }
+
+  return ok;
+}
+
+void intern(expr *u) { intern_rec(u); }
+
+expr intern(expr u) {
+  intern_rec(&u);
+
+  return u;
+}
+
 expr::expr(expr &&other) {
   kind_of = other.kind_of;
   expr_info = other.expr_info;
@@ -48,7 +697,7 @@ expr::expr(expr &&other) {
 	// }
   case kind::SYM: {
     expr_sym = other.expr_sym;
-    other.expr_sym = 0;
+    expr_sym_id = other.expr_sym_id;
     return;
   }
   case kind::INT: {
@@ -77,7 +726,7 @@ expr::expr(expr &&other) {
 
   case kind::FUNC: {
     expr_sym = other.expr_sym;
-    other.expr_sym = 0;
+    expr_sym_id = other.expr_sym_id;
     expr_childs = std::move(other.expr_childs);
 
     return;
@@ -147,13 +796,14 @@ expr::expr(const expr &other) {
 	// 	return;
 	// }
   case kind::SYM: {
-    expr_sym = strdup(other.expr_sym);
+    expr_sym = other.expr_sym;
+    expr_sym_id = other.expr_sym_id;
     return;
   }
   case kind::INT: {
     Int &a = *other.expr_int;
 
-    expr_int = new Int(a);
+    expr_int = arena_new<Int>(a);
 
     return;
   }
@@ -169,7 +819,8 @@ expr::expr(const expr &other) {
   }
 
   case kind::FUNC: {
-    expr_sym = strdup(other.expr_sym);
+    expr_sym = other.expr_sym;
+    expr_sym_id = other.expr_sym_id;
 
     expr_childs = other.expr_childs;
 
@@ -248,13 +899,14 @@ expr &expr::operator=(const expr &other) {
 	// 	return *this;
 	// }
   case kind::SYM: {
-    expr_sym = strdup(other.expr_sym);
+    expr_sym = other.expr_sym;
+    expr_sym_id = other.expr_sym_id;
     expr_childs.clear();
     return *this;
   }
 
   case kind::INT: {
-    expr_int = new Int(*other.expr_int);
+    expr_int = arena_new<Int>(*other.expr_int);
     expr_childs.clear();
     return *this;
   }
@@ -272,7 +924,8 @@ expr &expr::operator=(const expr &other) {
   }
 
   case kind::FUNC: {
-    expr_sym = strdup(other.expr_sym);
+    expr_sym = other.expr_sym;
+    expr_sym_id = other.expr_sym_id;
     expr_childs = other.expr_childs;
     return *this;
   }
@@ -358,7 +1011,7 @@ expr &expr::operator=(expr &&other) {
 	// }
   case kind::SYM: {
     expr_sym = other.expr_sym;
-    other.expr_sym = 0;
+    expr_sym_id = other.expr_sym_id;
     return *this;
   }
 
@@ -382,7 +1035,7 @@ expr &expr::operator=(expr &&other) {
 
   case kind::FUNC: {
     expr_sym = other.expr_sym;
-    other.expr_sym = 0;
+    expr_sym_id = other.expr_sym_id;
     expr_childs = std::move(other.expr_childs);
 
     return *this;
@@ -521,31 +1174,31 @@ expr::expr(Int v) {
 
   expr_info = info::EXPANDED | info::REDUCED | info::SORTED;
 
-  this->expr_int = new Int(v);
+  this->expr_int = arena_new<Int>(v);
 }
 
 expr::expr(int v) {
 	kind_of = kind::INT;
   expr_info = info::EXPANDED | info::REDUCED | info::SORTED;
-  this->expr_int = new Int(v);
+  this->expr_int = arena_new<Int>(v);
 }
 
 expr::expr(long int v) {
 	kind_of = kind::INT;
   expr_info = info::EXPANDED | info::REDUCED | info::SORTED;
-  this->expr_int = new Int(v);
+  this->expr_int = arena_new<Int>(v);
 }
 
 expr::expr(long long v) {
   kind_of = kind::INT;
   expr_info = info::EXPANDED | info::REDUCED | info::SORTED;
-  this->expr_int = new Int(v);
+  this->expr_int = arena_new<Int>(v);
 }
 
 expr::expr(std::string v) {
   kind_of = kind::SYM;
   expr_info = info::EXPANDED | info::REDUCED | info::SORTED;
-  this->expr_sym = strdup(v.c_str());
+  this->expr_sym_id = symbol_id(v.c_str(), &this->expr_sym);
 }
 
 expr::expr() {
@@ -640,14 +1293,7 @@ expr::~expr() {
 	// }
   case kind::INT: {
     if (expr_int)
-      delete expr_int;
-    break;
-  }
-
-  case kind::SYM: {
-    if (expr_sym) {
-      free(expr_sym);
-    }
+      arena_delete(expr_int);
     break;
   }
 
@@ -663,13 +1309,6 @@ expr::~expr() {
     break;
   }
 
-  case kind::FUNC: {
-    if (expr_sym) {
-      delete[] expr_sym;
-    }
-    break;
-  }
-
   case kind::MAT: {
     if (expr_mat) {
       delete expr_mat;
@@ -713,7 +1352,7 @@ expr create(kind kind) { return expr(kind); }
 expr func_call(const char *id, std::initializer_list<expr> &&l) {
   expr f = create(kind::FUNC);
 
-  f.expr_sym = strdup(id);
+  f.expr_sym_id = symbol_id(id, &f.expr_sym);
 
   f.expr_childs = std::move(l);
 
@@ -737,7 +1376,7 @@ inline bool is_expanded(expr *a) { return a->expr_info & info::EXPANDED; }
 expr symbol(const char *id) {
   expr a = create(kind::SYM);
 
-  a.expr_sym = strdup(id);
+  a.expr_sym_id = symbol_id(id, &a.expr_sym);
 
   return a;
 }
@@ -745,7 +1384,7 @@ expr symbol(const char *id) {
 expr integer(Int value) {
   expr a = create(kind::INT);
 
-  a.expr_int = new Int(value);
+  a.expr_int = arena_new<Int>(value);
 
   return a;
 }
@@ -754,6 +1393,24 @@ expr fraction(Int num, Int den) {
   return create(kind::FRAC, {integer(num), integer(den)});
 }
 
+expr number(const Rational &v) {
+  if (v.isInteger()) {
+    return integer(v.num());
+  }
+
+  return fraction(v.num(), v.den());
+}
+
+Rational get_rational(expr *a) {
+  assert(is(a, kind::INT | kind::FRAC));
+
+  if (is(a, kind::INT)) {
+    return Rational(*a->expr_int);
+  }
+
+  return Rational(*operand(a, 0)->expr_int, *operand(a, 1)->expr_int);
+}
+
 void expr::insert(const expr &b, size_t idx) {
   assert(!is(this, kind::SET));
 
@@ -763,7 +1420,7 @@ void expr::insert(const expr &b, size_t idx) {
     return this->expr_list->insert(b, idx);
   }
 
-  this->expr_childs.insert(this->expr_childs.begin() + idx, b);
+  this->expr_childs.insert(idx, b);
 }
 
 void expr::insert(expr &&b, size_t idx) {
@@ -775,7 +1432,7 @@ void expr::insert(expr &&b, size_t idx) {
     return this->expr_list->insert(b, idx);
   }
 
-  this->expr_childs.insert(this->expr_childs.begin() + idx, std::move(b));
+  this->expr_childs.insert(idx, std::move(b));
 }
 
 void expr::insert(const expr &b) {
@@ -803,7 +1460,7 @@ void expr::insert(expr &&b) {
     this->expr_set->insert(b);
   }
 
-  this->expr_childs.push_back((b));
+  this->expr_childs.push_back(std::move(b));
 }
 
 void expr::remove(list &l) {
@@ -827,7 +1484,7 @@ void expr::remove(size_t idx) {
     return;
   }
 
-  this->expr_childs.erase(this->expr_childs.begin() + idx);
+  this->expr_childs.erase(idx);
 }
 
 void expr::remove() {
@@ -924,208 +1581,167 @@ std::string kind_of_id(expr *a) {
 
 
 
-std::string to_string(expr *tree) {
-  if (!tree) {
-    return "null";
-	}
-
-	// if (is(tree, kind::ERROR)) {
-	// 	printf("error(%s)\n", error_message(tree));
-	// }
-
-  if (is(tree, kind::MAT)) {
-    return matrixToString(tree->expr_mat);
-  }
-
-  if (is(tree, kind::INT)) {
-    return tree->expr_int->to_string();
-  }
-
-  if (is(tree, kind::SYM)) {
-    return std::string(tree->expr_sym);
-  }
-
-  if (is(tree, kind::UNDEF)) {
-    return "undefined";
-  }
+// Piece of the string of an expression that is still to be written,
+// either a text or an operand.
+struct string_piece {
+  expr *u;
+  const char *s;
+};
 
-  if (is(tree, kind::FAIL)) {
-    return "fail";
-  }
+// pushes u to q, between parentheses if it is of one of the given kinds
+static void push_operand(std::vector<string_piece> &q, expr *u, int kinds) {
+  bool p = is(u, kinds);
 
-  if (is(tree, kind::INF)) {
-    return "inf";
+  if (p) {
+    q.push_back({0, "("});
   }
 
-  if (is(tree, kind::FRAC)) {
-    return to_string(operand(tree, 0)) + "/" + to_string(operand(tree, 1));
-  }
+  q.push_back({u, 0});
 
-  if (is(tree, kind::ROOT)) {
-    return "sqrt(" + to_string(operand(tree, 0)) + "," +  to_string(operand(tree, 1)) + ")";
+  if (p) {
+    q.push_back({0, ")"});
   }
+}
 
-  if (is(tree, kind::FUNC)) {
-    std::string r = std::string(get_func_id(tree)) + "(";
+// pushes the operands of tree to q separated by sep
+static void push_operands(std::vector<string_piece> &q, expr *tree,
+                          const char *sep, int kinds) {
+  for (size_t i = 0; i < size_of(tree); i++) {
+    push_operand(q, operand(tree, i), kinds);
 
-    for (size_t i = 0; i < size_of(tree); i++) {
-      r += to_string(operand(tree, i));
-
-      if (i < size_of(tree) - 1) {
-        r += ", ";
-      }
+    if (i < size_of(tree) - 1) {
+      q.push_back({0, sep});
     }
-
-    r += ")";
-
-    return r;
   }
+}
 
-  if (is(tree, kind::POW)) {
-    std::string r = "";
-
-    if (operand(tree, 0) &&
-        is(operand(tree, 0), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += "(";
-    }
-
-    r += to_string(operand(tree, 0));
-
-    if (operand(tree, 0) &&
-        is(operand(tree, 0), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += ")";
-    }
-
-    r += "^";
-
-    if (operand(tree, 1) &&
-        is(operand(tree, 1), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += "(";
-    }
-
-    r += to_string(operand(tree, 1));
-
-    if (operand(tree, 1) &&
-        is(operand(tree, 1), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += ")";
-    }
-
-    return r;
+// writes the string of a terminal tree to r, the pieces of the other
+// trees are written to q
+static void to_string_node(expr *tree, std::string &r,
+                           std::vector<string_piece> &q) {
+  if (!tree) {
+    r += "null";
+    return;
   }
 
-  if (is(tree, kind::DIV)) {
-    std::string r = "";
-
-    if (is(operand(tree, 0), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += "(";
-    }
-
-    r += to_string(operand(tree, 0));
-
-    if (is(operand(tree, 0), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += ")";
-    }
-
-    r += " ÷ ";
+  int parens = kind::SUB | kind::ADD | kind::MUL | kind::DIV;
 
-    if (is(operand(tree, 1), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += "(";
-    }
-
-    r += to_string(operand(tree, 1));
+  switch (kind_of(tree)) {
+  case kind::MAT:
+    r += matrixToString(tree->expr_mat);
+    return;
 
-    if (is(operand(tree, 1), kind::SUB | kind::ADD | kind::MUL | kind::DIV)) {
-      r += ")";
-    }
+  case kind::INT:
+    r += tree->expr_int->to_string();
+    return;
 
-    return r;
-  }
+  case kind::SYM:
+    r += tree->expr_sym;
+    return;
 
-  if (is(tree, kind::ADD)) {
-    std::string r = "";
+  case kind::UNDEF:
+    r += "undefined";
+    return;
 
-    for (size_t i = 0; i < size_of(tree); i++) {
-      if (operand(tree, i) && is(operand(tree, i), kind::SUB | kind::ADD)) {
+  case kind::FAIL:
+    r += "fail";
+    return;
 
-        r += "(";
-      }
+  case kind::INF:
+    r += "inf";
+    return;
 
-      r += to_string(operand(tree, i));
+  case kind::LIST:
+    r += to_string(tree->expr_list);
+    return;
 
-      if (operand(tree, i) && is(operand(tree, i), kind::SUB | kind::ADD)) {
-        r += ")";
-      }
+  case kind::SET:
+    r += to_string(tree->expr_set);
+    return;
 
-      if (i < size_of(tree) - 1) {
-        r += " + ";
-      }
-    }
+  case kind::FRAC:
+    push_operand(q, operand(tree, 0), 0);
+    q.push_back({0, "/"});
+    push_operand(q, operand(tree, 1), 0);
+    return;
 
-    return r;
-  }
+  case kind::ROOT:
+    q.push_back({0, "sqrt("});
+    push_operand(q, operand(tree, 0), 0);
+    q.push_back({0, ","});
+    push_operand(q, operand(tree, 1), 0);
+    q.push_back({0, ")"});
+    return;
 
-  if (is(tree, kind::SUB)) {
-    std::string r = "";
+  case kind::FUNC:
+    q.push_back({0, get_func_id(tree)});
+    q.push_back({0, "("});
+    push_operands(q, tree, ", ", 0);
+    q.push_back({0, ")"});
+    return;
 
-    for (size_t i = 0; i < size_of(tree); i++) {
-      if (operand(tree, i) && is(operand(tree, i), kind::SUB | kind::ADD)) {
+  case kind::POW:
+    push_operand(q, operand(tree, 0), parens);
+    q.push_back({0, "^"});
+    push_operand(q, operand(tree, 1), parens);
+    return;
 
-        r += "(";
-      }
+  case kind::DIV:
+    push_operand(q, operand(tree, 0), parens);
+    q.push_back({0, " ÷ "});
+    push_operand(q, operand(tree, 1), parens);
+    return;
 
-      r += to_string(operand(tree, i));
+  case kind::ADD:
+    push_operands(q, tree, " + ", kind::SUB | kind::ADD);
+    return;
 
-      if (operand(tree, i) && is(operand(tree, i), kind::SUB | kind::ADD)) {
-        r += ")";
-      }
+  case kind::SUB:
+    push_operands(q, tree, " - ", kind::SUB | kind::ADD);
+    return;
 
-      if (i < size_of(tree) - 1) {
-        r += " - ";
-      }
-    }
+  case kind::MUL:
+    push_operands(q, tree, "*", kind::SUB | kind::ADD | kind::MUL | kind::FRAC);
+    return;
 
-    return r;
-  }
+  case kind::FACT:
+    push_operand(q, operand(tree, 0), 0);
+    q.push_back({0, "!"});
+    return;
 
-  if (is(tree, kind::MUL)) {
-    std::string r = "";
+  default:
+    r += "to string not implemented for kind " + kind_of_id(tree);
+    return;
+  }
+}
 
-    for (size_t i = 0; i < size_of(tree); i++) {
+// the pieces are written from a stack on the heap, so deep trees don't
+// overflow the stack of the thread
+std::string to_string(expr *tree) {
+  std::string r;
 
-      if (operand(tree, i) == nullptr) {
-        continue;
-      }
+  std::vector<string_piece> stack, q;
 
-      if (is(operand(tree, i), kind::SUB | kind::ADD | kind::MUL | kind::FRAC)) {
-        r += "(";
-      }
+  stack.push_back({tree, 0});
 
-      r += to_string(operand(tree, i));
+  while (!stack.empty()) {
+    string_piece p = stack.back();
 
-      if (is(operand(tree, i), kind::SUB | kind::ADD | kind::MUL | kind::FRAC)) {
-        r += ")";
-      }
+    stack.pop_back();
 
-      if (i < size_of(tree) - 1) {
-        r += "*";
-      }
+    if (p.s) {
+      r += p.s;
+      continue;
     }
 
-    return r;
-  }
+    to_string_node(p.u, r, q);
 
-  if (is(tree, kind::FACT)) {
-    return to_string(operand(tree, 0)) + "!";
-  }
+    stack.insert(stack.end(), q.rbegin(), q.rend());
 
-  if (is(tree, kind::LIST)) {
-    return to_string(tree->expr_list);
-	}
+    q.clear();
+  }
 
-	if (is(tree, kind::SET)) {
-    return to_string(tree->expr_set);
-	}
-  return "to string not implemented for kind " + kind_of_id(tree);
+  return r;
 }
 
 
@@ -1396,95 +2012,55 @@ std::string to_latex(expr tree, bool fractions, unsigned long max_den) {
 // }
 
 
-expr expand_mul(expr *a, size_t i, expr *b, size_t j) {
-  expr *r = operand(a, i);
-  expr *s = operand(b, j);
-
-  if (is(r, kind::ADD) && is(s, kind::ADD)) {
-    expr u = create(kind::ADD);
-
-    for (size_t k = 0; k < size_of(r); k++) {
-      for (size_t t = 0; t < size_of(s); t++) {
-        u.insert(create(kind::MUL,
-                        {expr(r->expr_childs[k]), expr(s->expr_childs[t])}));
-      }
-    }
-
-    return u;
-  }
-
-  if (is(r, kind::ADD)) {
-    expr u = create(kind::ADD);
-
-    for (size_t k = 0; k < size_of(r); k++) {
-      u.insert(create(kind::MUL,
-                      {expr(r->expr_childs[k]), expr(b->expr_childs[j])}));
-    }
-
-    return u;
-  }
-
-  if (is(s, kind::ADD)) {
-    expr u = create(kind::ADD);
-
-    for (size_t k = 0; k < size_of(s); k++) {
-      u.insert(create(kind::MUL,
-                      {expr(a->expr_childs[i]), expr(s->expr_childs[k])}));
-    }
-
-    return u;
-  }
-
-  return create(kind::MUL, {expr(a->expr_childs[i]), expr(b->expr_childs[j])});
-}
-
-
 expr expand_mul(expr *r, expr *s) {
-	// printf("expanding %s * %s = ", to_string(r).c_str(), to_string(s).c_str());
+  // every term of r is copied size_of(s) times and vice versa, after
+  // interning the copies only share the operands of the terms
+  intern(r);
+  intern(s);
+
+  const operand_list &R = r->expr_childs;
+  const operand_list &S = s->expr_childs;
 
   if (is(r, kind::ADD) && is(s, kind::ADD)) {
     expr u = create(kind::ADD);
 
-    for (size_t k = 0; k < size_of(r); k++) {
-      for (size_t t = 0; t < size_of(s); t++) {
-        u.insert(create(kind::MUL,
-                        {expr(r->expr_childs[k]), expr(s->expr_childs[t])}));
+    u.expr_childs.reserve(R.size() * S.size());
+
+    for (size_t k = 0; k < R.size(); k++) {
+      for (size_t t = 0; t < S.size(); t++) {
+        u.insert(create(kind::MUL, {R[k], S[t]}));
       }
     }
 
-		// printf("%s\n", to_string(u).c_str());
-
-		return u;
+    return u;
   }
 
   if (is(r, kind::ADD)) {
     expr u = create(kind::ADD);
 
-    for (size_t k = 0; k < size_of(r); k++) {
-      u.insert(create(kind::MUL,
-                      {expr(r->expr_childs[k]), *s}));
+    for (size_t k = 0; k < R.size(); k++) {
+      u.insert(create(kind::MUL, {R[k], *s}));
     }
 
-		// printf("%s\n", to_string(u).c_str());
     return u;
   }
 
   if (is(s, kind::ADD)) {
     expr u = create(kind::ADD);
 
-    for (size_t k = 0; k < size_of(s); k++) {
-      u.insert(create(kind::MUL,
-                      {*r, expr(s->expr_childs[k])}));
+    for (size_t k = 0; k < S.size(); k++) {
+      u.insert(create(kind::MUL, {*r, S[k]}));
     }
 
     return u;
   }
 
-	// printf("%s\n", to_string(create(kind::MUL, {*r, *s})).c_str());
-
   return create(kind::MUL, {*r, *s});
 }
 
+expr expand_mul(expr *a, size_t i, expr *b, size_t j) {
+  return expand_mul(operand(a, i), operand(b, j));
+}
 
 bool expand_pow(expr u, Int n, expr *a) {
 	if (n == 1) {
@@ -1547,7 +2123,12 @@ bool expand_pow(expr u, Int n, expr *a) {
 				g = expand_mul(&g, &x);
 			}
 
-			n = n / 2;
+			n /= 2;
+
+			// the last square would not be used
+			if (n == 0) {
+				break;
+			}
 
 			x = expand_mul(&x, &x);
 			x = reduce(x);
@@ -1563,20 +2144,32 @@ bool expand_pow(expr u, Int n, expr *a) {
   return false;
 }
 
-void expand(expr *a) {
+// returns the index of the first operand of a that should be expanded
+// before a, or -1 if a is already expanded
+static long expand_enter(expr *a) {
   if (is_expanded(a)) {
-    return;
+    return -1;
   }
 
   if (is(a, kind::TERMINAL)) {
     set_to_expanded(a);
-    return;
+    return -1;
   }
 
   if (is(a, kind::SUB | kind::DIV | kind::FACT | kind::FRAC | kind::ROOT)) {
     reduce(a);
   }
 
+  if (!is(a, kind::POW | kind::MUL | kind::ADD)) {
+    set_to_expanded(a);
+    return -1;
+  }
+
+  return 0;
+}
+
+// expands a, whose operands are expanded
+static void expand_node(expr *a) {
   if (is(a, kind::POW)) {
     expand(operand(a, 0));
     expand(operand(a, 1));
@@ -1625,6 +2218,10 @@ void expand(expr *a) {
   set_to_expanded(a);
 }
 
+// the operands are expanded deepest first, so the recursive calls of
+// expand_node return at once and deep trees don't overflow the stack
+void expand(expr *a) { post_order(a, expand_enter, expand_node); }
+
 expr &expr::operator+=(const expr &a) {
   if (is(this, kind::ADD)) {
     this->insert(a);
@@ -1757,6 +2354,10 @@ expr expr::operator/(expr &&a) {
 }
 
 bool expr::match(expr *other) {
+  if (structural_hash(*this) != structural_hash(*other)) {
+    return false;
+  }
+
   expr a = *other;
   expr b = *this;
 
@@ -1792,117 +2393,44 @@ bool expr::operator==(const expr &other) {
     return true;
   }
 
-  expr a = other;
-  expr b = *this;
-
-  sort(&a, kind::UNDEF);
-  sort(&b, kind::UNDEF);
-
-  return compare(&a, &b, kind::UNDEF) == 0;
-}
-
-bool expr::operator==(expr &&a) {
-  if (this->kind() != a.kind()) {
-    return false;
+  // interned operands are shared by structurally equal expressions
+  if (shares_operands(*this, other)) {
+    return true;
   }
 
-  if (is(this, kind::ADD | kind::SUB | kind::MUL) &&
-      size_of(this) != size_of(&a)) {
+  if (structural_hash(*this) != structural_hash(other)) {
     return false;
   }
 
-  if (is(this, kind::MAT) && is(&a, kind::MAT)) {
-    if (rows(this) != rows(a) || columns(this) != columns(a)) {
-      return false;
-    }
-
-    for (unsigned i = 0; i < this->expr_mat->lines(); i++) {
-      for (unsigned j = 0; j < this->expr_mat->columns(); j++) {
-        if (this->expr_mat->get(i, j) != a.expr_mat->get(i, j)) {
-          return false;
-        }
-      }
-    }
-
-    return true;
-  }
-
-  expr b = *this;
-
-  sort(&a, kind::UNDEF);
-
-  sort(&b, kind::UNDEF);
+  // sort returns at once for the copies of sorted expressions, so they
+  // are compared in place instead
+  expr a, b;
 
-  return compare(&a, &b, kind::UNDEF) == 0;
-}
+  expr *u = (expr *)&other;
+  expr *v = this;
 
-bool expr::operator!=(const expr &other) {
-  if (this->kind() != other.kind()) {
-    return true;
-  }
+  if (!(other.expr_info & info::SORTED)) {
+    a = other;
+    u = &a;
 
-  if (is(this, kind::ADD | kind::SUB | kind::MUL) &&
-      size_of(this) != size_of(&other)) {
-    return true;
+    sort(u, kind::UNDEF);
   }
-  if (is(this, kind::MAT) && is(&other, kind::MAT)) {
-    if (rows(this) != rows(other) || columns(this) != columns(other)) {
-      return true;
-    }
 
-    for (unsigned i = 0; i < this->expr_mat->lines(); i++) {
-      for (unsigned j = 0; j < this->expr_mat->columns(); j++) {
-        if (this->expr_mat->get(i, j) != other.expr_mat->get(i, j)) {
-          return true;
-        }
-      }
-    }
+  if (!(expr_info & info::SORTED)) {
+    b = *this;
+    v = &b;
 
-    return false;
+    sort(v, kind::UNDEF);
   }
 
-  expr a = other;
-  expr b = *this;
-
-  sort(&a, kind::UNDEF);
-  sort(&b, kind::UNDEF);
-
-  return compare(&a, &b, kind::UNDEF) != 0;
+  return compare(u, v, kind::UNDEF) == 0;
 }
 
-bool expr::operator!=(expr &&a) {
-  if (this->kind() != a.kind()) {
-    return true;
-  }
-
-  if (is(this, kind::ADD | kind::SUB | kind::MUL) &&
-      size_of(this) != size_of(&a)) {
-    return true;
-  }
-
-  if (is(this, kind::MAT) && is(&a, kind::MAT)) {
-    if (rows(this) != rows(a) || columns(this) != columns(a)) {
-      return true;
-    }
-
-    for (unsigned i = 0; i < this->expr_mat->lines(); i++) {
-      for (unsigned j = 0; j < this->expr_mat->columns(); j++) {
-        if (this->expr_mat->get(i, j) != a.expr_mat->get(i, j)) {
-          return true;
-        }
-      }
-    }
-
-    return false;
-  }
-
-  expr b = *this;
+bool expr::operator==(expr &&a) { return *this == (const expr &)a; }
 
-  sort(&a, kind::UNDEF);
-  sort(&b, kind::UNDEF);
+bool expr::operator!=(const expr &other) { return !(*this == other); }
 
-  return compare(&a, &b, kind::UNDEF) != 0;
-}
+bool expr::operator!=(expr &&a) { return !(*this == (const expr &)a); }
 
 expr expr::operator+() { return *this; }
 
@@ -1999,19 +2527,24 @@ expr inf() { return create(kind::INF); }
 expr expand(expr &a) {
   expr b = a;
 
-  expand(&b);
-
-  return b;
-}
+  if (is_expanded(&b) || is(&b, kind::TERMINAL)) {
+    expand(&b);
+    return b;
+  }
 
-expr expand(expr &&a) {
-  expr b = a;
+  if (memo_find(MEMO_EXPAND, a, 0, &b)) {
+    return b;
+  }
 
   expand(&b);
 
+  memo_store(MEMO_EXPAND, a, 0, b);
+
   return b;
 }
 
+expr expand(expr &&a) { return expand(a); }
+
 std::string to_string(expr &a) { return to_string(&a); }
 
 std::string to_string(expr &&a) { return to_string(&a); }
@@ -2142,28 +2675,69 @@ bool exists(const expr &a, expr &b) {
   return set_exists(L, b);
 }
 
-bool replace_rec(expr *a, expr *b, expr *c) {
-  if (a->match(b)) {
-    expr_replace_with(a, c);
+// replaces a by c if it matches b, returns true if it was replaced
+static bool replace_node(expr *a, expr *b, expr *c) {
+  if (!a->match(b)) {
+    return false;
+  }
 
-    set_to_unreduced(a);
-    set_to_unsorted(a);
+  expr_replace_with(a, c);
+
+  set_to_unreduced(a);
+  set_to_unsorted(a);
+
+  return true;
+}
 
+// the subexpressions are visited with a stack on the heap, so deep trees
+// don't overflow the stack of the thread
+bool replace_rec(expr *a, expr *b, expr *c) {
+  if (replace_node(a, b, c)) {
     return true;
   }
 
-  if (is(a, kind::TERMINAL))
+  if (is(a, kind::TERMINAL)) {
     return false;
+  }
+
+  struct frame {
+    expr *u;
+    size_t i;
+    bool replaced;
+  };
+
+  work_stack<frame, 32> stack;
+
+  stack.push_back({a, 0, false});
 
   bool replaced = false;
 
-  for (size_t i = 0; i < size_of(a); i++) {
+  while (!stack.empty()) {
+    frame &f = stack.back();
+
+    if (f.i < size_of(f.u)) {
+      expr *v = operand(f.u, f.i++);
+
+      if (replace_node(v, b, c)) {
+        f.replaced = true;
+      } else if (!is(v, kind::TERMINAL)) {
+        stack.push_back({v, 0, false});
+      }
+    } else {
+      expr *v = f.u;
+
+      replaced = f.replaced;
+
+      stack.pop_back();
 
-    if (replace_rec(operand(a, i), b, c)) {
-      replaced = true;
+      if (replaced) {
+        set_to_unreduced(v);
+        set_to_unsorted(v);
 
-      set_to_unreduced(a);
-      set_to_unsorted(a);
+        if (!stack.empty()) {
+          stack.back().replaced = true;
+        }
+      }
     }
   }
 
@@ -2214,7 +2788,8 @@ expr map(expr &u, expr &v, expr (*f)(expr &, expr &)) {
   expr t = create(kind_of(&u));
 
   if (is(&u, kind::FUNC)) {
-    u.expr_sym = strdup(u.expr_sym);
+    t.expr_sym = u.expr_sym;
+    t.expr_sym_id = u.expr_sym_id;
   }
 
   for (size_t i = 0; i < size_of(&u); i++)
@@ -2235,7 +2810,8 @@ expr map(expr &u, expr (*f)(expr &)) {
   expr t = create(kind_of(&u));
 
   if (is(&u, kind::FUNC)) {
-    u.expr_sym = strdup(u.expr_sym);
+    t.expr_sym = u.expr_sym;
+    t.expr_sym_id = u.expr_sym_id;
   }
 
   for (size_t i = 0; i < size_of(&u); i++) {
@@ -2250,18 +2826,31 @@ expr map(expr &u, expr (*f)(expr &)) {
 //  sorting on the non recursive methods and just
 // calling compare here
 bool free_of_rec(expr *a, expr *b) {
-  if (a->match(b)) {
-    return false;
-  }
+  // the subexpressions are visited with a stack on the heap, so deep
+  // trees don't overflow the stack of the thread
+  work_stack<expr *, 32> stack;
 
-  if (is(a, kind::TERMINAL)) {
-    return true;
-  }
+  stack.push_back(a);
+
+  while (!stack.empty()) {
+    expr *u = stack.back();
 
-  for (size_t i = 0; i < size_of(a); i++) {
-    if (!free_of_rec(operand(a, i), b)) {
+    stack.pop_back();
+
+    // expressions of different kinds never match, and symbols match if
+    // they have the same identifier
+    if (kind_of(u) == kind_of(b) &&
+        (is(u, kind::SYM) ? get_sym_id(u) == get_sym_id(b) : u->match(b))) {
       return false;
     }
+
+    if (is(u, kind::TERMINAL)) {
+      continue;
+    }
+
+    for (size_t i = size_of(u); i > 0; i--) {
+      stack.push_back(operand(u, i - 1));
+    }
   }
 
   return true;
@@ -2536,30 +3125,9 @@ bool list::operator!=(list &a) { return this->match(&a) != 0; }
 
 bool list::operator!=(list &&a) { return this->match(&a) != 0; }
 
-long int sort_split(std::vector<expr> &a, kind k, long l, long r) {
-  long int i = l - 1;
-
-  expr &p = a[r];
-
-  for (long int j = l; j < r; j++) {
-    if (compare(&a[j], &p, k) < 0) {
-      std::swap(a[++i], a[j]);
-    }
-  }
-
-  i = i + 1;
-
-  std::swap(a[i], a[r]);
-
-  return i;
-}
-
 void sort_vec(std::vector<expr> &a, kind k, long int l, long int r) {
   if (l < r) {
-    long int m = sort_split(a, k, l, r);
-
-    sort_vec(a, k, l, m - 1);
-    sort_vec(a, k, m + 1, r);
+    sort_range(a.data() + l, r - l + 1, k);
   }
 }
 
@@ -2572,7 +3140,17 @@ std::vector<expr> expr::operands() {
     return expr_set->members;
   }
 
-  return this->expr_childs;
+  const operand_list &l = expr_childs;
+
+  std::vector<expr> r;
+
+  r.reserve(l.size());
+
+  for (size_t i = 0; i < l.size(); i++) {
+    r.push_back(l[i]);
+  }
+
+  return r;
 }
 
 set::set(std::initializer_list<expr> &&a) {
@@ -2830,28 +3408,11 @@ expr gcd(expr &a, expr &b) {
     return abs(gcd(a.value(), b.value()));
   }
 
-  expr A = numerator(a);
-  expr C = numerator(b);
-  expr B = denominator(a);
-  expr D = denominator(b);
-
-  assert(A.kind() == kind::INT);
-  assert(B.kind() == kind::INT);
-  assert(C.kind() == kind::INT);
-  assert(D.kind() == kind::INT);
-
-  Int t = abs(gcd(A.value(), C.value()));
-  Int k = abs(lcm(B.value(), D.value()));
+  Rational x = get_rational(&a);
+  Rational y = get_rational(&b);
 
-  if (k == 1)
-    return t;
-
-  Int j = gcd(t, k);
-
-  if (k / j == 1)
-    return t;
-
-  return fraction(t / j, k / j);
+  // gcd(a/b, c/d) = gcd(a, c)/lcm(b, d)
+  return number(Rational(abs(gcd(x.num(), y.num())), lcm(x.den(), y.den())));
 }
 
 expr lcm(expr &a, expr &b) {
@@ -2862,31 +3423,30 @@ expr lcm(expr &a, expr &b) {
     return abs(lcm(a.value(), b.value()));
   }
 
-  expr A = numerator(a);
-  expr C = numerator(b);
-  expr B = denominator(a);
-  expr D = denominator(b);
-
-  assert(is(&A, kind::INT));
-  assert(is(&B, kind::INT));
-  assert(is(&C, kind::INT));
-  assert(is(&D, kind::INT));
+  Rational x = get_rational(&a);
+  Rational y = get_rational(&b);
 
-  Int t = abs(lcm(A.value(), C.value()));
-  Int k = abs(gcd(B.value(), D.value()));
+  // lcm(a/b, c/d) = lcm(a, c)/gcd(b, d)
+  return number(Rational(abs(lcm(x.num(), y.num())), gcd(x.den(), y.den())));
+}
 
-  if (k == 1)
-    return t;
+expr binomial(Int n, std::vector<Int> &ks) {
+  Int s = 0;
 
-  Int j = gcd(t, k);
+  for (Int &k : ks) {
+    if (k < 0) {
+      s = n + 1;
+      break;
+    }
 
-  if (k / j == 1)
-    return t;
+    s += k;
+  }
 
-  return fraction(t / j, k / j);
-}
+  // integer result, computed from the prime factorization
+  if (n >= 0 && s <= n) {
+    return multinomial(n, ks);
+  }
 
-expr binomial(Int n, std::vector<Int> &ks) {
   expr p = expr(kind::MUL);
 
   for (Int k : ks) {
@@ -2897,6 +3457,22 @@ expr binomial(Int n, std::vector<Int> &ks) {
 }
 
 expr binomial(Int n, std::vector<Int> &&ks) {
+  Int s = 0;
+
+  for (Int &k : ks) {
+    if (k < 0) {
+      s = n + 1;
+      break;
+    }
+
+    s += k;
+  }
+
+  // integer result, computed from the prime factorization
+  if (n >= 0 && s <= n) {
+    return multinomial(n, ks);
+  }
+
   expr p = expr(kind::MUL);
 
   for (Int k : ks) {
@@ -3161,10 +3737,9 @@ double doubleFromExpr(expr a) {
 
 	if(is(&a, kind::INT)) return get_val(&a).doubleValue();
 	if(is(&a, kind::FRAC)) {
-		expr n = numerator(a);
-		expr d = numerator(a);
+		Rational r = get_rational(&a);
 
-		return n.value().doubleValue() / d.value().doubleValue();
+		return Int(r.num()).doubleValue() / Int(r.den()).doubleValue();
 	}
 
 	return std::numeric_limits<double>::quiet_NaN();
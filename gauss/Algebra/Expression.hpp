@@ -1,10 +1,16 @@
 #ifndef ALG_HPP
 #define ALG_HPP
 
+#include "Arena.hpp"
 #include "Integer.hpp"
+#include "Rational.hpp"
 #include "Matrix.hpp"
+#include "SymbolTable.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <string>
 #include <vector>
@@ -56,21 +62,75 @@ enum info {
 struct list;
 struct set;
 
+struct expr;
+struct expr_node;
+
+// Operands of an expression. They are stored in place after the header
+// of a single node, so expressions with a few operands pay for a single
+// allocation and their operands are contiguous. The node is either owned
+// by the list or frozen by intern, frozen operands are immutable and
+// shared by all the copies of the expression, so copying them is O(1).
+// Any non const access copies the frozen operands back to the list
+// first. Empty lists have no node.
+struct operand_list {
+  expr_node *node;
+
+  operand_list();
+  operand_list(const operand_list &o);
+  operand_list(operand_list &&o);
+
+  ~operand_list();
+
+  operand_list &operator=(const operand_list &o);
+  operand_list &operator=(operand_list &&o);
+  operand_list &operator=(const std::vector<expr> &v);
+  operand_list &operator=(std::vector<expr> &&v);
+  operand_list &operator=(std::initializer_list<expr> v);
+
+  inline size_t size() const;
+
+  inline expr &operator[](size_t i);
+  inline const expr &operator[](size_t i) const;
+
+  // interned node of the operands, null if they are owned
+  inline expr_node *frozen() const;
+
+  void insert(size_t i, const expr &a);
+  void insert(size_t i, expr &&a);
+
+  void push_back(const expr &a);
+  void push_back(expr &&a);
+
+  void erase(size_t i);
+  void pop_back();
+  void clear();
+
+  // makes room for n operands without reallocating the node
+  void reserve(size_t n);
+
+  // copies the frozen operands back to the list
+  void thaw();
+};
+
 struct expr {
   enum kind kind_of = kind::UNDEF;
 
   int expr_info = info::UNKNOWN;
   int sort_kind = kind::UNDEF;
 
+  // id of the identifier of symbols and functions, see SymbolTable.hpp
+  unsigned expr_sym_id = 0;
+
   union {
-    char *expr_sym;
+    // stored name of the identifier of symbols and functions
+    const char *expr_sym;
     list *expr_list;
     Int *expr_int;
     set *expr_set;
     matrix *expr_mat;
   };
 
-  std::vector<expr> expr_childs;
+  operand_list expr_childs;
 
   expr();
   expr(enum kind k);
@@ -187,8 +247,161 @@ struct expr {
   friend bool exists(const expr &, expr &);
 
   inline std::string funName() { return this->expr_sym; }
+  inline unsigned funId() const { return this->expr_sym_id; }
+};
+
+// Header of the operands of an expression, the operands are stored
+// right after it. Every structurally equal list of operands that is
+// interned shares the same node.
+struct expr_node {
+  // references to an interned node, zero if it is owned by a list
+  std::atomic<size_t> refs;
+
+  union {
+    // hash of the items of an interned node
+    size_t hash;
+
+    // next owned node waiting to be copied or freed, see Expression.cpp
+    expr_node *next;
+  };
+
+  // cached hash of the items, see structural_hash, zero if unknown. Any
+  // non const access to an owned node resets it
+  std::atomic<size_t> items_hash;
+
+  uint32_t size;
+  uint32_t capacity;
+
+  inline expr *items() { return reinterpret_cast<expr *>(this + 1); }
+
+  inline const expr *items() const {
+    return reinterpret_cast<const expr *>(this + 1);
+  }
+};
+
+static_assert(sizeof(void *) != 8 || sizeof(expr) == 32,
+              "expressions should fit on half a cache line");
+
+inline size_t operand_list::size() const { return node ? node->size : 0; }
+
+inline expr_node *operand_list::frozen() const {
+  return node && node->refs.load(std::memory_order_relaxed) ? node : 0;
+}
+
+inline expr &operand_list::operator[](size_t i) {
+  if (frozen()) {
+    thaw();
+  }
+
+  node->items_hash.store(0, std::memory_order_relaxed);
+
+  return node->items()[i];
+}
+
+inline const expr &operand_list::operator[](size_t i) const {
+  return node->items()[i];
+}
+
+// Hash consing of the operands of u and of all its subexpressions, the
+// structurally equal subexpressions of the result share their operands
+// with each other and with every other interned expression, so the
+// copies of the result are O(1) and equal subexpressions are detected
+// by comparing pointers. Lists, sets and matrices are not interned, nor
+// the expressions containing them.
+expr intern(expr u);
+void intern(expr *u);
+
+// Hash of u that agrees with expr::operator==, the operands of every
+// expression are combined in any order and the constants are hashed by
+// their values. The hash of the operands is cached until they are
+// accessed by a non const reference.
+size_t structural_hash(const expr &u);
+
+// Stack of the traversals of the expressions, the first N items are
+// kept in place, and only deeper trees use the heap. T should be
+// trivially copyable.
+template <typename T, size_t N> struct work_stack {
+  T local[N];
+  std::vector<T> heap;
+
+  T *items;
+
+  size_t count;
+  size_t capacity;
+
+  work_stack() : items(local), count(0), capacity(N) {}
+
+  work_stack(const work_stack &) = delete;
+  work_stack &operator=(const work_stack &) = delete;
+
+  inline bool empty() const { return count == 0; }
+  inline size_t size() const { return count; }
+
+  inline T &back() { return items[count - 1]; }
+
+  inline void pop_back() { count--; }
+
+  inline void push_back(const T &t) {
+    if (count == capacity) {
+      std::vector<T> g(2 * capacity);
+
+      std::copy(items, items + count, g.begin());
+
+      heap.swap(g);
+
+      items = heap.data();
+      capacity = heap.size();
+    }
+
+    items[count++] = t;
+  }
 };
 
+// Post-order traversal of u and its subexpressions with a stack on the
+// heap, so the depth of the trees is not bounded by the stack of the
+// thread. enter is called on every expression before its operands and
+// returns the index of the first operand to visit, or a negative number
+// to skip the expression, leave is called on the entered expressions
+// after their operands. Both may change the expression they are given,
+// but not the operands of its ancestors.
+template <typename Enter, typename Leave>
+void post_order(expr *u, Enter enter, Leave leave) {
+  struct frame {
+    expr *u;
+    size_t i;
+  };
+
+  long k = enter(u);
+
+  if (k < 0) {
+    return;
+  }
+
+  work_stack<frame, 32> stack;
+
+  stack.push_back({u, (size_t)k});
+
+  while (!stack.empty()) {
+    frame &f = stack.back();
+
+    if (f.i < f.u->expr_childs.size()) {
+      expr *v = &f.u->expr_childs[f.i++];
+
+      k = enter(v);
+
+      if (k >= 0) {
+        stack.push_back({v, (size_t)k});
+      }
+    } else {
+      expr *v = f.u;
+
+      stack.pop_back();
+
+      leave(v);
+    }
+  }
+}
+
 expr pow(const expr &a, const expr &b);
 expr pow(expr &&a, expr &&b);
 expr pow(expr &&a, const expr &b);
@@ -257,6 +470,9 @@ list freeVariables(expr &a);
 expr symbol(const char *id);
 expr integer(Int value);
 expr fraction(Int num, Int den);
+
+// integer if v have denominator 1, fraction otherwise
+expr number(const Rational &v);
 expr inf();
 expr fail();
 expr undefined();
@@ -312,10 +528,16 @@ inline int is(const expr *a, int k) { return a->kind_of & k; }
 
 inline kind kind_of(const expr *expr) { return expr->kind_of; }
 
-inline char *get_id(expr *expr) { return expr->expr_sym; }
+inline const char *get_id(expr *expr) { return expr->expr_sym; }
+
+inline unsigned get_sym_id(expr *expr) { return expr->expr_sym_id; }
 
 inline Int get_val(expr *expr) { return Int(*expr->expr_int); }
 
+// value of an integer or fraction, raises DIVISION_BY_ZERO for a
+// fraction with a zero denominator
+Rational get_rational(expr *a);
+
 inline const char *get_func_id(expr *expr) { return expr->expr_sym; }
 
 std::string to_latex(expr *a, bool fraction = false,
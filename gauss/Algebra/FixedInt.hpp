@@ -0,0 +1,351 @@
+#ifndef FIXED_INT_HPP
+#define FIXED_INT_HPP
+
+// References:
+// [1] Koc, Cetin Kaya and Acar, Tolga and Kaliski, Burton S. Analyzing
+// and comparing Montgomery multiplication algorithms
+
+#include "Integer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Unsigned integers of N 64 bits limbs, stored on the stack. They are
+// used by the kernels that know a bound for their numbers beforehand,
+// the operations never allocate and have no data dependent branches
+// besides the carries.
+template <size_t N> struct fint {
+  static const size_t limbs = N;
+  static const size_t bits = 64 * N;
+
+  // little endian limbs
+  uint64_t d[N];
+
+  static fint zero() {
+    fint r;
+
+    for (size_t i = 0; i < N; i++) {
+      r.d[i] = 0;
+    }
+
+    return r;
+  }
+
+  static fint word(uint64_t v) {
+    fint r = zero();
+
+    r.d[0] = v;
+
+    return r;
+  }
+
+  // a should be in [0, 2^(64*N))
+  static fint fromInt(const Int &a) {
+    if (!a.flag) {
+      return word((uint64_t)a.x);
+    }
+
+    fint r = zero();
+
+    Int t = a;
+    Int h = Int(1ULL << 32);
+
+    for (size_t i = 0; i < N && t > 0; i++) {
+      uint64_t l = (uint64_t)(t % h).longValue();
+
+      t /= h;
+
+      r.d[i] = l | (uint64_t)(t % h).longValue() << 32;
+
+      t /= h;
+    }
+
+    return r;
+  }
+
+  Int toInt() const {
+    Int r = 0;
+    Int h = Int(1ULL << 32);
+
+    for (size_t i = N; i-- > 0;) {
+      r = r * h + Int((unsigned long long)(d[i] >> 32));
+      r = r * h + Int((unsigned long long)(d[i] & 0xffffffffULL));
+    }
+
+    return r;
+  }
+
+  bool isZero() const {
+    uint64_t t = 0;
+
+    for (size_t i = 0; i < N; i++) {
+      t |= d[i];
+    }
+
+    return t == 0;
+  }
+
+  // returns -1, 0 or 1
+  static int compare(const fint &a, const fint &b) {
+    for (size_t i = N; i-- > 0;) {
+      if (a.d[i] != b.d[i]) {
+        return a.d[i] > b.d[i] ? 1 : -1;
+      }
+    }
+
+    return 0;
+  }
+
+  // z = a + b, returns the carry
+  static uint64_t add(const fint &a, const fint &b, fint &z) {
+    uint64_t c = 0;
+
+    for (size_t i = 0; i < N; i++) {
+      uint64_t s = a.d[i] + c;
+
+      c = s < c;
+
+      z.d[i] = s + b.d[i];
+
+      c += z.d[i] < s;
+    }
+
+    return c;
+  }
+
+  // z = a - b, returns the borrow
+  static uint64_t sub(const fint &a, const fint &b, fint &z) {
+    uint64_t c = 0;
+
+    for (size_t i = 0; i < N; i++) {
+      uint64_t s = a.d[i] - b.d[i];
+      uint64_t w = a.d[i] < b.d[i];
+
+      z.d[i] = s - c;
+
+      c = w | (s < c);
+    }
+
+    return c;
+  }
+
+  // z = a*b, the product have N + M limbs
+  template <size_t M>
+  static void mul(const fint &a, const fint<M> &b, fint<N + M> &z) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 u128;
+
+    z = fint<N + M>::zero();
+
+    for (size_t i = 0; i < N; i++) {
+      uint64_t c = 0;
+
+      for (size_t j = 0; j < M; j++) {
+        u128 t = (u128)a.d[i] * b.d[j] + z.d[i + j] + c;
+
+        z.d[i + j] = (uint64_t)t;
+
+        c = (uint64_t)(t >> 64);
+      }
+
+      z.d[i + M] = c;
+    }
+#else
+    // 32 bits halves, every partial product fits on 64 bits
+    z = fint<N + M>::zero();
+
+    uint32_t w[2 * (N + M)] = {0};
+
+    for (size_t i = 0; i < 2 * N; i++) {
+      uint64_t x = (a.d[i / 2] >> (32 * (i % 2))) & 0xffffffffULL;
+      uint64_t c = 0;
+
+      for (size_t j = 0; j < 2 * M; j++) {
+        uint64_t y = (b.d[j / 2] >> (32 * (j % 2))) & 0xffffffffULL;
+        uint64_t t = x * y + w[i + j] + c;
+
+        w[i + j] = (uint32_t)t;
+
+        c = t >> 32;
+      }
+
+      w[i + 2 * M] = (uint32_t)c;
+    }
+
+    for (size_t i = 0; i < N + M; i++) {
+      z.d[i] = (uint64_t)w[2 * i] | (uint64_t)w[2 * i + 1] << 32;
+    }
+#endif
+  }
+
+  // widens a to M >= N limbs
+  template <size_t M> fint<M> widen() const {
+    fint<M> r = fint<M>::zero();
+
+    for (size_t i = 0; i < N; i++) {
+      r.d[i] = d[i];
+    }
+
+    return r;
+  }
+};
+
+#ifdef __SIZEOF_INT128__
+
+// Montgomery arithmetic modulo an odd m < 2^(64*N - 1) with R = 2^(64*N),
+// the residues are kept in [0, m) on the Montgomery representation a*R.
+template <size_t N> struct fint_mod {
+  typedef fint<N> fint_t;
+
+  Int p;
+
+  fint_t m;
+  fint_t r2;
+
+  // -m^-1 mod 2^64
+  uint64_t minv;
+
+  fint_mod(const Int &q) : p(q) {
+    m = fint_t::fromInt(p);
+
+    // Newton iteration for m^-1 mod 2^64
+    uint64_t inv = m.d[0];
+
+    for (int i = 0; i < 5; i++) {
+      inv *= 2 - m.d[0] * inv;
+    }
+
+    minv = -inv;
+
+    Int R = pow(Int(2), Int((unsigned long long)(2 * fint_t::bits)));
+
+    r2 = fint_t::fromInt(R % p);
+  }
+
+  // returns a*b/R mod m, see [1] CIOS method
+  fint_t mul(const fint_t &a, const fint_t &b) const {
+    __extension__ typedef unsigned __int128 u128;
+
+    uint64_t t[N + 2];
+
+    for (size_t i = 0; i < N + 2; i++) {
+      t[i] = 0;
+    }
+
+    for (size_t i = 0; i < N; i++) {
+      uint64_t c = 0;
+
+      for (size_t j = 0; j < N; j++) {
+        u128 s = (u128)a.d[j] * b.d[i] + t[j] + c;
+
+        t[j] = (uint64_t)s;
+        c = (uint64_t)(s >> 64);
+      }
+
+      u128 s = (u128)t[N] + c;
+
+      t[N] = (uint64_t)s;
+      t[N + 1] = (uint64_t)(s >> 64);
+
+      uint64_t q = t[0] * minv;
+
+      s = (u128)q * m.d[0] + t[0];
+      c = (uint64_t)(s >> 64);
+
+      for (size_t j = 1; j < N; j++) {
+        s = (u128)q * m.d[j] + t[j] + c;
+
+        t[j - 1] = (uint64_t)s;
+        c = (uint64_t)(s >> 64);
+      }
+
+      s = (u128)t[N] + c;
+
+      t[N - 1] = (uint64_t)s;
+      t[N] = t[N + 1] + (uint64_t)(s >> 64);
+    }
+
+    fint_t z;
+
+    for (size_t i = 0; i < N; i++) {
+      z.d[i] = t[i];
+    }
+
+    // t < 2m
+    if (t[N] || fint_t::compare(z, m) >= 0) {
+      fint_t::sub(z, m, z);
+    }
+
+    return z;
+  }
+
+  fint_t add(const fint_t &a, const fint_t &b) const {
+    fint_t z;
+
+    // m < R/2, so the sum does not overflow
+    fint_t::add(a, b, z);
+
+    if (fint_t::compare(z, m) >= 0) {
+      fint_t::sub(z, m, z);
+    }
+
+    return z;
+  }
+
+  fint_t sub(const fint_t &a, const fint_t &b) const {
+    fint_t z;
+
+    if (fint_t::sub(a, b, z)) {
+      fint_t::add(z, m, z);
+    }
+
+    return z;
+  }
+
+  // Montgomery representation of a mod m
+  fint_t to(const Int &a) const {
+    Int r = a % p;
+
+    if (r < 0) {
+      r += p;
+    }
+
+    return mul(fint_t::fromInt(r), r2);
+  }
+
+  // residue in [0, m) of the Montgomery representation a
+  fint_t from(const fint_t &a) const { return mul(a, fint_t::word(1)); }
+};
+
+#endif
+
+// Calls k.template run<N>() with the smallest N in {2, 4, 8} such that
+// numbers with the given bit length are smaller than 2^(64*N - 2), so
+// the arithmetic runs on 128, 256 or 512 bits integers. Returns false
+// without calling k if the numbers are too big, or if there are no 128
+// bits products to build the kernels.
+template <class K> bool dispatchLimbs(size_t bits, K &k) {
+#ifdef __SIZEOF_INT128__
+  if (bits <= 126) {
+    k.template run<2>();
+    return true;
+  }
+
+  if (bits <= 254) {
+    k.template run<4>();
+    return true;
+  }
+
+  if (bits <= 510) {
+    k.template run<8>();
+    return true;
+  }
+#else
+  (void)bits;
+  (void)k;
+#endif
+
+  return false;
+}
+
+#endif
@@ -7,6 +7,7 @@
 // [3] The Art of Computer Programming Vol 2 by Donald E. Knuth
 // [4] Modern Computer Arithmetic by Richard Brent and Paul Zimmermann
 
+#include "gauss/Algebra/NTT.hpp"
 #include "gauss/Error/error.hpp"
 #include <algorithm>
 #include <cassert>
@@ -37,19 +38,37 @@
 
 #define mulPow2(d, exp) (d << exp)
 
+// C = A - B, C = A + B and z = x*y, the operations are made in
+// place when the output is the first operand
 #define SUB(A, B, C)                                                           \
   {                                                                            \
-    bint_t *tmp = new bint_t();                                                \
-    sub(A, B, tmp);                                                            \
-    delete C;                                                                  \
-    C = tmp;                                                                   \
+    if ((C) == (A)) {                                                          \
+      add_in_place(C, B, -1);                                                  \
+    } else {                                                                   \
+      bint_t *tmp = new bint_t();                                              \
+      sub(A, B, tmp);                                                          \
+      delete C;                                                                \
+      C = tmp;                                                                 \
+    }                                                                          \
+  }
+#define ADD(A, B, C)                                                           \
+  {                                                                            \
+    if ((C) == (A)) {                                                          \
+      add_in_place(C, B, 1);                                                   \
+    } else {                                                                   \
+      bint_t *tmp = new bint_t();                                              \
+      add(A, B, tmp);                                                          \
+      delete C;                                                                \
+      C = tmp;                                                                 \
+    }                                                                          \
   }
 #define MUL(x, y, z)                                                           \
   {                                                                            \
-    bint_t *tmp = new bint_t();                                                \
-    mul(x, y, tmp);                                                            \
-    delete z;                                                                  \
-    z = tmp;                                                                   \
+    bint_t tmp;                                                                \
+    mul(x, y, &tmp);                                                           \
+    if (!z)                                                                    \
+      z = new bint_t();                                                        \
+    z->swap(&tmp);                                                             \
   }
 
 #if DBL_MANT_DIG == 53
@@ -58,7 +77,70 @@
 #define EXP2_DBL_MANT_DIG (ldexp(1.0, DBL_MANT_DIG))
 #endif
 
-inline int high_bit(uint32_t x) {
+// Number of digits of the smaller operand above which the
+// multiplication switches from the schoolbook kernel to
+// Karatsuba and from Karatsuba to Toom-Cook 3-way, the
+// values can be tuned at compile time.
+#ifndef KARATSUBA_MUL_THRESHOLD
+#define KARATSUBA_MUL_THRESHOLD 40
+#endif
+
+#ifndef TOOM3_MUL_THRESHOLD
+#define TOOM3_MUL_THRESHOLD 120
+#endif
+
+// Same as above but for squaring, the schoolbook squaring
+// kernel does half of the digit products, so it stays
+// competitive for longer.
+#ifndef KARATSUBA_SQR_THRESHOLD
+#define KARATSUBA_SQR_THRESHOLD 64
+#endif
+
+#ifndef TOOM3_SQR_THRESHOLD
+#define TOOM3_SQR_THRESHOLD 160
+#endif
+
+// Above this number of digits the products are computed with
+// the three primes number theoretic transform from NTT.hpp.
+#ifndef NTT_MUL_THRESHOLD
+#define NTT_MUL_THRESHOLD 12000
+#endif
+
+#ifndef NTT_SQR_THRESHOLD
+#define NTT_SQR_THRESHOLD 16000
+#endif
+
+// Number of digits of both the divisor and the quotient above which
+// the division uses the Burnikel-Ziegler recursive algorithm. Divisors
+// with more than NEWTON_DIV_THRESHOLD digits and quotients at least
+// twice as long are divided using a Newton approximation of the
+// reciprocal, that is computed once and reused for every block.
+#ifndef BZ_DIV_THRESHOLD
+#define BZ_DIV_THRESHOLD 60
+#endif
+
+#ifndef NEWTON_DIV_THRESHOLD
+#define NEWTON_DIV_THRESHOLD 16000
+#endif
+
+// Number of digits above which the gcd reduces the operands with the
+// half gcd recursion before using Lehmer's algorithm.
+#ifndef HGCD_THRESHOLD
+#define HGCD_THRESHOLD 1000
+#endif
+
+// Number of digits, and of decimal characters, above which the
+// conversions to and from base 10 split the number using the cached
+// powers of 10.
+#ifndef TO_STRING_THRESHOLD
+#define TO_STRING_THRESHOLD 40
+#endif
+
+#ifndef FROM_STRING_THRESHOLD
+#define FROM_STRING_THRESHOLD 400
+#endif
+
+inline int high_bit(unsigned long long x) {
   const int blen[32] = {0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4,
                      5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5};
 
@@ -120,8 +202,8 @@ class bint {
   static_assert(exp <= sizeof(single_type) * CHAR_BIT - 1,
                 "base expoent needs to be smaller than the number of bits in "
                 "the single_type");
-  static_assert(sizeof(single_type) <= 32 / CHAR_BIT,
-                "single type can have at most 32 bits");
+  static_assert(sizeof(single_type) <= 64 / CHAR_BIT,
+                "single type can have at most 64 bits");
   static_assert(sizeof(double_type) >= 2 * sizeof(single_type),
                 "sizeof(double_type) needs to be at least twice"
                 "as big as sizeof(single_type)");
@@ -140,48 +222,106 @@ public:
 
   using bint_t = bint<exp, digit_t, digit2_t, sdigit_t, sdigit2_t>;
 
+  // number of digits stored inside the bint itself, numbers up to
+  // 256 bits don't need any other allocation
+  static const size_t inline_digits = (256 + exp - 1) / exp;
+
   digit_t *digit;
   size_t size;
   short sign;
 
-  bint(digit_t *d, size_t s, short sign = 1) : digit{d}, size{s}, sign{sign} {}
-  bint() : digit{nullptr}, size{0}, sign{1} {}
+  // number of digits allocated on digit, it is never smaller
+  // than size, so trimming and resizing can reuse the memory
+  size_t capacity;
+
+  // inline storage used by digit until the number outgrows it
+  digit_t local[inline_digits];
+
+  // the bint takes ownership of d, that needs to be allocated with malloc
+  bint(digit_t *d, size_t s, short sign = 1)
+      : digit{d}, size{s}, sign{sign}, capacity{s} {
+    if (!d) {
+      digit = local;
+      capacity = inline_digits;
+    }
+  }
+
+  bint() : digit{local}, size{0}, sign{1}, capacity{inline_digits} {}
+
+  // the digits can point to the inline storage, so bints are never
+  // copied by value, use copy() or set() instead
+  bint(const bint_t &) = delete;
+  bint_t &operator=(const bint_t &) = delete;
 
   ~bint() {
-    if (digit)
+    if (digit != local)
       free(digit);
   }
 
   bint_t *copy() {
     bint_t *t = new bint_t();
 
+    t->reserve(this->size);
+
     t->size = this->size;
     t->sign = this->sign;
 
     if (this->size) {
-      t->digit = (digit_t *)malloc(sizeof(digit_t) * this->size);
       memcpy(t->digit, this->digit, this->size * sizeof(digit_t));
     }
 
     return t;
   }
 
+  // set the number to s zero digits, the current memory is
+  // reused if it have enough capacity
   void resize(uint64_t s) {
     size = s;
 
-    if (digit)
-      free(digit);
-
     if (s == 0) {
-      digit = nullptr;
+      sign = 1;
       return;
     }
 
-    digit = (digit_t *)malloc(sizeof(digit_t) * s);
+    if (s > capacity) {
+      if (digit != local)
+        free(digit);
+
+      digit = (digit_t *)malloc(sizeof(digit_t) * s);
+      capacity = s;
+    }
 
     memset(digit, 0, sizeof(digit_t) * s);
   }
 
+  // make room for at least s digits keeping the current ones
+  void reserve(size_t s) {
+    if (s <= capacity)
+      return;
+
+    if (digit == local) {
+      digit = (digit_t *)malloc(sizeof(digit_t) * s);
+
+      memcpy(digit, local, sizeof(digit_t) * size);
+    } else {
+      digit = (digit_t *)realloc(digit, sizeof(digit_t) * s);
+    }
+
+    capacity = s;
+  }
+
+  // grow the number to s digits, the new digits are zero
+  void extend(size_t s) {
+    if (s <= size)
+      return;
+
+    reserve(s);
+
+    memset(digit + size, 0, sizeof(digit_t) * (s - size));
+
+    size = s;
+  }
+
   // shift the bits in a to the left m times and save the
   // result on z
   static digit_t digits_lshift(digit_t *a, size_t l, int d, digit_t *z) {
@@ -232,99 +372,63 @@ public:
       k--;
 
     if (!digit[k]) {
-      free(digit);
-
-      digit = nullptr;
-
       size = 0;
+      sign = 1;
     } else {
       size = k + 1;
-      digit = (digit_t *)realloc(digit, sizeof(digit_t) * size);
     }
   }
 
   // convert x to base 2^exp
   template <typename T> static bint_t *from(T x) {
-    short sign = 1;
-
-    if (x == 0)
-      return new bint_t(nullptr, 0, 1);
+    bint_t *t = new bint_t();
 
     if (x < 0) {
-      sign = -1;
+      t->sign = -1;
       x = -x;
     }
 
-    size_t s = 10;
-
-    digit_t *v = (digit_t *)malloc(s * sizeof(digit_t));
-
-    size_t i = 0;
-
-    T q = quoPow2(x, exp);
-    v[0] = modPow2(x, exp);
-
-    while (q > 0) {
-      i = i + 1;
-
-      if (i >= s) {
-        s = s + 10;
-        v = (digit_t *)realloc(v, sizeof(digit_t) * s);
-      }
+    while (x > 0) {
+      t->reserve(t->size + 1);
 
-      x = q;
+      t->digit[t->size++] = (digit_t)x & mask;
 
-      q = quoPow2(x, exp);
-      v[i] = modPow2(x, exp);
+      // two shifts, exp can be larger than the bits in T
+      x = (x >> (exp / 2)) >> (exp - exp / 2);
     }
 
-    v = (digit_t *)realloc(v, sizeof(digit_t) * (i + 1));
-
-    return new bint(v, i + 1, sign);
+    return t;
   }
 
   static bint_t *from(double y) {
-    short sign = 1;
     double x = 0;
 
     y = std::modf(y, &x);
 
+    bint_t *t = new bint_t();
+
     if (x == 0) {
-      return new bint_t();
+      return t;
     }
 
     double b = std::pow(2, exp);
 
     if (x < 0) {
-      sign = -1;
+      t->sign = -1;
       x = -x;
     }
 
-    size_t s = 10;
+    while (x > 0) {
+      t->reserve(t->size + 1);
 
-    digit_t *v = new digit_t[s];
+      digit_t d = fmod(x, b);
 
-    size_t i = 0;
-
-    v[0] = fmod(x, b);
-
-    double q = (x - v[0]) / b;
-
-    while (q > 0) {
-      i = i + 1;
+      t->digit[t->size++] = d;
 
-      if (i >= s) {
-        s = s * 10;
-        v = (digit_t *)realloc(v, sizeof(digit_t) * s);
-      }
-
-      x = q;
-
-      v[i] = fmod(x, b);
-      q = (x - v[i]) / b;
+      x = (x - d) / b;
     }
 
-    return new bint(v, i + 1, sign);
+    return t;
   }
   // sum the absolute values of the big integers with digits x[0...a]
   // and y[0...b] and save in z[0...a + 1]. It's assumed that a >= b.
@@ -348,6 +452,7 @@ public:
     }
 
     z->resize(x->size + 1);
+    z->sign = 1;
 
     for (; i < b; ++i) {
       carry += x->digit[i] + y->digit[i];
@@ -445,24 +550,105 @@ public:
     return z->trim();
   }
 
-  // Square the bint of digits x[0...a] and store the
-  // result in w[0...2*a]
-  static void abs_square_digits(bint_t *x, bint_t *w) {
+  // returns the number of digits of a[0...n) without
+  // the leading zeros
+  static size_t digits_size(digit_t *a, size_t n) {
+    while (n > 0 && !a[n - 1])
+      n--;
+
+    return n;
+  }
+
+  // add b[0...m) to a[0...n) in place, it is assumed that
+  // n >= m. Returns the carry out of a[n - 1]
+  static digit_t digits_add_to(digit_t *a, size_t n, digit_t *b, size_t m) {
+    digit_t carry = 0;
+
     size_t i = 0;
 
-    w->resize(2 * x->size);
+    for (; i < m; ++i) {
+      carry += a[i] + b[i];
+      a[i] = carry & mask;
+      carry >>= exp;
+    }
+
+    for (; carry && i < n; ++i) {
+      carry += a[i];
+      a[i] = carry & mask;
+      carry >>= exp;
+    }
+
+    return carry;
+  }
+
+  // subtract b[0...m) from a[0...n) in place, it is assumed
+  // that n >= m. Returns the borrow out of a[n - 1]
+  static digit_t digits_sub_from(digit_t *a, size_t n, digit_t *b, size_t m) {
+    digit_t borrow = 0;
+
+    size_t i = 0;
+
+    for (; i < m; ++i) {
+      borrow = a[i] - b[i] - borrow;
+      a[i] = borrow & mask;
+      borrow >>= exp;
+      borrow &= 1;
+    }
+
+    for (; borrow && i < n; ++i) {
+      borrow = a[i] - borrow;
+      a[i] = borrow & mask;
+      borrow >>= exp;
+      borrow &= 1;
+    }
+
+    return borrow;
+  }
+
+  // divide a[0...n) by the single digit k, save the quotient
+  // on q[0...n) and return the remainder, q can be equal to a
+  static digit_t digits_div_small(digit_t *a, size_t n, digit_t k,
+                                  digit_t *q) {
+    digit2_t r = 0;
 
-    for (; i < 2 * x->size; i++) {
-      w->digit[i] = 0;
+    for (size_t i = n; i-- > 0;) {
+      r = (r << exp) | a[i];
+      q[i] = (digit_t)(r / k);
+      r -= (digit2_t)q[i] * k;
     }
 
-    for (i = 0; i < x->size; i++) {
+    return (digit_t)r;
+  }
+
+  // create a bint from a copy of the digits d[0...n)
+  static bint_t *from_digits(digit_t *d, size_t n) {
+    bint_t *t = new bint_t();
+
+    n = digits_size(d, n);
+
+    t->reserve(n);
+
+    if (n) {
+      t->size = n;
+
+      memcpy(t->digit, d, sizeof(digit_t) * n);
+    }
+
+    return t;
+  }
+
+  // Schoolbook square of the digits a[0...n), the result is
+  // saved on w[0...2*n)
+  static void digits_sqr_basecase(digit_t *a, size_t n, digit_t *w) {
+    memset(w, 0, sizeof(digit_t) * 2 * n);
+
+    for (size_t i = 0; i < n; i++) {
       digit2_t carry;
-      digit2_t xi = x->digit[i];
+      digit2_t xi = a[i];
 
-      digit_t *pw = w->digit + (i << 1);
-      digit_t *px = x->digit + (i + 1);
-      digit_t *pe = x->digit + x->size;
+      digit_t *pw = w + (i << 1);
+      digit_t *px = a + (i + 1);
+      digit_t *pe = a + n;
 
       carry = *pw + xi * xi;
       *pw++ = (digit_t)(carry & mask);
@@ -489,28 +675,22 @@ public:
 
       assert((carry >> exp) == 0);
     }
-
-    return w->trim();
   }
 
-  // multiply the big integer with digits in x[0...a] with y[0...b]
-  // and store the result in z[a + b]. It is assumed that a >= b.
-  // All the space should be pre-alocated before execution
-  static void abs_mul_digits(bint_t *x, bint_t *y, bint_t *z) {
-    if (x->size == 0 || y->size == 0) {
-      return z->resize(0);
-    }
-
-    z->resize(x->size + y->size);
+  // Schoolbook multiplication of the digits a[0...n) and b[0...m),
+  // the result is saved on z[0...n + m)
+  static void digits_mul_basecase(digit_t *a, size_t n, digit_t *b, size_t m,
+                                  digit_t *z) {
+    memset(z, 0, sizeof(digit_t) * (n + m));
 
-    for (size_t i = 0; i < x->size; i++) {
+    for (size_t i = 0; i < n; i++) {
       digit2_t carry = 0;
-      digit2_t xi = x->digit[i];
+      digit2_t xi = a[i];
 
-      digit_t *pz = z->digit + i;
-      digit_t *py = y->digit;
+      digit_t *pz = z + i;
+      digit_t *py = b;
 
-      digit_t *pe = y->digit + y->size;
+      digit_t *pe = b + m;
 
       while (py < pe) {
         carry += *pz + *py++ * xi;
@@ -518,176 +698,498 @@ public:
         carry >>= exp;
         assert(carry <= (mask << 1));
       }
+
       if (carry) {
         *pz += (digit_t)(carry & mask);
       }
 
       assert((carry >> exp) == 0);
     }
-
-    return z->trim();
   }
 
-  static void add(bint_t *x, bint_t *y, bint_t *z) {
-    if (x->size <= 1 && y->size <= 1) {
-      digit_t a = x->size > 0 ? x->digit[0] : 0;
-      digit_t b = y->size > 0 ? y->digit[0] : 0;
-
-      int64_t c = (int64_t)a * x->sign + (int64_t)b * y->sign;
+  // Karatsuba multiplication, it is assumed that n >= m > (n + 1)/2.
+  // With k = (n + 1)/2, a = a1*B^k + a0 and b = b1*B^k + b0:
+  // a*b = a1*b1*B^2k + ((a0 + a1)(b0 + b1) - a0*b0 - a1*b1)*B^k + a0*b0
+  static void digits_mul_karatsuba(digit_t *a, size_t n, digit_t *b, size_t m,
+                                   digit_t *z) {
+    size_t k = (n + 1) / 2;
 
-      short s = 1;
+    digit_t *t = (digit_t *)malloc(sizeof(digit_t) * (4 * k + 4));
 
-      if (c < 0) {
-        s = -1;
-        c = -c;
-      }
+    digit_t *sa = t;
+    digit_t *sb = t + k + 1;
+    digit_t *p = t + 2 * k + 2;
 
-      digit2_t v = (digit2_t)c;
-      digit_t A = (digit_t)v & mask;
-      digit_t B = (digit_t)(v >> exp) & mask;
+    // z[0...2k) = a0*b0 and z[2k...n + m) = a1*b1
+    digits_mul(a, k, b, k, z);
+    digits_mul(a + k, n - k, b + k, m - k, z + 2 * k);
 
-      if (B) {
-        z->resize(2);
-        z->sign = s;
-        z->digit[0] = A;
-        z->digit[1] = B;
-      } else if (A) {
-        z->resize(1);
-        z->sign = s;
-        z->digit[0] = A;
-      } else {
-        z->resize(0);
-      }
+    memcpy(sa, a, sizeof(digit_t) * k);
+    memcpy(sb, b, sizeof(digit_t) * k);
 
-      return;
-    }
+    sa[k] = digits_add_to(sa, k, a + k, n - k);
+    sb[k] = digits_add_to(sb, k, b + k, m - k);
 
-    if (x->sign < 0) {
-      if (y->sign < 0) {
-        z->sign = -1 * z->sign;
-        return abs_add_digits(x, y, z);
-      }
+    digits_mul(sa, k + 1, sb, k + 1, p);
 
-      return abs_sub_digits(y, x, z);
-    }
+    digits_sub_from(p, 2 * k + 2, z, 2 * k);
+    digits_sub_from(p, 2 * k + 2, z + 2 * k, n + m - 2 * k);
 
-    if (y->sign < 0) {
-      return abs_sub_digits(x, y, z);
-    }
+    digits_add_to(z + k, n + m - k, p, digits_size(p, 2 * k + 2));
 
-    return abs_add_digits(x, y, z);
+    free(t);
   }
 
-  static void sub(bint_t *x, bint_t *y, bint_t *z) {
-		//printf("aaaaaa\n");
-    if (x->sign < 0) {
-      if (y->sign < 0) {
-        return abs_sub_digits(y, x, z);
-      }
+  // Karatsuba squaring, same as above with a = b
+  static void digits_sqr_karatsuba(digit_t *a, size_t n, digit_t *z) {
+    size_t k = (n + 1) / 2;
 
-      abs_add_digits(x, y, z);
+    digit_t *t = (digit_t *)malloc(sizeof(digit_t) * (3 * k + 3));
 
-      if (z->size) {
-        z->sign = -1 * z->sign;
-      }
+    digit_t *sa = t;
+    digit_t *p = t + k + 1;
 
-      return;
-    }
+    digits_sqr(a, k, z);
+    digits_sqr(a + k, n - k, z + 2 * k);
 
-		//printf("bbbbbbb\n");
+    memcpy(sa, a, sizeof(digit_t) * k);
 
-    if (y->sign < 0) {
-      return abs_add_digits(x, y, z);
-    }
+    sa[k] = digits_add_to(sa, k, a + k, n - k);
 
-		//printf("ccccccc\n");
-    return abs_sub_digits(x, y, z);
-  }
+    digits_sqr(sa, k + 1, p);
 
-  static void mul(bint_t *x, bint_t *y, bint_t *z) {
-    z->sign = x->sign * y->sign;
-    abs_mul_digits(x, y, z);
+    digits_sub_from(p, 2 * k + 2, z, 2 * k);
+    digits_sub_from(p, 2 * k + 2, z + 2 * k, 2 * n - 2 * k);
 
-    return z->trim();
+    digits_add_to(z + k, 2 * n - k, p, digits_size(p, 2 * k + 2));
+
+    free(t);
   }
 
-  static short fast_mod(bint_t *x, bint_t *y, bint_t *rem) {
-    digit_t left = x->digit[0];
-    digit_t righ = y->digit[0];
+  // Multiply a[0...n) by b[0...m) when a is much larger than b,
+  // a is broken in pieces of m digits that are multiplied by b.
+  static void digits_mul_unbalanced(digit_t *a, size_t n, digit_t *b, size_t m,
+                                    digit_t *z) {
+    digit_t *t = (digit_t *)malloc(sizeof(digit_t) * 2 * m);
 
-    rem->resize(1);
+    memset(z, 0, sizeof(digit_t) * (n + m));
 
-    rem->sign = x->sign;
+    for (size_t i = 0; i < n; i += m) {
+      size_t c = std::min(m, n - i);
 
-    rem->digit[0] = left % righ;
+      digits_mul(b, m, a + i, c, t);
+      digits_add_to(z + i, n + m - i, t, digits_size(t, m + c));
+    }
 
-    return 1;
+    free(t);
   }
 
-  static short fast_div(bint_t *x, bint_t *y, bint_t *quo) {
+  // Evaluate x0 + x1*t + x2*t^2 at t = 1, t = -1 and t = -2
+  static void toom3_evaluate(bint_t *x0, bint_t *x1, bint_t *x2, bint_t *p1,
+                             bint_t *pm1, bint_t *pm2) {
+    bint_t t;
 
-    digit_t left = x->digit[0];
-    digit_t righ = y->digit[0];
+    add(x0, x2, &t);
 
-    quo->resize(1);
+    add(&t, x1, p1);
+    sub(&t, x1, pm1);
 
-    quo->sign = x->sign * y->sign;
+    add(pm1, x2, &t);
 
-    quo->digit[0] = left / righ;
+    bint_t *s = lshift(&t, 1);
+    s->sign = t.sign;
 
-    return 1;
-  }
+    sub(s, x0, pm2);
 
-  static short div(bint_t *x, bint_t *y, bint_t *quo, bint_t *rem) {
-    // Following The Art of Computer Programming, Vol.2, section 4.3.1,
-    // Algorithm D.
-    size_t m = x->size;
-    size_t n = y->size;
+    delete s;
+  }
 
-    if (m == 0) {
-      quo->resize(0);
-      rem->resize(0);
+  // Toom-Cook 3-way multiplication, it is assumed that n >= m and
+  // that b have more than 2*k digits for k = (n + 2)/3. The operands
+  // are split in three pieces of k digits, evaluated at 0, 1, -1, -2
+  // and infinity and the product is interpolated using the sequence
+  // given by Bodrato and Zanoni.
+  static void digits_mul_toom3(digit_t *a, size_t n, digit_t *b, size_t m,
+                               digit_t *z) {
+    bool square = a == b && n == m;
 
-      return 1;
-    }
+    size_t k = (n + 2) / 3;
 
-    if (n == 0) {
-			raise(error(ErrorCode::DIVISION_BY_ZERO, 1));
-    }
+    bint_t *a0 = from_digits(a, k);
+    bint_t *a1 = from_digits(a + k, k);
+    bint_t *a2 = from_digits(a + 2 * k, n - 2 * k);
 
-    if (m < n || (m == n && x->digit[m - 1] < y->digit[n - 1])) {
-      quo->resize(0);
-      quo->sign = 1;
+    bint_t p1, pm1, pm2;
 
-      rem->resize(x->size);
-      rem->sign = x->sign;
+    toom3_evaluate(a0, a1, a2, &p1, &pm1, &pm2);
 
-      for (size_t i = 0; i < x->size; i++)
-        rem->digit[i] = x->digit[i];
+    bint_t r0, r1, rm1, rm2, r4;
 
-      return 1;
-    }
+    if (square) {
+      mul(a0, a0, &r0);
+      mul(&p1, &p1, &r1);
+      mul(&pm1, &pm1, &rm1);
+      mul(&pm2, &pm2, &rm2);
+      mul(a2, a2, &r4);
+    } else {
+      bint_t *b0 = from_digits(b, k);
+      bint_t *b1 = from_digits(b + k, k);
+      bint_t *b2 = from_digits(b + 2 * k, m - 2 * k);
 
-    if (m == 1 && n == 1) {
-      fast_div(x, y, quo);
+      bint_t q1, qm1, qm2;
 
-      quo->trim();
+      toom3_evaluate(b0, b1, b2, &q1, &qm1, &qm2);
 
-      if (rem) {
-        fast_mod(x, y, rem);
-        rem->trim();
-      }
+      mul(a0, b0, &r0);
+      mul(&p1, &q1, &r1);
+      mul(&pm1, &qm1, &rm1);
+      mul(&pm2, &qm2, &rm2);
+      mul(a2, b2, &r4);
 
-      return 1;
+      delete b0;
+      delete b1;
+      delete b2;
     }
 
-    quo->sign = x->sign * y->sign;
-    rem->sign = x->sign * y->sign;
+    delete a0;
+    delete a1;
+    delete a2;
 
-    if (n < 2) {
-      digit2_t r = 0;
+    bint_t t1, t2, t3, t;
 
-      digit_t k = y->digit[0];
+    // t3 = (r(-2) - r(1))/3
+    sub(&rm2, &r1, &t3);
+    digits_div_small(t3.digit, t3.size, 3, t3.digit);
+    t3.trim();
+
+    // t1 = (r(1) - r(-1))/2
+    sub(&r1, &rm1, &t1);
+    digits_rshift(t1.digit, t1.size, 1, t1.digit);
+    t1.trim();
+
+    // t2 = r(-1) - r(0)
+    sub(&rm1, &r0, &t2);
+
+    // t3 = (t2 - t3)/2 + 2*r(inf)
+    sub(&t2, &t3, &t);
+    digits_rshift(t.digit, t.size, 1, t.digit);
+    t.trim();
+
+    bint_t *r4x2 = lshift(&r4, 1);
+
+    add(&t, r4x2, &t3);
+
+    delete r4x2;
+
+    // t2 = t2 + t1 - r(inf)
+    add(&t2, &t1, &t);
+    sub(&t, &r4, &t2);
+
+    // t1 = t1 - t3
+    sub(&t1, &t3, &t);
+
+    // every coefficient of the product is non negative
+    assert(t.sign > 0 && t2.sign > 0 && t3.sign > 0);
+
+    size_t s = n + m;
+
+    memset(z, 0, sizeof(digit_t) * s);
+
+    memcpy(z, r0.digit, sizeof(digit_t) * r0.size);
+
+    digits_add_to(z + k, s - k, t.digit, t.size);
+    digits_add_to(z + 2 * k, s - 2 * k, t2.digit, t2.size);
+    digits_add_to(z + 3 * k, s - 3 * k, t3.digit, t3.size);
+    digits_add_to(z + 4 * k, s - 4 * k, r4.digit, r4.size);
+  }
+
+  // number of digits used by the transforms for every digit
+  static const size_t ntt_split = (exp + 30) / 31;
+
+  // Multiply a[0...n) by b[0...m) using the number theoretic
+  // transform over three primes, see NTT.hpp. The transforms work on
+  // digits of at most 31 bits, so wider digits are split in halves.
+  static void digits_mul_ntt(digit_t *a, size_t n, digit_t *b, size_t m,
+                             digit_t *z) {
+    if (std::is_same<digit_t, uint32_t>::value) {
+      return ntt::multiply((uint32_t *)a, n, (uint32_t *)b, m, exp,
+                           (uint32_t *)z);
+    }
+
+    // every digit is split in k digits of h bits
+    const size_t k = ntt_split;
+    const unsigned h = (exp + k - 1) / k;
+
+    const digit_t hmask = ((digit_t)1 << h) - 1;
+
+    std::vector<uint32_t> x(k * n);
+    std::vector<uint32_t> y(k * m);
+    std::vector<uint32_t> w(k * (n + m));
+
+    for (size_t i = 0; i < k * n; i++) {
+      x[i] = (uint32_t)((a[i / k] >> (i % k * h)) & hmask);
+    }
+
+    for (size_t i = 0; i < k * m; i++) {
+      y[i] = (uint32_t)((b[i / k] >> (i % k * h)) & hmask);
+    }
+
+    ntt::multiply(x.data(), k * n, a == b && n == m ? x.data() : y.data(),
+                  k * m, h, w.data());
+
+    for (size_t i = 0; i < n + m; i++) {
+      z[i] = 0;
+
+      for (size_t j = 0; j < k; j++) {
+        z[i] |= (digit_t)w[k * i + j] << (j * h);
+      }
+    }
+  }
+
+  // Square the digits a[0...n) and store the result in z[0...2*n),
+  // the algorithm is selected by the size of the input.
+  static void digits_sqr(digit_t *a, size_t n, digit_t *z) {
+    if (n < KARATSUBA_SQR_THRESHOLD) {
+      return digits_sqr_basecase(a, n, z);
+    }
+
+    if (n < TOOM3_SQR_THRESHOLD) {
+      return digits_sqr_karatsuba(a, n, z);
+    }
+
+    // the thresholds count the digits given to the transform
+    if (n * ntt_split < NTT_SQR_THRESHOLD ||
+        2 * n * ntt_split > ntt::MAX_LENGTH) {
+      return digits_mul_toom3(a, n, a, n, z);
+    }
+
+    return digits_mul_ntt(a, n, a, n, z);
+  }
+
+  // Multiply the digits a[0...n) by b[0...m) and store the result
+  // in z[0...n + m), the algorithm is selected by the size of the
+  // inputs. The output can't overlap with the inputs.
+  static void digits_mul(digit_t *a, size_t n, digit_t *b, size_t m,
+                         digit_t *z) {
+    if (a == b && n == m) {
+      return digits_sqr(a, n, z);
+    }
+
+    if (n < m) {
+      std::swap(a, b);
+      std::swap(n, m);
+    }
+
+    if (m < KARATSUBA_MUL_THRESHOLD) {
+      return digits_mul_basecase(a, n, b, m, z);
+    }
+
+    if (m <= (n + 1) / 2) {
+      return digits_mul_unbalanced(a, n, b, m, z);
+    }
+
+    if (m * ntt_split >= NTT_MUL_THRESHOLD &&
+        (n + m) * ntt_split <= ntt::MAX_LENGTH) {
+      return digits_mul_ntt(a, n, b, m, z);
+    }
+
+    if (m >= TOOM3_MUL_THRESHOLD && m > 2 * ((n + 2) / 3)) {
+      return digits_mul_toom3(a, n, b, m, z);
+    }
+
+    return digits_mul_karatsuba(a, n, b, m, z);
+  }
+
+  // Square the bint of digits x[0...a] and store the
+  // result in w[0...2*a]
+  static void abs_square_digits(bint_t *x, bint_t *w) {
+    if (x->size == 0) {
+      return w->resize(0);
+    }
+
+    w->resize(2 * x->size);
+
+    digits_sqr(x->digit, x->size, w->digit);
+
+    return w->trim();
+  }
+
+  // multiply the big integer with digits in x[0...a] with y[0...b]
+  // and store the result in z[a + b]. It is assumed that a >= b.
+  // All the space should be pre-alocated before execution
+  static void abs_mul_digits(bint_t *x, bint_t *y, bint_t *z) {
+    if (x->size == 0 || y->size == 0) {
+      return z->resize(0);
+    }
+
+    z->resize(x->size + y->size);
+
+    digits_mul(x->digit, x->size, y->digit, y->size, z->digit);
+
+    return z->trim();
+  }
+
+  static void add(bint_t *x, bint_t *y, bint_t *z) {
+    if (x->size <= 1 && y->size <= 1) {
+      digit_t a = x->size > 0 ? x->digit[0] : 0;
+      digit_t b = y->size > 0 ? y->digit[0] : 0;
+
+      sdigit2_t c = (sdigit2_t)a * x->sign + (sdigit2_t)b * y->sign;
+
+      short s = 1;
+
+      if (c < 0) {
+        s = -1;
+        c = -c;
+      }
+
+      digit2_t v = (digit2_t)c;
+      digit_t A = (digit_t)v & mask;
+      digit_t B = (digit_t)(v >> exp) & mask;
+
+      if (B) {
+        z->resize(2);
+        z->sign = s;
+        z->digit[0] = A;
+        z->digit[1] = B;
+      } else if (A) {
+        z->resize(1);
+        z->sign = s;
+        z->digit[0] = A;
+      } else {
+        z->resize(0);
+      }
+
+      return;
+    }
+
+    if (x->sign < 0) {
+      if (y->sign < 0) {
+        abs_add_digits(x, y, z);
+        z->sign = -1;
+        return;
+      }
+
+      return abs_sub_digits(y, x, z);
+    }
+
+    if (y->sign < 0) {
+      return abs_sub_digits(x, y, z);
+    }
+
+    return abs_add_digits(x, y, z);
+  }
+
+  static void sub(bint_t *x, bint_t *y, bint_t *z) {
+		//printf("aaaaaa\n");
+    if (x->sign < 0) {
+      if (y->sign < 0) {
+        return abs_sub_digits(y, x, z);
+      }
+
+      abs_add_digits(x, y, z);
+
+      if (z->size) {
+        z->sign = -1 * z->sign;
+      }
+
+      return;
+    }
+
+		//printf("bbbbbbb\n");
+
+    if (y->sign < 0) {
+      return abs_add_digits(x, y, z);
+    }
+
+		//printf("ccccccc\n");
+    return abs_sub_digits(x, y, z);
+  }
+
+  static void mul(bint_t *x, bint_t *y, bint_t *z) {
+    z->sign = x->sign * y->sign;
+    abs_mul_digits(x, y, z);
+
+    return z->trim();
+  }
+
+  static short fast_mod(bint_t *x, bint_t *y, bint_t *rem) {
+    digit_t left = x->digit[0];
+    digit_t righ = y->digit[0];
+
+    rem->resize(1);
+
+    rem->sign = x->sign;
+
+    rem->digit[0] = left % righ;
+
+    return 1;
+  }
+
+  static short fast_div(bint_t *x, bint_t *y, bint_t *quo) {
+
+    digit_t left = x->digit[0];
+    digit_t righ = y->digit[0];
+
+    quo->resize(1);
+
+    quo->sign = x->sign * y->sign;
+
+    quo->digit[0] = left / righ;
+
+    return 1;
+  }
+
+  static short div(bint_t *x, bint_t *y, bint_t *quo, bint_t *rem) {
+    // Following The Art of Computer Programming, Vol.2, section 4.3.1,
+    // Algorithm D.
+    size_t m = x->size;
+    size_t n = y->size;
+
+    if (m == 0) {
+      quo->resize(0);
+      rem->resize(0);
+
+      return 1;
+    }
+
+    if (n == 0) {
+			raise(error(ErrorCode::DIVISION_BY_ZERO, 1));
+    }
+
+    if (m < n || (m == n && x->digit[m - 1] < y->digit[n - 1])) {
+      quo->resize(0);
+      quo->sign = 1;
+
+      rem->resize(x->size);
+      rem->sign = x->sign;
+
+      for (size_t i = 0; i < x->size; i++)
+        rem->digit[i] = x->digit[i];
+
+      return 1;
+    }
+
+    if (m == 1 && n == 1) {
+      fast_div(x, y, quo);
+
+      quo->trim();
+
+      if (rem) {
+        fast_mod(x, y, rem);
+        rem->trim();
+      }
+
+      return 1;
+    }
+
+    quo->sign = x->sign * y->sign;
+    rem->sign = x->sign * y->sign;
+
+    if (n < 2) {
+      digit2_t r = 0;
+
+      digit_t k = y->digit[0];
 
       quo->resize(m);
 
@@ -715,6 +1217,19 @@ public:
       return 1;
     }
 
+    if (n >= BZ_DIV_THRESHOLD && m - n >= BZ_DIV_THRESHOLD) {
+      div_blocks(x, y, quo, rem,
+                 n >= NEWTON_DIV_THRESHOLD && m - n >= 2 * n);
+
+      if (quo->size)
+        quo->sign = x->sign * y->sign;
+
+      if (rem && rem->size)
+        rem->sign = x->sign * y->sign;
+
+      return 1;
+    }
+
     digit_t carry = 0;
 
     // D1: Normalization
@@ -829,48 +1344,502 @@ public:
     return 1;
   }
 
-  // TODO: to string of the number in base 10
-  // TODO: add construction from strings and const char* types
+  // exchange the values of this bint and other
+  void swap(bint_t *other) {
+    bool a = digit == local;
+    bool b = other->digit == other->local;
 
-  static short compare(bint_t *v0, bint_t *v1) {
-    if (v0->size == 0 && v1->size == 0)
-      return 0;
+    std::swap(digit, other->digit);
+    std::swap(size, other->size);
+    std::swap(sign, other->sign);
+    std::swap(capacity, other->capacity);
 
-    if (v0->sign != v1->sign)
-      return v0->sign > v1->sign ? 1 : -1;
-    if (v0->size != v1->size)
-      return v0->size > v1->size ? 1 : -1;
+    // the inline digits need to move with their numbers
+    if (a || b) {
+      for (size_t i = 0; i < inline_digits; i++) {
+        std::swap(local[i], other->local[i]);
+      }
 
-    size_t i = v0->size - 1;
+      if (a)
+        other->digit = other->local;
+      if (b)
+        digit = local;
+    }
+  }
 
-    while (i > 0 && v0->digit[i] == v1->digit[i])
-      --i;
+  // compare the digits a[0...n) and b[0...m) without leading zeros
+  static short digits_compare(digit_t *a, size_t n, digit_t *b, size_t m) {
+    if (n != m)
+      return n > m ? 1 : -1;
 
-    if (i == 0 && v0->digit[0] == v1->digit[0])
-      return 0;
+    for (size_t i = n; i-- > 0;) {
+      if (a[i] != b[i])
+        return a[i] > b[i] ? 1 : -1;
+    }
 
-    return v0->digit[i] > v1->digit[i] ? 1 : -1;
+    return 0;
   }
 
+  // Buffers used by the in place operations to hold intermediate
+  // results. They are only used by the operations below, that never
+  // call each other, so their memory can be reused between calls.
+  static bint_t *scratch(size_t i) {
+    static thread_local bint_t t[2];
 
-  static short compare(long long j, bint_t *v1) {
-		short b_sign = j < 0 ? -1 : 1;
+    return &t[i];
+  }
 
-		j = j < 0 ? -j : j;
+  // z = z + s*y in place, where s is 1 or -1, y can be equal to z
+  static void add_in_place(bint_t *z, bint_t *y, short s) {
+    size_t m = y->size;
 
-		digit_t b[3];
-		size_t b_size;
+    if (m == 0)
+      return;
+
+    short ys = s * y->sign;
+
+    if (z->size == 0) {
+      z->set(y);
+      z->sign = ys;
+      return;
+    }
+
+    if (z->sign == ys) {
+      size_t n = std::max(z->size, m);
+
+      z->extend(n + 1);
+
+      digit_t carry = digits_add_to(z->digit, n + 1, y->digit, m);
+
+      assert(carry == 0);
+
+      z->trim();
+
+      return;
+    }
+
+    if (digits_compare(z->digit, z->size, y->digit, m) >= 0) {
+      digits_sub_from(z->digit, z->size, y->digit, m);
+
+      z->trim();
+
+      return;
+    }
+
+    // |z| < |y|, so z = s*y - z
+    z->extend(m);
+
+    digit_t borrow = 0;
+
+    for (size_t i = 0; i < m; i++) {
+      borrow = y->digit[i] - z->digit[i] - borrow;
+      z->digit[i] = borrow & mask;
+      borrow >>= exp;
+      borrow &= 1;
+    }
+
+    z->sign = ys;
+
+    z->trim();
+  }
+
+  // z = z + s*x*y in place, where s is 1 or -1
+  static void addmul(bint_t *z, bint_t *x, bint_t *y, short s = 1) {
+    if (x->size == 0 || y->size == 0)
+      return;
+
+    bint_t *t = scratch(0);
+
+    mul(x, y, t);
+
+    add_in_place(z, t, s);
+  }
+
+  // z = z - x*y in place
+  static void submul(bint_t *z, bint_t *x, bint_t *y) { addmul(z, x, y, -1); }
+
+  // z = z*y in place, y can be equal to z
+  static void mul_in_place(bint_t *z, bint_t *y) {
+    bint_t *t = scratch(0);
+
+    mul(z, y, t);
+
+    z->swap(t);
+  }
+
+  // z = quotient or remainder of z/y in place, following the sign
+  // conventions of div
+  static void div_in_place(bint_t *z, bint_t *y, bool quotient) {
+    bint_t *q = scratch(0);
+    bint_t *r = scratch(1);
+
+    div(z, y, q, r);
+
+    z->swap(quotient ? q : r);
+  }
+
+  // returns a copy of the digits a[from...to) as a new bint
+  static bint_t *digits_slice(bint_t *a, size_t from, size_t to) {
+    to = std::min(to, a->size);
+
+    if (from >= to) {
+      return new bint_t();
+    }
+
+    return from_digits(a->digit + from, to - from);
+  }
+
+  // returns a*base^k as a new bint
+  static bint_t *digits_lshift_by(bint_t *a, size_t k) {
+    bint_t *t = new bint_t();
+
+    if (a->size == 0) {
+      return t;
+    }
+
+    t->resize(a->size + k);
+    t->sign = a->sign;
+
+    memcpy(t->digit + k, a->digit, sizeof(digit_t) * a->size);
+
+    return t;
+  }
+
+  // Burnikel-Ziegler recursive division, see [4] Algorithm 1.8. The
+  // inputs are non negative, b is normalized with n digits and
+  // a < base^m*b. The quotient and remainder are saved on q and r.
+  static void div_recursive(bint_t *a, bint_t *b, size_t m, bint_t *q,
+                            bint_t *r) {
+    size_t n = b->size;
+
+    if (m < BZ_DIV_THRESHOLD || n < BZ_DIV_THRESHOLD) {
+      div(a, b, q, r);
+      return;
+    }
+
+    size_t k = m / 2;
+
+    bint_t *b0 = digits_slice(b, 0, k);
+    bint_t *b1 = digits_slice(b, k, n);
+
+    bint_t *q1 = new bint_t();
+    bint_t *q0 = new bint_t();
+    bint_t *r1 = new bint_t();
+    bint_t *r0 = new bint_t();
+    bint_t *t = new bint_t();
+
+    bint_t *ah = digits_slice(a, 2 * k, a->size);
+
+    div_recursive(ah, b1, m - k, q1, r1);
+
+    // x = r1*base^2k + (a mod base^2k) - q1*b0*base^k
+    bint_t *x = digits_lshift_by(r1, 2 * k);
+    bint_t *al = digits_slice(a, 0, 2 * k);
+
+    ADD(x, al, x);
+
+    mul(q1, b0, t);
+
+    bint_t *u = digits_lshift_by(t, k);
+
+    SUB(x, u, x);
+
+    if (x->sign < 0) {
+      bint_t *bk = digits_lshift_by(b, k);
+
+      while (x->sign < 0) {
+        ADD(x, bk, x);
+        {
+          bint_t *tmp = new bint_t();
+          sub(q1, 1, tmp);
+          delete q1;
+          q1 = tmp;
+        }
+      }
+
+      delete bk;
+    }
+
+    bint_t *xh = digits_slice(x, k, x->size);
+
+    div_recursive(xh, b1, k, q0, r0);
+
+    // y = r0*base^k + (x mod base^k) - q0*b0
+    bint_t *y = digits_lshift_by(r0, k);
+    bint_t *xl = digits_slice(x, 0, k);
+
+    ADD(y, xl, y);
+
+    mul(q0, b0, t);
+
+    SUB(y, t, y);
+
+    while (y->sign < 0) {
+      ADD(y, b, y);
+      {
+        bint_t *tmp = new bint_t();
+        sub(q0, 1, tmp);
+        delete q0;
+        q0 = tmp;
+      }
+    }
+
+    bint_t *w = digits_lshift_by(q1, k);
+
+    add(w, q0, q);
+
+    r->swap(y);
+
+    delete b0;
+    delete b1;
+    delete q1;
+    delete q0;
+    delete r1;
+    delete r0;
+    delete t;
+    delete ah;
+    delete al;
+    delete x;
+    delete u;
+    delete xh;
+    delete xl;
+    delete y;
+    delete w;
+  }
+
+  // returns floor(base^2n/b) for a normalized b with n digits, the
+  // reciprocal of the top half of b is refined with one Newton step
+  // and the result is corrected using the exact remainder.
+  static bint_t *reciprocal(bint_t *b) {
+    size_t n = b->size;
+
+    bint_t *p = new bint_t();
+
+    p->resize(2 * n + 1);
+    p->digit[2 * n] = 1;
+
+    bint_t *x = new bint_t();
+
+    if (n < 2 * BZ_DIV_THRESHOLD) {
+      bint_t *r = new bint_t();
+
+      div(p, b, x, r);
+
+      delete r;
+      delete p;
+
+      return x;
+    }
+
+    // two guard digits so that a single Newton step gives
+    // all the n digits up to a few units
+    size_t h = (n + 1) / 2 + 2;
+
+    bint_t *bh = digits_slice(b, n - h, n);
+    bint_t *xh = reciprocal(bh);
+
+    bint_t *t = new bint_t();
+    bint_t *e = new bint_t();
+
+    delete x;
+
+    x = digits_lshift_by(xh, n - h);
+
+    // e = base^2n - b*x
+    mul(b, x, t);
+    sub(p, t, e);
+
+    // x = x + x*e/base^2n
+    mul(xh, e, t);
+
+    bint_t *d = digits_slice(t, n + h, t->size);
+
+    if (d->size) {
+      d->sign = t->sign;
+    }
+
+    ADD(x, d, x);
+
+    // correction, e = base^2n - b*x must be in [0, b)
+    mul(b, x, t);
+    sub(p, t, e);
+
+    while (e->sign < 0) {
+      ADD(e, b, e);
+      {
+        bint_t *tmp = new bint_t();
+        sub(x, 1, tmp);
+        delete x;
+        x = tmp;
+      }
+    }
+
+    while (compare(e, b) >= 0) {
+      SUB(e, b, e);
+      {
+        bint_t *tmp = new bint_t();
+        add(x, 1, tmp);
+        delete x;
+        x = tmp;
+      }
+    }
+
+    delete p;
+    delete bh;
+    delete xh;
+    delete t;
+    delete e;
+    delete d;
+
+    return x;
+  }
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+  // Divide a < base^n*b by the normalized b with n digits using the
+  // reciprocal v = floor(base^2n/b).
+  static void div_reciprocal(bint_t *a, bint_t *b, bint_t *v, bint_t *q,
+                             bint_t *r) {
+    size_t n = b->size;
+
+    bint_t *t = new bint_t();
+
+    // q = floor(floor(a/base^(n - 1))*v/base^(n + 1)) is at most
+    // a few units smaller than the quotient
+    bint_t *ah = digits_slice(a, n - 1, a->size);
+
+    mul(ah, v, t);
+
+    bint_t *x = digits_slice(t, n + 1, t->size);
+
+    mul(x, b, t);
+
+    bint_t *y = new bint_t();
+
+    sub(a, t, y);
+
+    while (y->sign < 0) {
+      ADD(y, b, y);
+      {
+        bint_t *tmp = new bint_t();
+        sub(x, 1, tmp);
+        delete x;
+        x = tmp;
+      }
+    }
+
+    while (compare(y, b) >= 0) {
+      SUB(y, b, y);
+      {
+        bint_t *tmp = new bint_t();
+        add(x, 1, tmp);
+        delete x;
+        x = tmp;
+      }
+    }
+
+    q->swap(x);
+    r->swap(y);
+
+    delete t;
+    delete ah;
+    delete x;
+    delete y;
+  }
+
+  // Divide |x| by |y| in blocks of n digits, where n is the number
+  // of digits of y. Each block is divided using the Burnikel-Ziegler
+  // recursion or, if newton is set, the reciprocal of y.
+  static void div_blocks(bint_t *x, bint_t *y, bint_t *quo, bint_t *rem,
+                         bool newton) {
+    int d = exp - high_bit(y->digit[y->size - 1]);
+
+    bint_t *a = lshift(x, d);
+    bint_t *b = lshift(y, d);
+
+    size_t n = b->size;
+    size_t l = (a->size + n - 1) / n;
+
+    bint_t *v = newton ? reciprocal(b) : nullptr;
+
+    bint_t *r = new bint_t();
+    bint_t *q = new bint_t();
+
+    quo->resize(l * n);
+
+    for (size_t j = l; j-- > 0;) {
+      bint_t *c = digits_lshift_by(r, n);
+      bint_t *s = digits_slice(a, j * n, (j + 1) * n);
+
+      ADD(c, s, c);
+
+      if (newton) {
+        div_reciprocal(c, b, v, q, r);
+      } else {
+        div_recursive(c, b, n, q, r);
+      }
+
+      assert(q->size <= n);
+
+      memcpy(quo->digit + j * n, q->digit, sizeof(digit_t) * q->size);
+
+      delete c;
+      delete s;
+    }
+
+    quo->trim();
+
+    if (rem) {
+      bint_t *t = rshift(r, d);
+
+      rem->swap(t);
+
+      delete t;
+    }
+    delete a;
+    delete b;
+    delete v;
+    delete r;
+    delete q;
+  }
+
+  static short compare(bint_t *v0, bint_t *v1) {
+    if (v0->size == 0 && v1->size == 0)
+      return 0;
+
+    if (v0->sign != v1->sign)
+      return v0->sign > v1->sign ? 1 : -1;
+
+    // same signs, the order of the magnitudes is reversed if negative
+    return v0->sign * digits_compare(v0->digit, v0->size, v1->digit, v1->size);
+  }
+
+
+  // number of digits needed by the magnitude of a long long
+  static const size_t long_digits =
+      (CHAR_BIT * sizeof(long long) + exp - 1) / exp;
+
+  // save the digits of |j| on b, returns the number of digits
+  static size_t digits_of(long long j, digit_t *b) {
+    unsigned long long u = j < 0 ? -(unsigned long long)j : j;
+
+    size_t n = 0;
+
+    while (u) {
+      b[n++] = (digit_t)u & mask;
+      u = (u >> (exp / 2)) >> (exp - exp / 2);
+    }
+
+    return n;
+  }
+
+  static short compare(long long j, bint_t *v1) {
+		short b_sign = j < 0 ? -1 : 1;
+
+
+		digit_t b[long_digits];
+		size_t b_size;
+
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
 
 		if (b_size == 0 && v1->size == 0) {
@@ -880,19 +1849,8 @@ public:
     if (b_sign != v1->sign) {
 			return b_sign > v1->sign ? 1 : -1;
 		}
-    if (b_size != v1->size) {
-      return b_size > v1->size ? 1 : -1;
-		}
-    size_t i = b_size - 1;
-
-    while (i > 0 && b[i] == v1->digit[i])
-      --i;
-
-    if (i == 0 && b[0] == v1->digit[0]) {
-      return 0;
-		}
 
-    return b[i] > v1->digit[i] ? 1 : -1;
+    return b_sign * digits_compare(b, b_size, v1->digit, v1->size);
   }
 
   static short compare(bint_t *v1, long long j) {
@@ -916,7 +1874,7 @@ public:
 
     double dx;
 
-    digit_t x_digits[2 + (DBL_MANT_DIG + 1) / exp] = {
+    digit_t x_digits[3 + (DBL_MANT_DIG + 1) / exp] = {
         0,
     };
 
@@ -1035,34 +1993,53 @@ public:
     return 1;
   }
 
+  // saves b on v, returns -1 if it doesn't fit on a long long
   static short to_long(bint_t *b, long long *v) {
     if (b->size == 0) {
       *v = 0;
       return 1;
     }
 
-    if (b->size == 1) {
-      *v = (long long)b->digit[0] * b->sign;
-      return 1;
+    size_t bits = exp * (b->size - 1) + high_bit(b->digit[b->size - 1]);
+
+    if (bits > CHAR_BIT * sizeof(long long) - 1) {
+      return -1;
     }
 
-		if (exp * b->size <= CHAR_BIT * sizeof(long long)) {
-      digit_t *z = b->digit;
+    unsigned long long u = 0;
 
-      *v = 0;
+    for (size_t i = b->size; i-- > 0;) {
+      u = (u << (exp % 64)) | b->digit[i];
+    }
 
-      for (size_t i = 0; i < b->size - 1; i += 2) {
-        digit2_t x = (digit2_t)z[i + 1] << exp;
-        digit2_t y = (digit2_t)z[i];
-        *v |= (long long)((digit2_t)(x | y)) << (i * exp);
-      }
+    *v = (long long)u * b->sign;
+
+    return 1;
+  }
 
-      *v = *v * b->sign;
+  // number of bits of |a|
+  static size_t bit_length(bint_t *a) {
+    if (a->size == 0)
+      return 0;
 
-      return 1;
+    return (a->size - 1) * exp + high_bit(a->digit[a->size - 1]);
+  }
+
+  // z = |v| >> a, z needs to be different from v
+  static void rshift_to(bint_t *v, size_t a, bint_t *z) {
+    size_t c = a / exp;
+
+    if (v->size <= c) {
+      return z->resize(0);
     }
 
-		return -1;
+    size_t n = v->size - c;
+
+    z->resize(n);
+
+    digits_rshift(v->digit + c, n, a % exp, z->digit);
+
+    z->trim();
   }
 
   static bint_t *ceil_log2(bint_t *a) {
@@ -1206,16 +2183,16 @@ public:
   }
 
   void set(bint_t *other) {
-    if (digit) {
-      free(digit);
-    }
+    if (this == other)
+      return;
+
+    reserve(other->size);
 
     size = other->size;
     sign = other->sign;
 
-    digit = (digit_t *)malloc(sizeof(digit_t) * size);
-
-    memcpy(digit, other->digit, sizeof(digit_t) * size);
+    if (size)
+      memcpy(digit, other->digit, sizeof(digit_t) * size);
   }
 
   static void isqrt(bint_t *x, bint_t *a, bint_t *rem) {
@@ -1255,198 +2232,938 @@ public:
       if (y->size)
         n = y->digit[0] & 3;
 
-      delete y;
+      delete y;
+
+      // i <- a*a
+      mul(a, a, i);
+
+      // t1 <- N - a*a
+      sub(N, i, j);
+
+      // r0 <- (N - a*a) << 2
+      t = lshift(j, 2);
+
+      // r0 <- ((N - a*a) << 2) + n
+      add_small_constant(t, n);
+
+      // t2 <- (a << 2)
+      k = lshift(a, 2);
+
+      // r1 <- (a << 2) + 1
+
+      add_small_constant(k, 1);
+
+      // ((N - a*a) << 2) + n >= (a<<2) + 1
+      if (compare(t, k) >= 0)
+        b = 1;
+
+      delete t;
+      delete k;
+
+      t = lshift(a, 1);
+      k = lshift(N, 2);
+
+      pipe_small_constant(t, b);
+      pipe_small_constant(k, n);
+
+      a->set(t);
+      N->set(k);
+
+      delete t;
+      delete k;
+    }
+
+    if (rem) {
+      // rem is N - a*a
+      mul(a, a, i);
+      sub(N, i, rem);
+    }
+
+    delete N;
+    delete i;
+    delete j;
+  }
+
+  static double pow(bint_t *a, double e) {
+    double v = 0;
+
+		if(to_double(a, &v) == 1) {
+			raise(error(ErrorCode::DOUBLE_OVERFLOW, 0));
+		}
+
+    return std::pow(v, e);
+  }
+
+  static bint_t *pow(bint_t *a, bint_t *e) {
+    if (e->size == 0)
+      return from(1);
+    if (e->size == 1 && e->digit[0] == 1)
+      return a->copy();
+
+    bint_t *z = a->copy();
+
+    long long i = e->size;
+
+    digit_t bi = i ? e->digit[i - 1] : 0;
+
+    if (i <= 1 && bi <= 3) {
+      if (bi >= 2) {
+        MUL(a, a, z);
+
+        if (bi == 3) {
+          MUL(z, a, z);
+        }
+      }
+    } else if (i <= 8) {
+      // Left-to-right binary exponentiation
+      digit_t bit;
+
+      for (bit = 2;; bit <<= 1) {
+        if (bit > bi) {
+          bit >>= 1;
+          break;
+        }
+      }
+
+      for (--i, bit >>= 1;;) {
+        for (; bit != 0; bit >>= 1) {
+          MUL(z, z, z);
+
+          if (bi & bit) {
+            MUL(z, a, z);
+          }
+        }
+
+        if (--i < 0) {
+          break;
+        }
+
+        bi = e->digit[i];
+        bit = (digit_t)1 << (exp - 1);
+      }
+    } else {
+      // Left to right fixed window exponentiation with windows of 5
+      // bits, Handbook of Applied Cryptography - Algorithm 14.82
+      delete z;
+
+      bint_t table[32];
+
+      table[0].resize(1);
+      table[0].digit[0] = 1;
+
+      table[1].set(a);
+
+      for (size_t i = 2; i < 32; ++i) {
+        mul(&table[i - 1], a, &table[i]);
+      }
+
+      // the windows are aligned on the least significant bit
+      size_t w = (bit_length(e) + 4) / 5 * 5;
+
+      z = new bint_t();
+
+      z->set(&table[bits_at(e, w - 5, 5)]);
+
+      for (w -= 5; w > 0; w -= 5) {
+        for (size_t k = 0; k < 5; ++k) {
+          mul_in_place(z, z);
+        }
+
+        digit_t index = bits_at(e, w - 5, 5);
+
+        if (index) {
+          mul_in_place(z, &table[index]);
+        }
+      }
+    }
+
+    return z;
+  }
+
+  // returns the bits [b, b + n) of |e|, with n < exp
+  static digit_t bits_at(bint_t *e, size_t b, size_t n) {
+    size_t i = b / exp;
+    size_t o = b % exp;
+
+    if (i >= e->size) {
+      return 0;
+    }
+
+    digit_t v = e->digit[i] >> o;
+
+    if (o + n > exp && i + 1 < e->size) {
+      v |= e->digit[i + 1] << (exp - o);
+    }
+
+    return v & (((digit_t)1 << n) - 1);
+  }
+
+  // Multiplication modulo a fixed m > 0, if m is odd the numbers are
+  // kept on the Montgomery form x*base^n mod m, where n is the number
+  // of digits of m, see Handbook of Applied Cryptography - Algorithm
+  // 14.36. Otherwise the products are reduced with divisions.
+  struct mod_ring {
+    bint_t *m;
+
+    size_t n;
+
+    // -m^-1 mod base
+    digit_t minv;
+
+    bool montgomery;
+
+    bint_t t, q;
+
+    std::vector<digit_t> acc, pad;
+
+    mod_ring(bint_t *m)
+        : m(m), n(m->size), minv(0), montgomery(m->digit[0] & 1) {
+      if (!montgomery) {
+        return;
+      }
+
+      // Newton iteration for m^-1 mod base, every step doubles
+      // the number of correct bits, starting from 3
+      digit_t inv = m->digit[0];
+
+      for (int i = 0; i < 5; i++) {
+        inv *= 2 - m->digit[0] * inv;
+      }
+
+      minv = (digit_t)(0 - inv) & mask;
+
+      acc.resize(n + 2);
+      pad.resize(n);
+    }
+
+    // z = x mod m on the ring representation, x can be any integer
+    void to(bint_t *x, bint_t *z) {
+      if (montgomery) {
+        bint_t *y = digits_lshift_by(x, n);
+
+        div(y, m, &q, z);
+
+        delete y;
+      } else {
+        div(x, m, &q, z);
+      }
+
+      if (z->size && z->sign < 0) {
+        add_in_place(z, m, 1);
+      }
+    }
+
+    // convert z from the ring representation
+    void from(bint_t *z) {
+      if (montgomery) {
+        t.resize(1);
+        t.digit[0] = 1;
+        t.sign = 1;
+
+        mul(z, &t, z);
+      }
+    }
+
+    // z = x*y on the ring, the arguments are in [0, m) and can be
+    // equal to z
+    void mul(bint_t *x, bint_t *y, bint_t *z) {
+      if (!montgomery) {
+        bint_t::mul(x, y, &t);
+
+        div(&t, m, &q, z);
+
+        return;
+      }
+
+      digit_t *a = acc.data();
+      digit_t *b = pad.data();
+
+      std::fill(b, b + n, 0);
+      std::copy(y->digit, y->digit + y->size, b);
+
+      std::fill(a, a + n + 2, 0);
+
+      for (size_t i = 0; i < n; i++) {
+        digit_t xi = i < x->size ? x->digit[i] : 0;
+
+        digit2_t c = 0;
+
+        for (size_t j = 0; j < n; j++) {
+          c += a[j] + (digit2_t)xi * b[j];
+          a[j] = (digit_t)c & mask;
+          c >>= exp;
+        }
+
+        c += a[n];
+        a[n] = (digit_t)c & mask;
+        a[n + 1] = (digit_t)(c >> exp);
+
+        // a + u*m is divisible by base
+        digit_t u = (a[0] * minv) & mask;
+
+        c = (a[0] + (digit2_t)u * m->digit[0]) >> exp;
+
+        for (size_t j = 1; j < n; j++) {
+          c += a[j] + (digit2_t)u * m->digit[j];
+          a[j - 1] = (digit_t)c & mask;
+          c >>= exp;
+        }
+
+        c += a[n];
+        a[n - 1] = (digit_t)c & mask;
+        a[n] = a[n + 1] + (digit_t)(c >> exp);
+      }
+
+      // the result is smaller than 2m
+      if (a[n] || digits_compare(a, n, m->digit, n) >= 0) {
+        digits_sub_from(a, n + 1, m->digit, n);
+      }
+
+      z->resize(n);
+
+      std::copy(a, a + n, z->digit);
+
+      z->trim();
+    }
+  };
+
+  // z = a^e mod m with 0 <= z < m, for e >= 0 and m > 0. Left to right
+  // sliding window exponentiation, Handbook of Applied Cryptography -
+  // Algorithm 14.85, the window sizes are taken from OpenSSL.
+  static void pow_mod(bint_t *a, bint_t *e, bint_t *m, bint_t *z) {
+    if (m->size == 0) {
+      raise(error(ErrorCode::DIVISION_BY_ZERO, 0));
+    }
+
+    if (m->sign < 0 || (e->size && e->sign < 0)) {
+      raise(error(ErrorCode::ARG_IS_INVALID, 0));
+    }
+
+    if (m->size == 1 && m->digit[0] == 1) {
+      return z->resize(0);
+    }
+
+    mod_ring R(m);
+
+    size_t bits = bit_length(e);
+
+    size_t k = bits > 671  ? 6
+               : bits > 239 ? 5
+               : bits > 79  ? 4
+               : bits > 23  ? 3
+                            : 1;
+
+    // table[i] = a^(2i + 1)
+    bint_t table[32], g;
+
+    R.to(a, &table[0]);
+
+    if (k > 1) {
+      R.mul(&table[0], &table[0], &g);
+
+      for (size_t i = 1; i < ((size_t)1 << (k - 1)); i++) {
+        R.mul(&table[i - 1], &g, &table[i]);
+      }
+    }
+
+    // a^0 = 1
+    g.resize(1);
+    g.digit[0] = 1;
+    g.sign = 1;
+
+    R.to(&g, z);
+
+    bool one = true;
+
+    for (size_t i = bits; i > 0;) {
+      if (!bits_at(e, i - 1, 1)) {
+        if (!one) {
+          R.mul(z, z, z);
+        }
+
+        i--;
+
+        continue;
+      }
+
+      // the longest window [j, i) of at most k bits ending on a one
+      size_t j = i > k ? i - k : 0;
+
+      while (!bits_at(e, j, 1)) {
+        j++;
+      }
+
+      digit_t w = bits_at(e, j, i - j);
+
+      if (one) {
+        z->set(&table[w >> 1]);
+      } else {
+        for (size_t s = j; s < i; s++) {
+          R.mul(z, z, z);
+        }
+
+        R.mul(z, &table[w >> 1], z);
+      }
+
+      one = false;
+
+      i = j;
+    }
+
+    R.from(z);
+  }
+
+  // returns the product of v[0...n), the numbers are packed on
+  // unsigned long longs while they fit and the packed values are
+  // multiplied with binary splitting.
+  static bint_t *product(const unsigned long long *v, size_t n) {
+    std::vector<unsigned long long> w;
+
+    unsigned long long t = 1;
+
+    for (size_t i = 0; i < n; i++) {
+      if (v[i] && t > ULLONG_MAX / v[i]) {
+        w.push_back(t);
+        t = 1;
+      }
+
+      t *= v[i];
+    }
+
+    w.push_back(t);
+
+    return product_tree(w.data(), w.size());
+  }
+
+  static bint_t *product_tree(const unsigned long long *v, size_t n) {
+    if (n == 1) {
+      return from(v[0]);
+    }
+
+    bint_t *a = product_tree(v, n / 2);
+    bint_t *b = product_tree(v + n / 2, n - n / 2);
+
+    bint_t *z = new bint_t();
+
+    mul(a, b, z);
+
+    delete a;
+    delete b;
+
+    return z;
+  }
+
+  // returns the product of p[i]^e[i] for 0 <= i < n. The result is
+  // computed from the most significant bit of the exponents to the
+  // least, squaring the partial result and multiplying it by the
+  // product of the bases whose exponents have the current bit set.
+  static bint_t *prime_powers(const unsigned long long *p,
+                              const unsigned long long *e, size_t n) {
+    unsigned long long m = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      m |= e[i];
+    }
+
+    bint_t *z = from(1);
+
+    if (m == 0) {
+      return z;
+    }
+
+    std::vector<unsigned long long> f;
+
+    int b = 0;
+
+    while (m >> (b + 1)) {
+      b++;
+    }
+
+    for (; b >= 0; b--) {
+      bint_t *t = new bint_t();
+
+      mul(z, z, t);
+
+      f.clear();
+
+      for (size_t i = 0; i < n; i++) {
+        if ((e[i] >> b) & 1) {
+          f.push_back(p[i]);
+        }
+      }
+
+      if (f.size()) {
+        bint_t *g = product(f.data(), f.size());
+
+        mul(t, g, z);
+
+        delete g;
+        delete t;
+      } else {
+        delete z;
+        z = t;
+      }
+    }
+
+    return z;
+  }
+
+  // returns the product lo*(lo + 1)*...*(hi - 1)
+  static bint_t *range_product(unsigned long long lo, unsigned long long hi) {
+    if (hi - lo <= 16) {
+      std::vector<unsigned long long> v;
+
+      for (unsigned long long i = lo; i < hi; i++) {
+        v.push_back(i);
+      }
+
+      return v.size() ? product(v.data(), v.size()) : from(1);
+    }
+
+    unsigned long long mid = lo + (hi - lo) / 2;
+
+    bint_t *a = range_product(lo, mid);
+    bint_t *b = range_product(mid, hi);
+
+    bint_t *z = new bint_t();
+
+    mul(a, b, z);
+
+    delete a;
+    delete b;
+
+    return z;
+  }
+
+  // returns a! computed with binary splitting
+  static bint_t *fact(bint_t *a) {
+    if (a->sign < 0 && a->size) {
+      raise(error(ErrorCode::ARG_IS_INVALID, 0));
+    }
+
+    unsigned long long n = 0;
+
+    for (size_t i = a->size; i-- > 0;) {
+      if (n >> (64 - exp)) {
+        raise(error(ErrorCode::INT_BIGGER_THAN_MAX_ULL, 0));
+      }
+
+      n = (n << exp) | a->digit[i];
+    }
+
+    return range_product(2, n + 1);
+  }
+
+  // M = N*M for the 2x2 matrices N and M
+  static void gcd_matrix_mul(bint_t **N, bint_t **M) {
+    bint_t *R[4];
+
+    bint_t *t = new bint_t();
+
+    for (size_t i = 0; i < 2; i++) {
+      for (size_t j = 0; j < 2; j++) {
+        R[2 * i + j] = new bint_t();
+
+        mul(N[2 * i], M[j], R[2 * i + j]);
+        mul(N[2 * i + 1], M[2 + j], t);
+
+        ADD(R[2 * i + j], t, R[2 * i + j]);
+      }
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+      delete M[i];
+      M[i] = R[i];
+    }
+
+    delete t;
+  }
+
+  // Euclidean step on a >= b > 0, (a, b) = (b, a mod b). If M
+  // is given it is updated to [0, 1; 1, -q]*M.
+  static void gcd_euclid_step(bint_t *&a, bint_t *&b, bint_t **M) {
+    bint_t *q = new bint_t();
+    bint_t *r = new bint_t();
+
+    div(a, b, q, r);
+
+    delete a;
+
+    a = b;
+    b = r;
+
+    if (M) {
+      bint_t *t = new bint_t();
+
+      for (size_t j = 0; j < 2; j++) {
+        mul(q, M[2 + j], t);
+        SUB(M[j], t, M[j]);
+        std::swap(M[j], M[2 + j]);
+      }
+
+      delete t;
+    }
+
+    delete q;
+  }
+
+  // Lehmer step on a >= b > 0, see [3] Algorithm L. The quotients are
+  // computed from the leading 2*exp bits of a and b while they are
+  // guaranteed to be the ones of the full numbers, and then applied to
+  // a and b at once as (a, b) = (A*a + B*b, C*a + D*b). If M is given
+  // it is updated to [A, B; C, D]*M. Returns false if no quotient
+  // could be computed.
+  static bool gcd_lehmer_step(bint_t *&a, bint_t *&b, bint_t **M) {
+    size_t n = a->size;
+
+    // the products of the cofactors by the digits need to fit on
+    // a sdigit2_t
+    if (n < 3 || 2 * exp + 2 >= sizeof(sdigit2_t) * CHAR_BIT) {
+      return false;
+    }
+
+    int l = high_bit(a->digit[n - 1]);
+
+    sdigit2_t x = ((digit2_t)a->digit[n - 1] << (2 * exp - l)) |
+                  ((digit2_t)a->digit[n - 2] << (exp - l)) |
+                  (a->digit[n - 3] >> l);
+
+    sdigit2_t y = 0;
+
+    if (b->size >= n) {
+      y |= (digit2_t)b->digit[n - 1] << (2 * exp - l);
+    }
+
+    if (b->size >= n - 1) {
+      y |= (digit2_t)b->digit[n - 2] << (exp - l);
+    }
+
+    if (b->size >= n - 2) {
+      y |= b->digit[n - 3] >> l;
+    }
+
+    sdigit2_t A = 1, B = 0, C = 0, D = 1;
+
+    while (y + C > 0 && y + D > 0) {
+      sdigit2_t q = (x + A) / (y + C);
+
+      if (q >= base || q != (x + B) / (y + D)) {
+        break;
+      }
+
+      sdigit2_t T = A - q * C;
+      sdigit2_t U = B - q * D;
+
+      // keep the cofactors smaller than the base
+      if (T <= -(sdigit2_t)base || T >= (sdigit2_t)base ||
+          U <= -(sdigit2_t)base || U >= (sdigit2_t)base) {
+        break;
+      }
+
+      A = C;
+      C = T;
+      B = D;
+      D = U;
+
+      T = x - q * y;
+      x = y;
+      y = T;
+    }
+
+    if (B == 0) {
+      return false;
+    }
+
+    bint_t *u = new bint_t();
+    bint_t *v = new bint_t();
+
+    u->resize(n);
+    v->resize(n);
+
+    sdigit2_t cu = 0;
+    sdigit2_t cv = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      sdigit2_t ai = a->digit[i];
+      sdigit2_t bi = i < b->size ? b->digit[i] : 0;
+
+      cu += A * ai + B * bi;
+      cv += C * ai + D * bi;
+
+      u->digit[i] = (digit_t)(cu & mask);
+      v->digit[i] = (digit_t)(cv & mask);
+
+      cu = arith_rshift(cu, exp);
+      cv = arith_rshift(cv, exp);
+    }
+
+    assert(cu == 0 && cv == 0);
+
+    u->trim();
+    v->trim();
+
+    delete a;
+    delete b;
+
+    a = u;
+    b = v;
+
+    if (M) {
+      for (size_t j = 0; j < 2; j++) {
+        bint_t *r0 = gcd_combine(A, M[j], B, M[2 + j]);
+        bint_t *r1 = gcd_combine(C, M[j], D, M[2 + j]);
+
+        delete M[j];
+        delete M[2 + j];
+
+        M[j] = r0;
+        M[2 + j] = r1;
+      }
+    }
+
+    return true;
+  }
+
+  // returns A*x + B*y for cofactors A and B smaller than the base
+  static bint_t *gcd_combine(sdigit2_t A, bint_t *x, sdigit2_t B, bint_t *y) {
+    size_t n = std::max(x->size, y->size) + 1;
+
+    bint_t *z = new bint_t();
+
+    z->resize(n);
+
+    A = A * x->sign;
+    B = B * y->sign;
+
+    sdigit2_t c = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      if (i < x->size) {
+        c += A * (sdigit2_t)x->digit[i];
+      }
+
+      if (i < y->size) {
+        c += B * (sdigit2_t)y->digit[i];
+      }
+
+      z->digit[i] = (digit_t)(c & mask);
+
+      c = arith_rshift(c, exp);
+    }
+
+    // the result is negative and z holds its complement
+    if (c < 0) {
+      digit_t borrow = 0;
+
+      for (size_t i = 0; i < n; i++) {
+        digit_t d = z->digit[i] + borrow;
+
+        z->digit[i] = (base - d) & mask;
+
+        borrow = d != 0;
+      }
+
+      z->sign = -1;
+    }
+
+    z->trim();
 
-      // i <- a*a
-      mul(a, a, i);
+    return z;
+  }
 
-      // t1 <- N - a*a
-      sub(N, i, j);
+  // reduces a >= b >= 0 until b has at most s digits
+  static void gcd_lehmer(bint_t *&a, bint_t *&b, size_t s, bint_t **M) {
+    while (b->size > s) {
+      if (!gcd_lehmer_step(a, b, M)) {
+        gcd_euclid_step(a, b, M);
+      }
+    }
+  }
 
-      // r0 <- (N - a*a) << 2
-      t = lshift(j, 2);
+  // Reduces a >= b >= 0 using the transformation N that reduces the
+  // digits of a and b above p. The signs and the order of a and b are
+  // fixed so that a >= b >= 0 and N is accumulated on M.
+  static void hgcd_top(bint_t *&a, bint_t *&b, size_t p, bint_t **M) {
+    if (b->size <= p + 1) {
+      return;
+    }
 
-      // r0 <- ((N - a*a) << 2) + n
-      add_small_constant(t, n);
+    bint_t *x = digits_slice(a, p, a->size);
+    bint_t *y = digits_slice(b, p, b->size);
 
-      // t2 <- (a << 2)
-      k = lshift(a, 2);
+    bint_t *N[4] = {from(1), new bint_t(), new bint_t(), from(1)};
 
-      // r1 <- (a << 2) + 1
+    hgcd(x, y, N);
 
-      add_small_constant(k, 1);
+    bint_t *u = new bint_t();
+    bint_t *v = new bint_t();
+    bint_t *t = new bint_t();
 
-      // ((N - a*a) << 2) + n >= (a<<2) + 1
-      if (compare(t, k) >= 0)
-        b = 1;
+    mul(N[0], a, u);
+    mul(N[1], b, t);
 
-      delete t;
-      delete k;
+    ADD(u, t, u);
 
-      t = lshift(a, 1);
-      k = lshift(N, 2);
+    mul(N[2], a, v);
+    mul(N[3], b, t);
 
-      pipe_small_constant(t, b);
-      pipe_small_constant(k, n);
+    ADD(v, t, v);
 
-      a->set(t);
-      N->set(k);
+    if (u->sign < 0) {
+      u->sign = 1;
+      N[0]->sign = -N[0]->sign;
+      N[1]->sign = -N[1]->sign;
+    }
 
-      delete t;
-      delete k;
+    if (v->sign < 0) {
+      v->sign = 1;
+      N[2]->sign = -N[2]->sign;
+      N[3]->sign = -N[3]->sign;
     }
 
-    if (rem) {
-      // rem is N - a*a
-      mul(a, a, i);
-      sub(N, i, rem);
+    if (compare(u, v) < 0) {
+      std::swap(u, v);
+      std::swap(N[0], N[2]);
+      std::swap(N[1], N[3]);
     }
 
-    delete N;
-    delete i;
-    delete j;
-  }
+    delete a;
+    delete b;
 
-  static double pow(bint_t *a, double e) {
-    double v = 0;
+    a = u;
+    b = v;
 
-		if(to_double(a, &v) == 1) {
-			raise(error(ErrorCode::DOUBLE_OVERFLOW, 0));
-		}
+    if (M) {
+      gcd_matrix_mul(N, M);
+    }
 
-    return std::pow(v, e);
-  }
+    for (size_t i = 0; i < 4; i++) {
+      delete N[i];
+    }
 
-  static bint_t *pow(bint_t *a, bint_t *e) {
-    if (e->size == 0)
-      return from(1);
-    if (e->size == 1 && e->digit[0] == 1)
-      return a->copy();
+    delete x;
+    delete y;
+    delete t;
+  }
 
-    bint_t *z = a->copy();
+  // Half gcd, reduces a >= b >= 0 with n digits until b has at most
+  // n/2 + 1 digits. The leading half of the digits is reduced
+  // recursively, in two rounds, and the transformations are applied
+  // to the full numbers, see [4] Section 1.6.3.
+  static void hgcd(bint_t *&a, bint_t *&b, bint_t **M) {
+    size_t n = a->size;
+    size_t m = n / 2 + 1;
 
-    long long i = e->size;
+    if (n >= HGCD_THRESHOLD) {
+      hgcd_top(a, b, m, M);
 
-    digit_t bi = i ? e->digit[i - 1] : 0;
+      if (b->size > m && a->size < 2 * m) {
+        hgcd_top(a, b, 2 * m - a->size, M);
+      }
+    }
 
-    if (i <= 1 && bi <= 3) {
-      if (bi >= 2) {
-        MUL(a, a, z);
+    gcd_lehmer(a, b, m, M);
+  }
 
-        if (bi == 3) {
-          MUL(z, a, z);
-        }
+  // reduces a >= b >= 0 until b has at most s digits
+  static void gcd_reduce(bint_t *&a, bint_t *&b, size_t s, bint_t **M) {
+    while (b->size >= HGCD_THRESHOLD && b->size > s) {
+      if (a->size - b->size > b->size / 2) {
+        gcd_euclid_step(a, b, M);
+      } else {
+        hgcd(a, b, M);
       }
-    } else if (i <= 8) {
-      // Left-to-right binary exponentiation
-      digit_t bit;
+    }
 
-      for (bit = 2;; bit <<= 1) {
-        if (bit > bi) {
-          bit >>= 1;
-          break;
-        }
-      }
+    gcd_lehmer(a, b, s, M);
+  }
 
-      for (--i, bit >>= 1;;) {
-        for (; bit != 0; bit >>= 1) {
-          MUL(z, z, z);
+  // returns the non negative gcd of a and b
+  static bint_t *gcd(bint_t *a, bint_t *b) {
+    bint_t *x = a->copy();
+    bint_t *y = b->copy();
 
-          if (bi & bit) {
-            MUL(z, a, z);
-          }
-        }
+    x->sign = 1;
+    y->sign = 1;
 
-        if (--i < 0) {
-          break;
-        }
+    if (compare(x, y) < 0) {
+      std::swap(x, y);
+    }
 
-        bi = e->digit[i];
-        bit = 1 << (exp - 1);
-      }
-    } else {
-      // Left to right 5-ary exponentiation, Handbook of Applied Cryptography -
-      // Algorithm 14.82
-      delete z;
+    gcd_reduce(x, y, 2, nullptr);
 
-      z = from(1);
+    if (y->size && x->size > 2) {
+      gcd_euclid_step(x, y, nullptr);
+    }
 
-      bint_t *table[32] = {nullptr};
-      table[0] = z;
+    if (y->size) {
+      // both numbers fit on a digit2_t
+      digit2_t u = x->digit[0];
+      digit2_t v = y->digit[0];
 
-      for (size_t i = 1; i < 32; ++i) {
-        MUL(table[i - 1], a, table[i]);
+      if (x->size > 1) {
+        u |= (digit2_t)x->digit[1] << exp;
       }
 
-      for (size_t i = a->size; i >= 0; --i) {
-        const digit_t bi = a->digit[i];
-
-        for (size_t j = exp - 5; j >= 0; j -= 5) {
-          // 0x1f = 31, take the cached table index
-          const int index = (bi >> j) & 0x1f;
+      if (y->size > 1) {
+        v |= (digit2_t)y->digit[1] << exp;
+      }
 
-          for (size_t k = 0; k < 5; ++k) {
-            MUL(z, z, z);
+      while (v) {
+        digit2_t r = u % v;
 
-            if (index) {
-              MUL(z, table[index], z);
-            }
-          }
-        }
+        u = v;
+        v = r;
       }
-    }
 
-    return z;
-  }
+      delete x;
 
-  static bint_t *fact(bint_t *a) {
-    assert(a->sign = 1);
+      x = from(u);
+    }
 
-    bint_t *z = from(1);
+    delete y;
 
-    bint_t *b = a->copy();
-    bint_t *o = z->copy();
+    return x;
+  }
 
-    while (b->size >= 1 && b->digit[0] != 1) {
-      MUL(z, b, z)
-      SUB(b, o, b)
-    }
+  // returns the non negative g = gcd(a, b) and saves on s and t
+  // the cofactors such that g = s*a + t*b
+  static bint_t *xgcd(bint_t *a, bint_t *b, bint_t *s, bint_t *t) {
+    bint_t *x = a->copy();
+    bint_t *y = b->copy();
 
-    delete b;
-    delete o;
+    x->sign = 1;
+    y->sign = 1;
 
-    return z;
-  }
+    bool swapped = compare(x, y) < 0;
 
-  static bint_t *gcd(bint_t *a, bint_t *b) {
-    if (b->size == 0)
-      return a->copy();
+    if (swapped) {
+      std::swap(x, y);
+    }
 
-    bint_t *rem = new bint_t();
-    bint_t *quo = new bint_t();
+    bint_t *M[4] = {from(1), new bint_t(), new bint_t(), from(1)};
 
-    // printf("a = %s\n", a->to_string().c_str());
-    // printf("b = %s\n", b->to_string().c_str());
+    gcd_reduce(x, y, 0, M);
 
-    // long long ASD;
-    // long long ASK;
+    // x = M[0]*|a| + M[1]*|b| with a and b swapped if needed
+    s->swap(M[swapped ? 1 : 0]);
+    t->swap(M[swapped ? 0 : 1]);
 
-    // bint_t::to_long(a, &ASD);
-    // bint_t::to_long(b, &ASK);
+    if (a->sign < 0 && s->size) {
+      s->sign = -s->sign;
+    }
 
-    // printf("%lli\n", ASD % ASK);
-    div(a, b, quo, rem);
-    // printf("quo = %s\n", quo->to_string().c_str());
-    // printf("rem = %s\n", rem->to_string().c_str());
+    if (b->sign < 0 && t->size) {
+      t->sign = -t->sign;
+    }
 
-    // printf("quo ---> %s\n", quo->to_string().c_str());
-    // printf("rem ---> %s\n", rem->to_string().c_str());
-    bint_t *g = gcd(b, rem);
+    for (size_t i = 0; i < 4; i++) {
+      delete M[i];
+    }
 
-    delete rem;
-    delete quo;
+    delete y;
 
-    return g;
+    return x;
   }
 
   static bint_t *lcm(bint_t *a, bint_t *b) {
@@ -1482,64 +3199,278 @@ public:
   //   std::cout << digit[0] << ")" << (1 << exp) << std::endl;
   // }
 
-	std::string to_string() {
-    if (!this->size)
-      return "0";
+  // number of decimal digits k such that 10^k fits on a single digit
+  static size_t decimal_chunk() {
+    size_t k = 0;
 
-    size_t shift = std::floor(std::log10(std::numeric_limits<digit_t>::max()));
+    for (digit2_t p = 10; p <= base; p *= 10) {
+      k++;
+    }
+
+    return std::max(k, (size_t)1);
+  }
 
-		size_t dbase = std::pow(10, shift);
+  // returns 10^(k*2^i), where k is decimal_chunk(), the powers are
+  // computed once and cached
+  static bint_t *decimal_power(size_t i) {
+    static std::vector<bint_t *> powers;
 
-		std::vector<digit_t> pout;
+    while (powers.size() <= i) {
+      if (powers.empty()) {
+        digit2_t p = 1;
 
-    long long i;
+        for (size_t j = 0; j < decimal_chunk(); j++) {
+          p *= 10;
+        }
+
+        powers.push_back(from(p));
+      } else {
+        bint_t *p = new bint_t();
+
+        mul(powers.back(), powers.back(), p);
+
+        powers.push_back(p);
+      }
+    }
+
+    return powers[i];
+  }
+
+  // upper bound on the number of decimal digits of v
+  static size_t decimal_size(bint_t *v) {
+    return (size_t)((double)v->size * exp * 0.30103) + 1;
+  }
 
-		long long s = 0;
+  // Writes the decimal digits of |v| on out, left padded with zeros
+  // up to pad characters, and returns the end of the written digits.
+  // The number is converted to base 10^k digit by digit, see [2].
+  static char *to_chars_basecase(bint_t *v, char *out, size_t pad) {
+    size_t shift = std::floor(std::log10(std::numeric_limits<digit_t>::max()));
 
-    pout.push_back(0);
+    digit_t dbase = std::pow(10, shift);
 
-    for (i = this->size; --i >= 0;) {
+    std::vector<digit_t> pout;
 
-      digit_t hi = digit[i];
+    for (size_t i = v->size; i-- > 0;) {
+      digit_t hi = v->digit[i];
 
-      for (size_t j = 0; j < (size_t)s; j++) {
+      for (size_t j = 0; j < pout.size(); j++) {
         digit2_t z = (digit2_t)pout[j] << exp | hi;
         hi = (digit_t)(z / dbase);
         pout[j] = (digit_t)(z - (digit2_t)hi * dbase);
       }
 
       while (hi) {
-        pout[s++] = hi % dbase;
-        pout.push_back(0);
+        pout.push_back(hi % dbase);
         hi /= dbase;
       }
     }
 
-		std::string str = "";
+    size_t len = 0;
 
-    if (s == 0) pout[s++] = 0;
+    if (pout.size()) {
+      len = (pout.size() - 1) * shift;
 
-    // std::stringstream str;
+      for (digit_t n = pout.back(); n; n /= 10) {
+        len++;
+      }
+    }
 
-    for (i = 0; i < s; i++) {
-      digit_t n = pout[i];
+    if (pad == 0 && len == 0) {
+      pad = 1;
+    }
 
-      for (size_t j = 0; j < shift; j++) {
-        if (i == s - 1 && n == 0)
-          break;
+    while (pad > len) {
+      *out++ = '0';
+      pad--;
+    }
 
-				str += std::to_string(n % 10);
+    char *end = out + len;
+
+    for (size_t i = 0; i < pout.size(); i++) {
+      digit_t n = pout[i];
 
+      for (size_t j = 0; j < shift && out < end; j++) {
+        *--end = '0' + n % 10;
         n = n / 10;
       }
     }
 
-    if (this->sign < 0)
-      str += "-";
+    return out + len;
+  }
+
+  // Divide and conquer conversion of |v| to base 10, v = q*10^h + r
+  // is split using the cached powers of 10, see [4] Section 1.7.
+  static char *to_chars_rec(bint_t *v, char *out, size_t pad) {
+    if (v->size < TO_STRING_THRESHOLD) {
+      return to_chars_basecase(v, out, pad);
+    }
+
+    size_t i = 0;
+
+    while (2 * decimal_power(i + 1)->size - 1 <= v->size) {
+      i++;
+    }
+
+    size_t h = decimal_chunk() << i;
+
+    bint_t *q = new bint_t();
+    bint_t *r = new bint_t();
+
+    div(v, decimal_power(i), q, r);
+
+    out = to_chars_rec(q, out, pad > h ? pad - h : 0);
+    out = to_chars_rec(r, out, h);
+
+    delete q;
+    delete r;
+
+    return out;
+  }
+
+  // Writes the decimal representation of this number followed by a
+  // null character on buf, if it fits on the n characters of buf.
+  // Returns the length of the representation, like snprintf.
+  size_t to_chars(char *buf, size_t n) {
+    // sign, digits and the null character
+    if (n < decimal_size(this) + 2) {
+      std::string s = to_string();
+
+      if (s.size() < n) {
+        memcpy(buf, s.c_str(), s.size() + 1);
+      }
+
+      return s.size();
+    }
+
+    char *out = buf;
+
+    if (this->sign < 0 && this->size) {
+      *out++ = '-';
+    }
+
+    short s = this->sign;
+
+    this->sign = 1;
+
+    out = to_chars_rec(this, out, 0);
+
+    this->sign = s;
+
+    *out = '\0';
+
+    return out - buf;
+  }
+
+  std::string to_string() {
+    std::string s(decimal_size(this) + 2, '\0');
+
+    s.resize(to_chars(&s[0], s.size()));
+
+    return s;
+  }
+
+  // returns the number with decimal digits s[0...n)
+  static bint_t *from_chars_basecase(const char *s, size_t n) {
+    size_t k = decimal_chunk();
+
+    bint_t *z = new bint_t();
+
+    // log2(10) < 10/3
+    z->resize((n * 10 / 3) / exp + 2);
+
+    size_t l = 0;
+
+    for (size_t i = 0; i < n;) {
+      size_t c = i == 0 && n % k ? n % k : k;
+
+      digit2_t w = 1;
+      digit2_t v = 0;
+
+      for (size_t j = 0; j < c; j++, i++) {
+        if (s[i] < '0' || s[i] > '9') {
+          delete z;
+          raise(error(ErrorCode::ARG_IS_INVALID, 0));
+        }
+
+        v = v * 10 + (s[i] - '0');
+        w = w * 10;
+      }
+
+      // z = z*10^c + v
+      digit2_t carry = v;
+
+      for (size_t j = 0; j < l; j++) {
+        carry += (digit2_t)z->digit[j] * w;
+        z->digit[j] = (digit_t)(carry & mask);
+        carry >>= exp;
+      }
+
+      while (carry) {
+        z->digit[l++] = (digit_t)(carry & mask);
+        carry >>= exp;
+      }
+    }
+
+    z->trim();
+
+    return z;
+  }
+
+  // Divide and conquer conversion of the decimal digits s[0...n),
+  // the number is split as hi*10^h + lo using the cached powers of 10.
+  static bint_t *from_chars_rec(const char *s, size_t n) {
+    if (n <= FROM_STRING_THRESHOLD) {
+      return from_chars_basecase(s, n);
+    }
+
+    size_t i = 0;
+
+    while ((decimal_chunk() << (i + 1)) < n) {
+      i++;
+    }
+
+    size_t h = decimal_chunk() << i;
+
+    bint_t *hi = from_chars_rec(s, n - h);
+    bint_t *lo = from_chars_rec(s + n - h, h);
+
+    bint_t *t = new bint_t();
+    bint_t *z = new bint_t();
+
+    mul(hi, decimal_power(i), t);
+    add(t, lo, z);
+
+    delete hi;
+    delete lo;
+    delete t;
+
+    return z;
+  }
+
+  // returns the number represented by the n characters of s, in
+  // base 10 and optionally preceded by a sign
+  static bint_t *from_string(const char *s, size_t n) {
+    short sign = 1;
+
+    if (n && (s[0] == '-' || s[0] == '+')) {
+      sign = s[0] == '-' ? -1 : 1;
+
+      s++;
+      n--;
+    }
+
+    if (n == 0) {
+      raise(error(ErrorCode::ARG_IS_INVALID, 0));
+    }
 
-		std::reverse(str.begin(), str.end());
+    bint_t *z = from_chars_rec(s, n);
+
+    if (z->size) {
+      z->sign = sign;
+    }
 
-    return str;
+    return z;
   }
 
 	static void abs_add_array(digit_t* arr_a, size_t size_a, digit_t* arr_b, size_t size_b, bint_t* z) {
@@ -1560,6 +3491,7 @@ public:
     }
 
     z->resize(size_a + 1);
+    z->sign = 1;
 
     for (; i < size_b; ++i) {
       carry += arr_a[i] + arr_b[i];
@@ -1652,43 +3584,25 @@ public:
 		short a_sign = i < 0 ? -1 : 1;
 		short b_sign = j < 0 ? -1 : 1;
 
-		i = i < 0 ? -i : i;
-	  j = j < 0 ? -j : j;
 
-		digit_t a[3];
-		digit_t b[3];
+		digit_t a[long_digits];
+		digit_t b[long_digits];
 
 		size_t a_size = 0;
 		size_t b_size = 0;
 
-		a[0] = modPow2(i, exp);
-		i = quoPow2(i, exp);
-		a[1] = modPow2(i, exp);
-		i = quoPow2(i, exp);
-		a[2] = modPow2(i, exp);
+		a_size = digits_of(i, a);
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
-		if(a[2]) a_size = 3;
-		else if(a[1]) a_size = 2;
-		else if(a[0]) a_size = 1;
-		else a_size = 0;
 
 
     if (a_size <= 1 && b_size <= 1) {
       digit_t x = a_size > 0 ? a[0] : 0;
 			digit_t y = b_size > 0 ? b[0] : 0;
 
-      int64_t c = (int64_t)x * a_sign + (int64_t)y * b_sign;
+      sdigit2_t c = (sdigit2_t)x * a_sign + (sdigit2_t)y * b_sign;
 
       short s = 1;
 
@@ -1723,8 +3637,9 @@ public:
 
     if (a_sign < 0) {
       if (b_sign < 0) {
-        z->sign = -1 * z->sign;
-				return abs_add_array(a, a_size, b, b_size, z);
+				abs_add_array(a, a_size, b, b_size, z);
+        z->sign = -1;
+        return;
       }
 
 			return abs_sub_array(b, b_size, a, a_size, z);
@@ -1744,28 +3659,19 @@ public:
 		short a_sign = h->sign;
 		short b_sign = j < 0 ? -1 : 1;
 
-	  j = j < 0 ? -j : j;
 
-		digit_t b[3];
+		digit_t b[long_digits];
 
 		size_t b_size = 0;
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
     if (h->size <= 1 && b_size <= 1) {
 			digit_t x = h->size > 0 ? h->digit[0] : 0;
 			digit_t y = b_size > 0 ? b[0] : 0;
 
-      int64_t c = (int64_t)x * a_sign + (int64_t)y * b_sign;
+      sdigit2_t c = (sdigit2_t)x * a_sign + (sdigit2_t)y * b_sign;
 
       short s = 1;
 
@@ -1801,8 +3707,9 @@ public:
 
     if (a_sign < 0) {
       if (b_sign < 0) {
-        z->sign = -1 * z->sign;
-				return abs_add_array(h->digit, h->size, b, b_size, z);
+				abs_add_array(h->digit, h->size, b, b_size, z);
+        z->sign = -1;
+        return;
       }
 
 			return abs_sub_array(b, b_size, h->digit, h->size, z);
@@ -1824,36 +3731,18 @@ public:
 		short a_sign = i < 0 ? -1 : 1;
 		short b_sign = j < 0 ? -1 : 1;
 
-		i = i < 0 ? -i : i;
-	  j = j < 0 ? -j : j;
 
-		digit_t a[3];
-		digit_t b[3];
+		digit_t a[long_digits];
+		digit_t b[long_digits];
 
 		size_t a_size = 0;
 		size_t b_size = 0;
 
-		a[0] = modPow2(i, exp);
-		i = quoPow2(i, exp);
-		a[1] = modPow2(i, exp);
-		i = quoPow2(i, exp);
-		a[2] = modPow2(i, exp);
+		a_size = digits_of(i, a);
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
-		if(a[2]) a_size = 3;
-		else if(a[1]) a_size = 2;
-		else if(a[0]) a_size = 1;
-		else a_size = 0;
 
 
 		if (a_sign < 0) {
@@ -1882,22 +3771,13 @@ public:
 		short a_sign = h->sign;
 		short b_sign = j < 0 ? -1 : 1;
 
-	  j = j < 0 ? -j : j;
 
-		digit_t b[3];
+		digit_t b[long_digits];
 
 		size_t b_size = 0;
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
 		if (a_sign < 0) {
 			if (b_sign < 0) {
@@ -1933,28 +3813,7 @@ public:
 
     z->resize(size_a + size_b);
 
-    for (size_t i = 0; i < size_a; i++) {
-      digit2_t carry = 0;
-      digit2_t xi = a[i];
-
-      digit_t *pz = z->digit + i;
-      digit_t *py = b;
-
-      digit_t *pe = b + size_b;
-
-      while (py < pe) {
-        carry += *pz + *py++ * xi;
-        *pz++ = (digit_t)(carry & mask);
-        carry >>= exp;
-        assert(carry <= (mask << 1));
-      }
-
-      if (carry) {
-        *pz += (digit_t)(carry & mask);
-      }
-
-      assert((carry >> exp) == 0);
-    }
+    digits_mul(a, size_a, b, size_b, z->digit);
 
     return z->trim();
   }
@@ -1963,36 +3822,18 @@ public:
 		short is = i < 0 ? -1 : +1;
 		short js = j < 0 ? -1 : +1;
 
-		i = i < 0 ? -i : +i;
-		j = j < 0 ? -j : +j;
 
-		digit_t a[3];
-		digit_t b[3];
+		digit_t a[long_digits];
+		digit_t b[long_digits];
 
 		size_t a_size = 0;
 		size_t b_size = 0;
 
-		a[0] = modPow2(i, exp);
-		i = quoPow2(i, exp);
-		a[1] = modPow2(i, exp);
-		i = quoPow2(i, exp);
-		a[2] = modPow2(i, exp);
+		a_size = digits_of(i, a);
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
-		if(a[2]) a_size = 3;
-		else if(a[1]) a_size = 2;
-		else if(a[0]) a_size = 1;
-		else a_size = 0;
 
 		z->sign = is * js;
 
@@ -2004,22 +3845,13 @@ public:
 	static void mul(bint_t* h, long long j, bint_t* z) {
 		short js = j < 0 ? -1 : +1;
 
-		j = j < 0 ? -j : +j;
 
-		digit_t b[3];
+		digit_t b[long_digits];
 
 		size_t b_size = 0;
 
-		b[0] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[1] = modPow2(j, exp);
-		j = quoPow2(j, exp);
-		b[2] = modPow2(j, exp);
+		b_size = digits_of(j, b);
 
-		if(b[2]) b_size = 3;
-		else if(b[1]) b_size = 2;
-		else if(b[0]) b_size = 1;
-		else b_size = 0;
 
 		z->sign = h->sign * js;
 
@@ -1,12 +1,16 @@
 #include "Integer.hpp"
 #include "gauss/Algebra/Int.hpp"
+#include "gauss/Primes/Primes.hpp"
 
 #include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
+using bint_t = Int::bint_t;
+
 inline long long safe_mul(long long a, long long b, long long *c) {
   if (a == 0 || b == 0) {
     *c = 0;
@@ -61,7 +65,6 @@ inline long long safe_pow(long long a, long long b, long long *c) {
 
   while (b) {
     if (b % 2 == 1) {
-
       if (safe_mul(r, a, &t) == LONG_LONG_OVERFLOW) {
         return LONG_LONG_OVERFLOW;
       }
@@ -127,20 +130,17 @@ inline long long safe_lcm(long long a, long long b, long long *c) {
 }
 
 inline long long safe_fact(long long a, long long *c) {
-  if (a == 0 || a == 1) {
-    *c = 1;
-
-    return LONG_LONG_OK;
+  // 20! is the biggest factorial that fits on a long long
+  if (a > 20) {
+    return LONG_LONG_OVERFLOW;
   }
 
-  long long t;
+  *c = 1;
 
-  if (safe_fact(a - 1, &t) == LONG_LONG_OVERFLOW) {
-    return LONG_LONG_OVERFLOW;
+  for (long long i = 2; i <= a; i++) {
+    *c = *c * i;
   }
 
-  *c = a * t;
-
   return LONG_LONG_OK;
 }
 
@@ -174,19 +174,28 @@ Int::Int() {
 }
 
 Int Int::fromString(const char* a) {
-	unsigned digits = strlen(a);
+  size_t n = strlen(a);
 
-	Int x = 0;
+  // at most 18 decimal digits always fit on a long long
+  if (n <= 18 && n > (size_t)(a[0] == '-' || a[0] == '+')) {
+    long long x = 0;
 
-	Int e = 1;
+    for (size_t i = a[0] == '-' || a[0] == '+'; i < n; i++) {
+      if (a[i] < '0' || a[i] > '9') {
+        raise(error(ErrorCode::ARG_IS_INVALID, 0));
+      }
 
-	for(unsigned i = 0; i < digits; i++) {
-		x += (a[i] - '0') * e;
-		e *= 10;
-	}
+      x = x * 10 + (a[i] - '0');
+    }
 
-	return x;
+    return a[0] == '-' ? -x : x;
+  }
 
+  Int x = bint_t::from_string(a, n);
+
+  x.to_long_if_small();
+
+  return x;
 }
 
 Int::Int(const Int &a) {
@@ -218,7 +227,7 @@ Int::Int(long int v) {
     this->x = v;
   } else {
     this->flag = 1;
-    this->val = bint<30>::from<long int>(v);
+    this->val = bint_t::from<long int>(v);
   }
 }
 
@@ -228,7 +237,7 @@ Int::Int(long long v) {
     this->x = v;
   } else {
     this->flag = 1;
-    this->val = bint<30>::from<long long>(v);
+    this->val = bint_t::from<long long>(v);
   }
 }
 
@@ -238,7 +247,7 @@ Int::Int(unsigned long long v) {
     this->x = v;
   } else {
     this->flag = 1;
-    this->val = bint<30>::from<unsigned long long>(v);
+    this->val = bint_t::from<unsigned long long>(v);
   }
 }
 
@@ -248,7 +257,7 @@ Int::Int(unsigned long int v) {
     this->x = v;
   } else {
     this->flag = 1;
-    this->val = bint<30>::from<unsigned long long>(v);
+    this->val = bint_t::from<unsigned long long>(v);
   }
 }
 
@@ -258,7 +267,7 @@ Int::Int(unsigned int v) {
     this->x = v;
   } else {
     this->flag = 1;
-    this->val = bint<30>::from<unsigned int>(v);
+    this->val = bint_t::from<unsigned int>(v);
   }
 }
 
@@ -273,7 +282,7 @@ Int::Int(double b) {
     this->x = b;
   } else {
     this->flag = 1;
-    this->val = bint<30>::from(b);
+    this->val = bint_t::from(b);
   }
 }
 
@@ -282,7 +291,7 @@ Int::~Int() {
     delete this->val;
 }
 
-Int::Int(bint<30> *v) {
+Int::Int(bint_t *v) {
   this->flag = 1;
   this->val = v;
 }
@@ -295,6 +304,14 @@ std::string Int::to_string() {
   return this->val->to_string();
 }
 
+size_t Int::to_chars(char *buf, size_t n) {
+  if (!this->flag) {
+    return snprintf(buf, n, "%lli", x);
+  }
+
+  return this->val->to_chars(buf, n);
+}
+
 Int Int::operator+(const Int &other) const {
   switch ((this->flag << 1) | other.flag) {
   case 0: {
@@ -304,28 +321,28 @@ Int Int::operator+(const Int &other) const {
       return r;
     }
 
-    bint<30> *c = new bint<30>;
+    bint_t *c = new bint_t;
 
-    bint<30>::add(this->x, other.x, c);
+    bint_t::add(this->x, other.x, c);
 
     return c;
   }
 
   case 1: {
-    bint<30> *t = new bint<30>();
-    bint<30>::add(this->x, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::add(this->x, other.val, t);
     return t;
   }
 
   case 2: {
-    bint<30> *t = new bint<30>();
-		bint<30>::add(this->val, other.x, t);
+    bint_t *t = new bint_t();
+		bint_t::add(this->val, other.x, t);
     return t;
   }
 
   case 3: {
-    bint<30> *t = new bint<30>();
-		bint<30>::add(this->val, other.val, t);
+    bint_t *t = new bint_t();
+		bint_t::add(this->val, other.val, t);
 		return t;
   }
   }
@@ -343,28 +360,28 @@ Int Int::operator+(const Int &&other) const {
       return r;
     }
 
-    bint<30> *c = new bint<30>;
+    bint_t *c = new bint_t;
 
-    bint<30>::add(this->x, other.x, c);
+    bint_t::add(this->x, other.x, c);
 
     return c;
   }
 
   case 1: {
-    bint<30> *t = new bint<30>();
-    bint<30>::add(this->x, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::add(this->x, other.val, t);
     return t;
   }
 
   case 2: {
-    bint<30> *t = new bint<30>();
-    bint<30>::add(this->val, other.x, t);
+    bint_t *t = new bint_t();
+    bint_t::add(this->val, other.x, t);
     return t;
   }
 
   case 3: {
-    bint<30> *t = new bint<30>();
-    bint<30>::add(this->val, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::add(this->val, other.val, t);
     return t;
   }
   }
@@ -382,16 +399,16 @@ Int Int::operator+(const int z) const {
       return r;
     }
 
-    bint<30> *c = new bint<30>;
+    bint_t *c = new bint_t;
 
-    bint<30>::add(this->x, z, c);
+    bint_t::add(this->x, z, c);
 
     return c;
   }
 
   case 1: {
-    bint<30> *t = new bint<30>();
-    bint<30>::add(this->val, z, t);
+    bint_t *t = new bint_t();
+    bint_t::add(this->val, z, t);
     return t;
   }
   }
@@ -410,28 +427,28 @@ Int Int::operator-(const Int &other) const {
       return r;
     }
 
-    bint<30> *c = new bint<30>;
+    bint_t *c = new bint_t;
 
-    bint<30>::sub(this->x, other.x, c);
+    bint_t::sub(this->x, other.x, c);
 
     return c;
   }
 
   case 1: {
-    bint<30> *t = new bint<30>();
-    bint<30>::sub(this->x, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::sub(this->x, other.val, t);
     return t;
   }
 
   case 2: {
-    bint<30> *t = new bint<30>();
-    bint<30>::sub(this->val, other.x, t);
+    bint_t *t = new bint_t();
+    bint_t::sub(this->val, other.x, t);
     return t;
   }
 
   case 3: {
-    bint<30> *t = new bint<30>();
-    bint<30>::sub(this->val, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::sub(this->val, other.val, t);
     return t;
   }
   }
@@ -449,28 +466,28 @@ Int Int::operator-(const Int &&other) const {
       return r;
     }
 
-    bint<30> *c = new bint<30>;
+    bint_t *c = new bint_t;
 
-    bint<30>::sub(this->x, other.x, c);
+    bint_t::sub(this->x, other.x, c);
 
     return c;
   }
 
   case 1: {
-    bint<30> *t = new bint<30>();
-    bint<30>::sub(this->x, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::sub(this->x, other.val, t);
     return t;
   }
 
   case 2: {
-    bint<30> *t = new bint<30>();
-    bint<30>::sub(this->val, other.x, t);
+    bint_t *t = new bint_t();
+    bint_t::sub(this->val, other.x, t);
     return t;
   }
 
   case 3: {
-    bint<30> *t = new bint<30>();
-    bint<30>::sub(this->val, other.val, t);
+    bint_t *t = new bint_t();
+    bint_t::sub(this->val, other.val, t);
     return t;
   }
   }
@@ -488,14 +505,10 @@ Int Int::operator-(const int z) const {
       return r;
     }
 
-    bint<30> *res = new bint<30>();
-    bint<30>::sub(this->x, z, res);
-
-    if (res->size == 2) {
-      long long r;
-
-      bint<30>::to_long(res, &r);
+    bint_t *res = new bint_t();
+    bint_t::sub(this->x, z, res);
 
+    if (bint_t::to_long(res, &r) == 1) {
       delete res;
 
       return r;
@@ -505,15 +518,13 @@ Int Int::operator-(const int z) const {
   }
   case 1: {
 
-    bint<30> *res = new bint<30>();
-
-		bint<30>::sub(this->val, z, res);
+    bint_t *res = new bint_t();
 
-    if (res->size == 2) {
-      long long r;
+		bint_t::sub(this->val, z, res);
 
-      bint<30>::to_long(res, &r);
+    long long r;
 
+    if (bint_t::to_long(res, &r) == 1) {
       delete res;
 
       return r;
@@ -537,27 +548,27 @@ Int Int::operator*(const Int &other) const {
       return r;
     }
 
-    bint<30> *c = new bint<30>();
+    bint_t *c = new bint_t();
 
-    bint<30>::mul(this->x, other.x, c);
+    bint_t::mul(this->x, other.x, c);
 
     return c;
 	}
 
 	case 1: {
-		bint<30> *t = new bint<30>();
-		bint<30>::mul(this->x, other.val, t);
+		bint_t *t = new bint_t();
+		bint_t::mul(this->x, other.val, t);
     return t;
 	}
 
 	case 2: {
-		bint<30> *t = new bint<30>();
-		bint<30>::mul(this->val, other.x, t);
+		bint_t *t = new bint_t();
+		bint_t::mul(this->val, other.x, t);
     return t;
 	}
 	case 3: {
-		bint<30> *t = new bint<30>();
-		bint<30>::mul(this->val, other.val, t);
+		bint_t *t = new bint_t();
+		bint_t::mul(this->val, other.val, t);
 		return t;
 	}
 	}
@@ -575,11 +586,11 @@ Int Int::operator*(const Int &&other) const {
       return r;
     }
 
-    bint<30> *a = bint<30>::from(this->x);
-    bint<30> *b = bint<30>::from(other.x);
-    bint<30> *c = new bint<30>();
+    bint_t *a = bint_t::from(this->x);
+    bint_t *b = bint_t::from(other.x);
+    bint_t *c = new bint_t();
 
-    bint<30>::mul(a, b, c);
+    bint_t::mul(a, b, c);
 
     delete a;
     delete b;
@@ -588,19 +599,19 @@ Int Int::operator*(const Int &&other) const {
 	}
 
 	case 1: {
-		bint<30> *t = new bint<30>();
-    bint<30>::mul(this->x, other.val, t);
+		bint_t *t = new bint_t();
+    bint_t::mul(this->x, other.val, t);
     return t;
 	}
 
 	case 2: {
-		bint<30> *t = new bint<30>();
-		bint<30>::mul(this->val, other.x, t);
+		bint_t *t = new bint_t();
+		bint_t::mul(this->val, other.x, t);
     return t;
 	}
 	case 3: {
-		bint<30> *t = new bint<30>();
-		bint<30>::mul(this->val, other.val, t);
+		bint_t *t = new bint_t();
+		bint_t::mul(this->val, other.val, t);
 		return t;
 	}
 	}
@@ -618,13 +629,13 @@ Int Int::operator*(const int z) const {
       return r;
     }
 
-		bint<30> *t = new bint<30>();
-    bint<30>::mul(this->x, z, t);
+		bint_t *t = new bint_t();
+    bint_t::mul(this->x, z, t);
     return t;
 	}
 	case 1: {
-		bint<30> *res = new bint<30>();
-		bint<30>::mul(this->val, z, res);
+		bint_t *res = new bint_t();
+		bint_t::mul(this->val, z, res);
 		return res;
 	}
 	}
@@ -650,21 +661,19 @@ Int Int::operator/(const Int &other) const {
       return r;
     }
 
-    bint<30> *a = bint<30>::from(this->x);
-    bint<30> *b = bint<30>::from(other.x);
+    bint_t *a = bint_t::from(this->x);
+    bint_t *b = bint_t::from(other.x);
 
-    bint<30> *quo = new bint<30>;
-    bint<30> *rem = new bint<30>;
+    bint_t *quo = new bint_t;
+    bint_t *rem = new bint_t;
 
-    bint<30>::div(a, b, quo, rem);
+    bint_t::div(a, b, quo, rem);
 
     delete a;
     delete b;
     delete rem;
 
-    if (quo->size == 2) {
-      bint<30>::to_long(quo, &r);
-
+    if (bint_t::to_long(quo, &r) == 1) {
       delete quo;
 
       return r;
@@ -673,21 +682,19 @@ Int Int::operator/(const Int &other) const {
     return quo;
   }
 
-  bint<30> *quo = new bint<30>();
-  bint<30> *rem = new bint<30>();
+  bint_t *quo = new bint_t();
+  bint_t *rem = new bint_t();
 
   if (this->flag && !other.flag) {
     long long r;
 
-    bint<30> *k = bint<30>::from(other.x);
-    bint<30>::div(this->val, k, quo, rem);
+    bint_t *k = bint_t::from(other.x);
+    bint_t::div(this->val, k, quo, rem);
     delete k;
 
     delete rem;
 
-    if (quo->size == 2) {
-      bint<30>::to_long(quo, &r);
-
+    if (bint_t::to_long(quo, &r) == 1) {
       delete quo;
 
       return r;
@@ -700,17 +707,15 @@ Int Int::operator/(const Int &other) const {
 
     long long r;
 
-    bint<30> *k = bint<30>::from(this->x);
+    bint_t *k = bint_t::from(this->x);
 
-    bint<30>::div(k, other.val, quo, rem);
+    bint_t::div(k, other.val, quo, rem);
 
     delete k;
 
     delete rem;
 
-    if (quo->size == 2) {
-      bint<30>::to_long(quo, &r);
-
+    if (bint_t::to_long(quo, &r) == 1) {
       delete quo;
 
       return r;
@@ -719,7 +724,7 @@ Int Int::operator/(const Int &other) const {
     return quo;
   }
 
-  bint<30>::div(this->val, other.val, quo, rem);
+  bint_t::div(this->val, other.val, quo, rem);
 
   delete rem;
 
@@ -734,21 +739,19 @@ Int Int::operator/(const Int &&other) const {
       return r;
     }
 
-    bint<30> *a = bint<30>::from(this->x);
-    bint<30> *b = bint<30>::from(other.x);
+    bint_t *a = bint_t::from(this->x);
+    bint_t *b = bint_t::from(other.x);
 
-    bint<30> *quo = new bint<30>;
-    bint<30> *rem = new bint<30>;
+    bint_t *quo = new bint_t;
+    bint_t *rem = new bint_t;
 
-    bint<30>::div(a, b, quo, rem);
+    bint_t::div(a, b, quo, rem);
 
     delete a;
     delete b;
     delete rem;
 
-    if (quo->size == 2) {
-      bint<30>::to_long(quo, &r);
-
+    if (bint_t::to_long(quo, &r) == 1) {
       delete quo;
 
       return r;
@@ -757,21 +760,19 @@ Int Int::operator/(const Int &&other) const {
     return quo;
   }
 
-  bint<30> *quo = new bint<30>();
-  bint<30> *rem = new bint<30>();
+  bint_t *quo = new bint_t();
+  bint_t *rem = new bint_t();
 
   if (this->flag && !other.flag) {
     long long r;
 
-    bint<30> *k = bint<30>::from(other.x);
-    bint<30>::div(this->val, k, quo, rem);
+    bint_t *k = bint_t::from(other.x);
+    bint_t::div(this->val, k, quo, rem);
     delete k;
 
     delete rem;
 
-    if (quo->size == 2) {
-      bint<30>::to_long(quo, &r);
-
+    if (bint_t::to_long(quo, &r) == 1) {
       delete quo;
 
       return r;
@@ -784,17 +785,15 @@ Int Int::operator/(const Int &&other) const {
 
     long long r;
 
-    bint<30> *k = bint<30>::from(this->x);
+    bint_t *k = bint_t::from(this->x);
 
-    bint<30>::div(k, other.val, quo, rem);
+    bint_t::div(k, other.val, quo, rem);
 
     delete k;
 
     delete rem;
 
-    if (quo->size == 2) {
-      bint<30>::to_long(quo, &r);
-
+    if (bint_t::to_long(quo, &r) == 1) {
       delete quo;
 
       return r;
@@ -803,7 +802,7 @@ Int Int::operator/(const Int &&other) const {
     return quo;
   }
 
-  bint<30>::div(this->val, other.val, quo, rem);
+  bint_t::div(this->val, other.val, quo, rem);
 
   delete rem;
 
@@ -818,23 +817,19 @@ Int Int::operator/(const int z) const {
       return r;
     }
 
-    bint<30> *res = new bint<30>();
-    bint<30> *rem = new bint<30>();
+    bint_t *res = new bint_t();
+    bint_t *rem = new bint_t();
 
-    bint<30> *a = bint<30>::from(this->x);
-    bint<30> *b = bint<30>::from(z);
+    bint_t *a = bint_t::from(this->x);
+    bint_t *b = bint_t::from(z);
 
-    bint<30>::div(a, b, res, rem);
+    bint_t::div(a, b, res, rem);
 
     delete a;
     delete b;
     delete rem;
 
-    if (res->size == 2) {
-      long long r;
-
-      bint<30>::to_long(res, &r);
-
+    if (bint_t::to_long(res, &r) == 1) {
       delete res;
 
       return r;
@@ -843,21 +838,19 @@ Int Int::operator/(const int z) const {
     return res;
   }
 
-  bint<30> *res = new bint<30>();
-  bint<30> *rem = new bint<30>();
+  bint_t *res = new bint_t();
+  bint_t *rem = new bint_t();
 
-  bint<30> *tmp = bint<30>::from(z);
+  bint_t *tmp = bint_t::from(z);
 
-  bint<30>::div(this->val, tmp, res, rem);
+  bint_t::div(this->val, tmp, res, rem);
 
   delete tmp;
   delete rem;
 
-  if (res->size == 2) {
-    long long r;
-
-    bint<30>::to_long(res, &r);
+  long long r;
 
+  if (bint_t::to_long(res, &r) == 1) {
     delete res;
 
     return r;
@@ -874,20 +867,20 @@ Int Int::operator%(const Int &other) const {
     // Int2(other.x)).to_string());
 		return  this->x % other.x;
 
-    // bint<30> *a = bint<30>::from(this->x);
-    // bint<30> *b = bint<30>::from(other.x);
+    // bint_t *a = bint_t::from(this->x);
+    // bint_t *b = bint_t::from(other.x);
 
-    // bint<30> *quo = new bint<30>;
-    // bint<30> *rem = new bint<30>;
+    // bint_t *quo = new bint_t;
+    // bint_t *rem = new bint_t;
 
-    // bint<30>::div(a, b, quo, rem);
+    // bint_t::div(a, b, quo, rem);
 
     // delete a;
     // delete b;
     // delete quo;
 
     // if (rem->size == 2) {
-    //   bint<30>::to_long(rem, &r);
+    //   bint_t::to_long(rem, &r);
 
     //   delete rem;
 
@@ -899,22 +892,20 @@ Int Int::operator%(const Int &other) const {
     // return rem;
   }
 
-  bint<30> *quo = new bint<30>();
-  bint<30> *rem = new bint<30>();
+  bint_t *quo = new bint_t();
+  bint_t *rem = new bint_t();
 
   if (this->flag && !other.flag) {
     long long r;
 
-    bint<30> *k = bint<30>::from(other.x);
+    bint_t *k = bint_t::from(other.x);
 
-    bint<30>::div(this->val, k, quo, rem);
+    bint_t::div(this->val, k, quo, rem);
 
     delete k;
     delete quo;
 
-    if (rem->size == 2) {
-      bint<30>::to_long(rem, &r);
-
+    if (bint_t::to_long(rem, &r) == 1) {
       delete rem;
 
       return r;
@@ -927,16 +918,14 @@ Int Int::operator%(const Int &other) const {
 
     long long r;
 
-    bint<30> *k = bint<30>::from(this->x);
+    bint_t *k = bint_t::from(this->x);
 
-    bint<30>::div(k, other.val, quo, rem);
+    bint_t::div(k, other.val, quo, rem);
 
     delete k;
     delete quo;
 
-    if (rem->size == 2) {
-      bint<30>::to_long(rem, &r);
-
+    if (bint_t::to_long(rem, &r) == 1) {
       delete rem;
 
       return r;
@@ -945,7 +934,7 @@ Int Int::operator%(const Int &other) const {
     return rem;
   }
 
-  bint<30>::div(this->val, other.val, quo, rem);
+  bint_t::div(this->val, other.val, quo, rem);
 
   delete quo;
 
@@ -957,22 +946,20 @@ Int Int::operator%(const Int &&other) const {
 		return  this->x % other.x;
   }
 
-  bint<30> *quo = new bint<30>();
-  bint<30> *rem = new bint<30>();
+  bint_t *quo = new bint_t();
+  bint_t *rem = new bint_t();
 
   if (this->flag && !other.flag) {
     long long r;
 
-    bint<30> *k = bint<30>::from(other.x);
+    bint_t *k = bint_t::from(other.x);
 
-    bint<30>::div(this->val, k, quo, rem);
+    bint_t::div(this->val, k, quo, rem);
 
     delete k;
     delete quo;
 
-    if (rem->size == 2) {
-      bint<30>::to_long(rem, &r);
-
+    if (bint_t::to_long(rem, &r) == 1) {
       delete rem;
 
       return r;
@@ -985,16 +972,14 @@ Int Int::operator%(const Int &&other) const {
 
     long long r;
 
-    bint<30> *k = bint<30>::from(this->x);
+    bint_t *k = bint_t::from(this->x);
 
-    bint<30>::div(k, other.val, quo, rem);
+    bint_t::div(k, other.val, quo, rem);
 
     delete k;
     delete quo;
 
-    if (rem->size == 2) {
-      bint<30>::to_long(rem, &r);
-
+    if (bint_t::to_long(rem, &r) == 1) {
       delete rem;
 
       return r;
@@ -1003,7 +988,7 @@ Int Int::operator%(const Int &&other) const {
     return rem;
   }
 
-  bint<30>::div(this->val, other.val, quo, rem);
+  bint_t::div(this->val, other.val, quo, rem);
 
   delete quo;
 
@@ -1015,21 +1000,19 @@ Int Int::operator%(const int z) const {
     return this->x % z;
   }
 
-  bint<30> *res = new bint<30>();
-  bint<30> *rem = new bint<30>();
+  bint_t *res = new bint_t();
+  bint_t *rem = new bint_t();
 
-  bint<30> *tmp = bint<30>::from(z);
+  bint_t *tmp = bint_t::from(z);
 
-  bint<30>::div(this->val, tmp, res, rem);
+  bint_t::div(this->val, tmp, res, rem);
 
   delete tmp;
   delete res;
 
-  if (rem->size == 2) {
-    long long r;
-
-    bint<30>::to_long(rem, &r);
+  long long r;
 
+  if (bint_t::to_long(rem, &r) == 1) {
     delete rem;
     return r;
   }
@@ -1077,14 +1060,14 @@ bool Int::operator==(const Int &other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) == 0;
+    return bint_t::compare(this->x, other.val) == 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) == 0;
+    return bint_t::compare(this->val, other.x) == 0;
   }
 
-	return bint<30>::compare(this->val, other.val) == 0;
+	return bint_t::compare(this->val, other.val) == 0;
 }
 
 bool Int::operator==(const Int &&other) const {
@@ -1093,14 +1076,14 @@ bool Int::operator==(const Int &&other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) == 0;
+    return bint_t::compare(this->x, other.val) == 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) == 0;
+    return bint_t::compare(this->val, other.x) == 0;
   }
 
-  return bint<30>::compare(this->val, other.val) == 0;
+  return bint_t::compare(this->val, other.val) == 0;
 }
 
 bool Int::operator<(const Int &other) const {
@@ -1109,14 +1092,14 @@ bool Int::operator<(const Int &other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) < 0;
+    return bint_t::compare(this->x, other.val) < 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) < 0;
+    return bint_t::compare(this->val, other.x) < 0;
   }
 
-  return bint<30>::compare(this->val, other.val) < 0;
+  return bint_t::compare(this->val, other.val) < 0;
 }
 
 bool Int::operator<(const Int &&other) const {
@@ -1125,14 +1108,14 @@ bool Int::operator<(const Int &&other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) < 0;
+    return bint_t::compare(this->x, other.val) < 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) < 0;
+    return bint_t::compare(this->val, other.x) < 0;
   }
 
-  return bint<30>::compare(this->val, other.val) < 0;
+  return bint_t::compare(this->val, other.val) < 0;
 }
 
 bool Int::operator<=(const Int &other) const {
@@ -1141,14 +1124,14 @@ bool Int::operator<=(const Int &other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) <= 0;
+    return bint_t::compare(this->x, other.val) <= 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) <= 0;
+    return bint_t::compare(this->val, other.x) <= 0;
   }
 
-  return bint<30>::compare(this->val, other.val) <= 0;
+  return bint_t::compare(this->val, other.val) <= 0;
 }
 
 bool Int::operator<=(const Int &&other) const {
@@ -1157,14 +1140,14 @@ bool Int::operator<=(const Int &&other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) <= 0;
+    return bint_t::compare(this->x, other.val) <= 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) <= 0;
+    return bint_t::compare(this->val, other.x) <= 0;
   }
 
-  return bint<30>::compare(this->val, other.val) <= 0;
+  return bint_t::compare(this->val, other.val) <= 0;
 }
 
 bool Int::operator>(const Int &other) const {
@@ -1173,14 +1156,14 @@ bool Int::operator>(const Int &other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) > 0;
+    return bint_t::compare(this->x, other.val) > 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) > 0;
+    return bint_t::compare(this->val, other.x) > 0;
   }
 
-  return bint<30>::compare(this->val, other.val) > 0;
+  return bint_t::compare(this->val, other.val) > 0;
 }
 
 bool Int::operator>(const Int &&other) const {
@@ -1189,14 +1172,14 @@ bool Int::operator>(const Int &&other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) > 0;
+    return bint_t::compare(this->x, other.val) > 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) > 0;
+    return bint_t::compare(this->val, other.x) > 0;
   }
 
-  return bint<30>::compare(this->val, other.val) > 0;
+  return bint_t::compare(this->val, other.val) > 0;
 }
 
 bool Int::operator>=(const Int &other) const {
@@ -1205,14 +1188,14 @@ bool Int::operator>=(const Int &other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) >= 0;
+    return bint_t::compare(this->x, other.val) >= 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) >= 0;
+    return bint_t::compare(this->val, other.x) >= 0;
   }
 
-  return bint<30>::compare(this->val, other.val) >= 0;
+  return bint_t::compare(this->val, other.val) >= 0;
 }
 
 bool Int::operator>=(const Int &&other) const {
@@ -1221,14 +1204,14 @@ bool Int::operator>=(const Int &&other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) >= 0;
+    return bint_t::compare(this->x, other.val) >= 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) >= 0;
+    return bint_t::compare(this->val, other.x) >= 0;
   }
 
-  return bint<30>::compare(this->val, other.val) >= 0;
+  return bint_t::compare(this->val, other.val) >= 0;
 }
 
 bool Int::operator!=(const Int &other) const {
@@ -1237,14 +1220,14 @@ bool Int::operator!=(const Int &other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) != 0;
+    return bint_t::compare(this->x, other.val) != 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) != 0;
+    return bint_t::compare(this->val, other.x) != 0;
   }
 
-  return bint<30>::compare(this->val, other.val) != 0;
+  return bint_t::compare(this->val, other.val) != 0;
 };
 
 bool Int::operator!=(const Int &&other) const {
@@ -1254,14 +1237,14 @@ bool Int::operator!=(const Int &&other) const {
   }
 
   if (!this->flag && other.flag) {
-    return bint<30>::compare(this->x, other.val) != 0;
+    return bint_t::compare(this->x, other.val) != 0;
   }
 
   if (this->flag && !other.flag) {
-    return bint<30>::compare(this->val, other.x) != 0;
+    return bint_t::compare(this->val, other.x) != 0;
   }
 
-  return bint<30>::compare(this->val, other.val) != 0;
+  return bint_t::compare(this->val, other.val) != 0;
 };
 
 Int Int::operator=(const Int &other) {
@@ -1299,7 +1282,7 @@ Int Int::ceil_log2() {
   if (!flag) {
     return std::ceil(std::log2(x));
   }
-  return bint<30>::ceil_log2(this->val);
+  return bint_t::ceil_log2(this->val);
 }
 
 long long Int::longValue() {
@@ -1308,7 +1291,7 @@ long long Int::longValue() {
 
   long long v = 0;
 
-  if (bint<30>::to_long(this->val, &v) == -1) {
+  if (bint_t::to_long(this->val, &v) == -1) {
 		raise(error(ErrorCode::LONG_LONG_OVERFLOW, 0));
   }
 
@@ -1321,7 +1304,7 @@ double Int::doubleValue() {
 
   double v = 0.0;
 
-	if(bint<30>::to_double(this->val, &v) == -1) {
+	if(bint_t::to_double(this->val, &v) == -1) {
 		raise(error(ErrorCode::DOUBLE_OVERFLOW, 0));
 	}
 
@@ -1338,25 +1321,29 @@ Int gcd(const Int &a, const Int &b) {
   }
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
+    bint_t *k = bint_t::from(a.x);
 
-    bint<30> *r = bint<30>::gcd(k, b.val);
-
-    // TODO: convert r to long long if it have size 2
+    Int r = bint_t::gcd(k, b.val);
 
     delete k;
 
+    r.to_long_if_small();
+
     return r;
   }
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::gcd(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    Int r = bint_t::gcd(a.val, k);
     delete k;
 
+    r.to_long_if_small();
+
     return r;
   }
 
-  bint<30> *g = bint<30>::gcd(a.val, b.val);
+  Int g = bint_t::gcd(a.val, b.val);
+
+  g.to_long_if_small();
 
   return g;
 }
@@ -1371,25 +1358,29 @@ Int gcd(const Int &&a, const Int &&b) {
   }
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
+    bint_t *k = bint_t::from(a.x);
 
-    bint<30> *r = bint<30>::gcd(k, b.val);
-
-    // TODO: convert r to long long if it have size 2
+    Int r = bint_t::gcd(k, b.val);
 
     delete k;
 
+    r.to_long_if_small();
+
     return r;
   }
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::gcd(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    Int r = bint_t::gcd(a.val, k);
     delete k;
 
+    r.to_long_if_small();
+
     return r;
   }
 
-  bint<30> *g = bint<30>::gcd(a.val, b.val);
+  Int g = bint_t::gcd(a.val, b.val);
+
+  g.to_long_if_small();
 
   return g;
 }
@@ -1405,9 +1396,9 @@ Int lcm(const Int &a, const Int &b) {
   }
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
+    bint_t *k = bint_t::from(a.x);
 
-    bint<30> *r = bint<30>::lcm(k, b.val);
+    bint_t *r = bint_t::lcm(k, b.val);
 
     // TODO: convert r to long long if it have size 2
 
@@ -1416,14 +1407,14 @@ Int lcm(const Int &a, const Int &b) {
     return r;
   }
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::lcm(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::lcm(a.val, k);
     delete k;
 
     return r;
   }
 
-  bint<30> *g = bint<30>::lcm(a.val, b.val);
+  bint_t *g = bint_t::lcm(a.val, b.val);
 
   return g;
 }
@@ -1437,9 +1428,9 @@ Int lcm(const Int &&a, const Int &&b) {
   }
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
+    bint_t *k = bint_t::from(a.x);
 
-    bint<30> *r = bint<30>::lcm(k, b.val->copy());
+    bint_t *r = bint_t::lcm(k, b.val->copy());
 
     // TODO: convert r to long long if it have size 2
 
@@ -1448,33 +1439,310 @@ Int lcm(const Int &&a, const Int &&b) {
     return r;
   }
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::lcm(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::lcm(a.val, k);
     delete k;
 
     return r;
   }
 
-  bint<30> *g = bint<30>::lcm(a.val, b.val);
+  bint_t *g = bint_t::lcm(a.val, b.val);
+
+  return g;
+}
+
+Int xgcd(const Int &a, const Int &b, Int &s, Int &t) {
+  if (!a.flag && !b.flag && a.x > -(1ll << 62) && a.x < (1ll << 62) &&
+      b.x > -(1ll << 62) && b.x < (1ll << 62)) {
+    // the cofactors are bounded by max(|a|, |b|), so nothing overflows
+    long long r0 = std::abs(a.x), r1 = std::abs(b.x);
+    long long s0 = 1, s1 = 0;
+    long long t0 = 0, t1 = 1;
+
+    while (r1) {
+      long long q = r0 / r1;
+      long long k = 0;
+
+      k = r0 - q * r1;
+      r0 = r1;
+      r1 = k;
+
+      k = s0 - q * s1;
+      s0 = s1;
+      s1 = k;
+
+      k = t0 - q * t1;
+      t0 = t1;
+      t1 = k;
+    }
+
+    s = a.x < 0 ? -s0 : s0;
+    t = b.x < 0 ? -t0 : t0;
+
+    return r0;
+  }
+
+  bint_t *x = a.flag ? a.val->copy() : bint_t::from(a.x);
+  bint_t *y = b.flag ? b.val->copy() : bint_t::from(b.x);
+
+  bint_t *u = new bint_t();
+  bint_t *v = new bint_t();
+
+  Int g = bint_t::xgcd(x, y, u, v);
+
+  delete x;
+  delete y;
+
+  s = u;
+  t = v;
+
+  g.to_long_if_small();
+  s.to_long_if_small();
+  t.to_long_if_small();
 
   return g;
 }
 
-void Int::operator/=(Int v) { *this = *this / v; }
-void Int::operator+=(Int v) { *this = *this + v; }
-void Int::operator-=(Int v) { *this = *this - v; }
-void Int::operator*=(Int v) { *this = *this * v; }
+// Non allocating bint with the value of a long long, it is used
+// as the second operand of the in place operations.
+struct smallBint {
+  bint_t v;
+
+  smallBint(long long x) {
+    v.size = bint_t::digits_of(x, v.digit);
+    v.sign = x < 0 ? -1 : 1;
+  }
+};
+
+// returns the digits of a as a bint, using t when a is a long long
+static inline bint_t *bintOf(const Int &a, smallBint &t) {
+  return a.flag ? a.val : &t.v;
+}
+
+Int &Int::operator+=(const Int &v) {
+  long long r;
+
+  if (!this->flag && !v.flag && safe_add(this->x, v.x, &r) == LONG_LONG_OK) {
+    this->x = r;
+    return *this;
+  }
+
+  smallBint t(v.flag ? 0 : v.x);
+
+  bint_t *y = bintOf(v, t);
+
+  if (!this->flag) {
+    this->val = bint_t::from(this->x);
+    this->flag = 1;
+  }
+
+  bint_t::add_in_place(this->val, y, 1);
+
+  return *this;
+}
+
+Int &Int::operator-=(const Int &v) {
+  long long r;
+
+  if (!this->flag && !v.flag && safe_sub(this->x, v.x, &r) == LONG_LONG_OK) {
+    this->x = r;
+    return *this;
+  }
+
+  smallBint t(v.flag ? 0 : v.x);
+
+  bint_t *y = bintOf(v, t);
+
+  if (!this->flag) {
+    this->val = bint_t::from(this->x);
+    this->flag = 1;
+  }
+
+  bint_t::add_in_place(this->val, y, -1);
+
+  return *this;
+}
+
+Int &Int::operator*=(const Int &v) {
+  long long r;
+
+  if (!this->flag && !v.flag && safe_mul(this->x, v.x, &r) == LONG_LONG_OK) {
+    this->x = r;
+    return *this;
+  }
+
+  smallBint t(v.flag ? 0 : v.x);
+
+  bint_t *y = bintOf(v, t);
+
+  if (!this->flag) {
+    this->val = bint_t::from(this->x);
+    this->flag = 1;
+  }
+
+  bint_t::mul_in_place(this->val, y);
+
+  return *this;
+}
+
+Int &Int::operator/=(const Int &v) {
+  if (!this->flag && !v.flag) {
+    this->x = this->x / v.x;
+    return *this;
+  }
+
+  smallBint t(v.flag ? 0 : v.x);
+
+  bint_t *y = bintOf(v, t);
+
+  if (!this->flag) {
+    this->val = bint_t::from(this->x);
+    this->flag = 1;
+  }
+
+  bint_t::div_in_place(this->val, y, true);
+
+  this->to_long_if_small();
+
+  return *this;
+}
+
+Int &Int::operator%=(const Int &v) {
+  if (!this->flag && !v.flag) {
+    this->x = this->x % v.x;
+    return *this;
+  }
+
+  smallBint t(v.flag ? 0 : v.x);
+
+  bint_t *y = bintOf(v, t);
+
+  if (!this->flag) {
+    this->val = bint_t::from(this->x);
+    this->flag = 1;
+  }
+
+  bint_t::div_in_place(this->val, y, false);
+
+  this->to_long_if_small();
+
+  return *this;
+}
+
+void addmul(Int &a, const Int &b, const Int &c) {
+  long long r, s;
+
+  if (!a.flag && !b.flag && !c.flag && safe_mul(b.x, c.x, &r) == LONG_LONG_OK &&
+      safe_add(a.x, r, &s) == LONG_LONG_OK) {
+    a.x = s;
+    return;
+  }
+
+  smallBint tb(b.flag ? 0 : b.x);
+  smallBint tc(c.flag ? 0 : c.x);
+
+  bint_t *x = bintOf(b, tb);
+  bint_t *y = bintOf(c, tc);
+
+  if (!a.flag) {
+    a.val = bint_t::from(a.x);
+    a.flag = 1;
+  }
+
+  bint_t::addmul(a.val, x, y);
+}
+
+void submul(Int &a, const Int &b, const Int &c) {
+  long long r, s;
+
+  if (!a.flag && !b.flag && !c.flag && safe_mul(b.x, c.x, &r) == LONG_LONG_OK &&
+      safe_sub(a.x, r, &s) == LONG_LONG_OK) {
+    a.x = s;
+    return;
+  }
+
+  smallBint tb(b.flag ? 0 : b.x);
+  smallBint tc(c.flag ? 0 : c.x);
+
+  bint_t *x = bintOf(b, tb);
+  bint_t *y = bintOf(c, tc);
+
+  if (!a.flag) {
+    a.val = bint_t::from(a.x);
+    a.flag = 1;
+  }
+
+  bint_t::submul(a.val, x, y);
+}
 
 Int abs(const Int &&a) {
   if (!a.flag)
     return std::abs(a.x);
-  return bint<30>::abs(a.val);
+  return bint_t::abs(a.val);
 }
 
 Int abs(const Int &a) {
   if (!a.flag)
     return std::abs(a.x);
-  return bint<30>::abs(a.val);
+  return bint_t::abs(a.val);
+}
+
+// returns a as the argument of a factorial
+static unsigned long long factorialArg(const Int &a) {
+  if (a < 0) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  if (!a.flag) {
+    return a.x;
+  }
+
+  long long v = 0;
+
+  if (bint_t::to_long(a.val, &v) == -1) {
+    raise(error(ErrorCode::INT_BIGGER_THAN_MAX_ULL, 0));
+  }
+
+  return v;
+}
+
+// exponent of the prime p on n!, by Legendre's formula
+static unsigned long long legendre(unsigned long long n, unsigned long long p) {
+  unsigned long long e = 0;
+
+  while (n) {
+    n /= p;
+    e += n;
+  }
+
+  return e;
+}
+
+// returns n!/(k[0]!*...*k[m - 1]!) for k[0] + ... + k[m - 1] <= n as a
+// product of the powers of the primes up to n
+static Int factorialQuotient(unsigned long long n,
+                             const std::vector<unsigned long long> &k) {
+  std::vector<unsigned long long> p, e;
+
+  for (unsigned int i = 0; (unsigned long long)primes[i] <= n; i++) {
+    unsigned long long q = primes[i];
+    unsigned long long t = legendre(n, q);
+
+    for (size_t j = 0; j < k.size(); j++) {
+      t -= legendre(k[j], q);
+    }
+
+    if (t) {
+      p.push_back(q);
+      e.push_back(t);
+    }
+  }
+
+  Int r = bint_t::prime_powers(p.data(), e.data(), p.size());
+
+  r.to_long_if_small();
+
+  return r;
 }
 
 Int fact(const Int &&a) {
@@ -1484,15 +1752,9 @@ Int fact(const Int &&a) {
     if (safe_fact(a.x, &z) != LONG_LONG_OVERFLOW) {
       return z;
     }
-
-    bint<30> *x = bint<30>::from(a.x);
-
-    return x;
   }
 
-  bint<30> *g = bint<30>::fact(a.val);
-
-  return g;
+  return factorialQuotient(factorialArg(a), {});
 }
 
 Int fact(const Int &a) {
@@ -1502,15 +1764,44 @@ Int fact(const Int &a) {
     if (safe_fact(a.x, &z) != LONG_LONG_OVERFLOW) {
       return z;
     }
+  }
 
-    bint<30> *x = bint<30>::from(a.x);
+  return factorialQuotient(factorialArg(a), {});
+}
 
-    return x;
+Int binomial(const Int &n, const Int &k) {
+  if (n < 0) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  if (k < 0 || k > n) {
+    return 0;
   }
 
-  bint<30> *g = bint<30>::fact(a.val);
+  unsigned long long m = factorialArg(n);
+  unsigned long long j = factorialArg(k);
 
-  return g;
+  return factorialQuotient(m, {j, m - j});
+}
+
+Int multinomial(const Int &n, const std::vector<Int> &k) {
+  unsigned long long m = factorialArg(n);
+
+  std::vector<unsigned long long> t;
+
+  unsigned long long s = 0;
+
+  for (const Int &j : k) {
+    t.push_back(factorialArg(j));
+
+    s += t.back();
+
+    if (s > m) {
+      raise(error(ErrorCode::ARG_IS_INVALID, 0));
+    }
+  }
+
+  return factorialQuotient(m, t);
 }
 
 Int max(const Int &&a, Int &&b) {
@@ -1518,20 +1809,20 @@ Int max(const Int &&a, Int &&b) {
     return std::max(a.x, b.x);
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::max(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::max(k, b.val);
     delete k;
     return r;
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::max(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::max(a.val, k);
     delete k;
     return r;
   }
 
-  return bint<30>::max(a.val, b.val);
+  return bint_t::max(a.val, b.val);
 }
 
 Int max(const Int &a, Int &b) {
@@ -1539,20 +1830,20 @@ Int max(const Int &a, Int &b) {
     return std::max(a.x, b.x);
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::max(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::max(k, b.val);
     delete k;
     return r;
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::max(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::max(a.val, k);
     delete k;
     return r;
   }
 
-  return bint<30>::max(a.val, b.val);
+  return bint_t::max(a.val, b.val);
 }
 
 Int max(const Int &a, Int &&b) {
@@ -1561,20 +1852,20 @@ Int max(const Int &a, Int &&b) {
     return std::max(a.x, b.x);
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::max(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::max(k, b.val);
     delete k;
     return r;
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::max(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::max(a.val, k);
     delete k;
     return r;
   }
 
-  return bint<30>::max(a.val, b.val);
+  return bint_t::max(a.val, b.val);
 }
 
 Int min(const Int &&a, const Int &&b) {
@@ -1582,20 +1873,20 @@ Int min(const Int &&a, const Int &&b) {
     return std::min(a.x, b.x);
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::min(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::min(k, b.val);
     delete k;
     return r;
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::min(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::min(a.val, k);
     delete k;
     return r;
   }
 
-  return bint<30>::min(a.val, b.val);
+  return bint_t::min(a.val, b.val);
 }
 
 Int min(const Int &a, const Int &b) {
@@ -1603,20 +1894,20 @@ Int min(const Int &a, const Int &b) {
     return std::min(a.x, b.x);
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::min(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::min(k, b.val);
     delete k;
     return r;
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::min(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::min(a.val, k);
     delete k;
     return r;
   }
 
-  return bint<30>::min(a.val, b.val);
+  return bint_t::min(a.val, b.val);
 }
 
 Int pow(const Int &&a, const Int &&b) {
@@ -1626,9 +1917,9 @@ Int pow(const Int &&a, const Int &&b) {
       return z;
     }
 
-    bint<30> *x = bint<30>::from(a.x);
-    bint<30> *y = bint<30>::from(b.x);
-    bint<30> *w = bint<30>::pow(x, y);
+    bint_t *x = bint_t::from(a.x);
+    bint_t *y = bint_t::from(b.x);
+    bint_t *w = bint_t::pow(x, y);
 
     delete x;
     delete y;
@@ -1637,8 +1928,8 @@ Int pow(const Int &&a, const Int &&b) {
   }
 
   if (!a.flag && b.flag) {
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::pow(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::pow(k, b.val);
 
     delete k;
 
@@ -1646,15 +1937,15 @@ Int pow(const Int &&a, const Int &&b) {
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::pow(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::pow(a.val, k);
 
     delete k;
 
     return r;
   }
 
-  bint<30> *r = bint<30>::pow(a.val, b.val);
+  bint_t *r = bint_t::pow(a.val, b.val);
 
   return r;
 }
@@ -1667,9 +1958,9 @@ Int pow(const Int &a, const Int &b) {
       return z;
     }
 
-    bint<30> *x = bint<30>::from(a.x);
-    bint<30> *y = bint<30>::from(b.x);
-    bint<30> *w = bint<30>::pow(x, y);
+    bint_t *x = bint_t::from(a.x);
+    bint_t *y = bint_t::from(b.x);
+    bint_t *w = bint_t::pow(x, y);
 
     delete x;
     delete y;
@@ -1678,8 +1969,8 @@ Int pow(const Int &a, const Int &b) {
   }
   if (!a.flag && b.flag) {
 
-    bint<30> *k = bint<30>::from(a.x);
-    bint<30> *r = bint<30>::pow(k, b.val);
+    bint_t *k = bint_t::from(a.x);
+    bint_t *r = bint_t::pow(k, b.val);
 
     delete k;
 
@@ -1687,15 +1978,15 @@ Int pow(const Int &a, const Int &b) {
   }
 
   if (a.flag && !b.flag) {
-    bint<30> *k = bint<30>::from(b.x);
-    bint<30> *r = bint<30>::pow(a.val, k);
+    bint_t *k = bint_t::from(b.x);
+    bint_t *r = bint_t::pow(a.val, k);
 
     delete k;
 
     return r;
   }
 
-  bint<30> *r = bint<30>::pow(a.val, b.val);
+  bint_t *r = bint_t::pow(a.val, b.val);
 
   return r;
 }
@@ -1705,7 +1996,7 @@ double pow(const Int &&a, const double b) {
     return std::pow(a.x, b);
   }
 
-  return bint<30>::pow(a.val, b);
+  return bint_t::pow(a.val, b);
 }
 
 double pow(const Int &a, const double b) {
@@ -1713,7 +2004,54 @@ double pow(const Int &a, const double b) {
     return std::pow(a.x, b);
   }
 
-  return bint<30>::pow(a.val, b);
+  return bint_t::pow(a.val, b);
+}
+
+Int powMod(const Int &a, const Int &e, const Int &m) {
+  if (e < 0) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  if (m == 0) {
+    raise(error(ErrorCode::DIVISION_BY_ZERO, 0));
+  }
+
+  // moduli below 2^32 have products that fit on unsigned long longs
+  if (!m.flag && !e.flag && m.x < 4294967296LL && m.x > -4294967296LL) {
+    unsigned long long n = m.x < 0 ? -m.x : m.x;
+
+    long long t = (a % m).longValue();
+
+    unsigned long long b = t < 0 ? t + n : t;
+    unsigned long long r = 1 % n;
+
+    for (long long k = e.x; k; k >>= 1) {
+      if (k & 1) {
+        r = r * b % n;
+      }
+
+      b = b * b % n;
+    }
+
+    return (long long)r;
+  }
+
+  smallBint ta(a.x), te(e.x), tm(m.x);
+
+  bint_t n;
+
+  n.set(bintOf(m, tm));
+  n.sign = 1;
+
+  bint_t *z = new bint_t();
+
+  bint_t::pow_mod(bintOf(a, ta), bintOf(e, te), &n, z);
+
+  Int r = z;
+
+  r.to_long_if_small();
+
+  return r;
 }
 
 Int isqrt(const Int &a) {
@@ -1727,9 +2065,9 @@ Int isqrt(const Int &a) {
     return r;
   }
 
-  bint<30> *res = new bint<30>();
+  bint_t *res = new bint_t();
 
-  bint<30>::isqrt(a.val, res, 0);
+  bint_t::isqrt(a.val, res, 0);
 
   // TODO: convert to long long if the size of r is <= 2
 
@@ -1740,7 +2078,7 @@ bool operator<(const unsigned int a, const Int &v) {
   if (!v.flag)
     return a < v.x;
 
-  bool res = bint<30>::compare(a, v.val) < 0;
+  bool res = bint_t::compare(a, v.val) < 0;
 
   return res;
 }
@@ -1753,7 +2091,7 @@ bool operator>(const unsigned int a, const Int &v) {
   if (!v.flag)
     return a > v.x;
 
-  bool res = bint<30>::compare(a, v.val) > 0;
+  bool res = bint_t::compare(a, v.val) > 0;
 
   return res;
 }
@@ -1762,7 +2100,7 @@ bool operator<=(const unsigned int a, const Int &v) {
   if (!v.flag)
     return a <= v.x;
 
-  bool res = bint<30>::compare(a, v.val) <= 0;
+  bool res = bint_t::compare(a, v.val) <= 0;
 
   return res;
 }
@@ -1771,7 +2109,7 @@ bool operator>=(const unsigned int a, const Int &v) {
   if (!v.flag)
     return a >= v.x;
 
-  bool res = bint<30>::compare(a, v.val) >= 0;
+  bool res = bint_t::compare(a, v.val) >= 0;
 
   return res;
 }
@@ -1780,9 +2118,9 @@ Int operator+(const long long a, const Int &v) {
   if (!v.flag)
     return a + v.x;
 
-  bint<30> *res = new bint<30>();
+  bint_t *res = new bint_t();
 
-  bint<30>::add(a, v.val, res);
+  bint_t::add(a, v.val, res);
 
   return res;
 }
@@ -1791,9 +2129,9 @@ Int operator-(const long long a, const Int &v) {
   if (!v.flag)
     return a - v.x;
 
-  bint<30> *res = new bint<30>();
+  bint_t *res = new bint_t();
 
-  bint<30>::sub(a, v.val, res);
+  bint_t::sub(a, v.val, res);
 
   return res;
 }
@@ -13,22 +13,32 @@
 #define LONG_LONG_OK 1
 
 struct Int {
-  Int(bint<30> *v);
+  // big integers digits, the 64 bits backend is selected with the
+  // GAUSS_INT_64 build option
+#ifdef GAUSS_INT_64
+#ifndef __SIZEOF_INT128__
+#error "GAUSS_INT_64 needs a compiler with 128 bits integers"
+#endif
+  __extension__ typedef bint<62, uint64_t, unsigned __int128, int64_t, __int128>
+      bint_t;
+#else
+  typedef bint<30> bint_t;
+#endif
+
+  Int(bint_t *v);
 
   char flag = 0;
 
 	union {
 		long long x = 0;
-		bint<30> *val;
+		bint_t *val;
 	};
 
   void to_long_if_small() {
-    if (!this->flag || this->val->size > 2)
-      return;
-
     long long v = 0;
 
-    bint<30>::to_long(this->val, &v);
+    if (!this->flag || bint_t::to_long(this->val, &v) != 1)
+      return;
 
     delete this->val;
 
@@ -50,6 +60,12 @@ public:
   Int(Int &&);
   ~Int();
 	std::string to_string();
+
+	// Writes the decimal representation of the number followed by a
+	// null character on buf, if it fits on the n characters of buf.
+	// Returns the length of the representation, like snprintf.
+	size_t to_chars(char *buf, size_t n);
+
 	static Int fromString(const char*);
 
 	Int operator+(const Int &other) const ;
@@ -94,10 +110,21 @@ public:
   friend Int gcd(const Int &&a, const Int &&b) ;
   friend Int lcm(const Int &a, const Int &b);
   friend Int lcm(const Int &&a, const Int &&b);
-	void operator/=(Int v);
-	void operator+=(Int v);
-	void operator-=(Int v);
-	void operator*=(Int v);
+
+  // returns g = gcd(a, b) >= 0 and saves on s and t the cofactors
+  // such that g = s*a + t*b
+  friend Int xgcd(const Int &a, const Int &b, Int &s, Int &t);
+	// compound operators, they are computed in place reusing
+	// the digits of this integer whenever possible
+	Int &operator/=(const Int &v);
+	Int &operator+=(const Int &v);
+	Int &operator-=(const Int &v);
+	Int &operator*=(const Int &v);
+	Int &operator%=(const Int &v);
+
+	// a = a + b*c and a = a - b*c in place
+	friend void addmul(Int &a, const Int &b, const Int &c);
+	friend void submul(Int &a, const Int &b, const Int &c);
 
   explicit operator bool()  const {
 		if (!this->flag)
@@ -110,7 +137,7 @@ public:
 
 	// 	long long r;
 
-	// 	bint<30>::to_long(val, &r);
+	// 	bint_t::to_long(val, &r);
 
 	// 	return r;
 	// }
@@ -120,7 +147,7 @@ public:
 
 	// 	long long r;
 
-	// 	bint<30>::to_long(val, &r);
+	// 	bint_t::to_long(val, &r);
 
 	// 	return r;
 	// }
@@ -132,6 +159,14 @@ public:
 
   friend Int fact(const Int &&a);
   friend Int fact(const Int &a);
+
+  // returns the binomial coefficient n!/(k!*(n - k)!)
+  friend Int binomial(const Int &n, const Int &k);
+
+  // returns n!/(k[0]!*...*k[m - 1]!), it is required that the sum of
+  // the k's is at most n
+  friend Int multinomial(const Int &n, const std::vector<Int> &k);
+
   friend Int max(const Int &&a, Int &&b);
   friend Int max(const Int &a, Int &b);
   friend Int max(const Int &a, Int &&b);
@@ -139,6 +174,10 @@ public:
   friend Int min(const Int &a, const Int &b);
   friend Int pow(const Int &&a, const Int &&b);
   friend Int pow(const Int &a, const Int &b);
+
+  // returns a^e mod |m| in [0, |m|), for e >= 0 and m != 0
+  friend Int powMod(const Int &a, const Int &e, const Int &m);
+
   friend Int isqrt(const Int &a);
   friend Int operator*(const int a, const Int &v) ;
   friend Int operator+(const long long a, const Int &v) ;
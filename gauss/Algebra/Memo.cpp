@@ -0,0 +1,328 @@
+#include "Memo.hpp"
+#include "Utils.hpp"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace alg {
+
+using namespace utils;
+
+// the caches are disabled until a limit is set, hashing and interning
+// every argument only pays off on workloads that repeat them
+static std::atomic<size_t> limit(0);
+static std::atomic<bool> per_thread(false);
+
+struct memo_entry {
+  memo_op op;
+  size_t hash;
+  size_t bytes;
+
+  expr key;
+  expr arg;
+  expr value;
+};
+
+struct memo_cache {
+  std::mutex lock;
+
+  // most recently used first
+  std::list<memo_entry> entries;
+  std::unordered_multimap<size_t, std::list<memo_entry>::iterator> index;
+
+  size_t bytes;
+  size_t hits;
+  size_t misses;
+
+  memo_cache() : bytes(0), hits(0), misses(0) {}
+
+  // drops the least recently used entries until the cache fits on b
+  // bytes, the lock should be held
+  void shrink(size_t b) {
+    while (bytes > b && !entries.empty()) {
+      memo_entry &e = entries.back();
+
+      auto range = index.equal_range(e.hash);
+
+      for (auto it = range.first; it != range.second; ++it) {
+        if (&*it->second == &e) {
+          index.erase(it);
+          break;
+        }
+      }
+
+      bytes -= e.bytes;
+
+      entries.pop_back();
+    }
+  }
+};
+
+static memo_cache &shared_cache() {
+  // never destroyed, the results may be looked up until the end of the
+  // program
+  static memo_cache *c = new memo_cache();
+  return *c;
+}
+
+static memo_cache &cache() {
+  static thread_local memo_cache local;
+
+  return per_thread.load(std::memory_order_relaxed) ? local : shared_cache();
+}
+
+static inline size_t hash_combine(size_t h, size_t v) {
+  return h ^ (v + (size_t)0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+static size_t memo_hash(memo_op op, const expr &u, const expr *x) {
+  size_t h = hash_combine(op, structural_hash(u));
+
+  return x ? hash_combine(h, structural_hash(*x)) : h;
+}
+
+// Approximated number of bytes of u, the operands shared by interning
+// are counted every time they appear.
+static size_t expr_bytes(const expr &u) {
+  size_t b = 0;
+
+  work_stack<const expr *, 32> stack;
+
+  stack.push_back(&u);
+
+  while (!stack.empty()) {
+    const expr *v = stack.back();
+
+    stack.pop_back();
+
+    b += sizeof(expr);
+
+    if (v->kind_of == kind::INT) {
+      b += sizeof(Int);
+    }
+
+    const operand_list &l = v->expr_childs;
+
+    if (l.node) {
+      b += sizeof(expr_node) + (l.node->capacity - l.size()) * sizeof(expr);
+
+      for (size_t i = 0; i < l.size(); i++) {
+        stack.push_back(&l[i]);
+      }
+    }
+  }
+
+  return b;
+}
+
+// lists, sets and matrices are not interned, and the keys are not
+// compared by their members, so the expressions containing them are not
+// cached
+static bool cacheable(const expr &u) {
+  work_stack<const expr *, 32> stack;
+
+  stack.push_back(&u);
+
+  while (!stack.empty()) {
+    const expr *v = stack.back();
+
+    stack.pop_back();
+
+    if (is(v, kind::LIST | kind::SET | kind::MAT)) {
+      return false;
+    }
+
+    const operand_list &l = v->expr_childs;
+
+    for (size_t i = 0; i < l.size(); i++) {
+      stack.push_back(&l[i]);
+    }
+  }
+
+  return true;
+}
+
+// expr::operator== sorts the operands of the compared expressions, so
+// 2 - 3 would be equal to 3 - 2, the keys are compared operand by
+// operand instead
+static bool same(const expr &a, const expr &b) {
+  struct pair {
+    const expr *a;
+    const expr *b;
+  };
+
+  work_stack<pair, 32> stack;
+
+  stack.push_back({&a, &b});
+
+  while (!stack.empty()) {
+    pair p = stack.back();
+
+    stack.pop_back();
+
+    const expr &u = *p.a;
+    const expr &v = *p.b;
+
+    if (u.kind_of != v.kind_of || u.expr_sym_id != v.expr_sym_id) {
+      return false;
+    }
+
+    if (u.kind_of == kind::INT) {
+      if (*u.expr_int != *v.expr_int) {
+        return false;
+      }
+
+      continue;
+    }
+
+    const operand_list &l = u.expr_childs;
+    const operand_list &r = v.expr_childs;
+
+    if (l.node == r.node) {
+      continue;
+    }
+
+    if (l.size() != r.size()) {
+      return false;
+    }
+
+    for (size_t i = 0; i < l.size(); i++) {
+      stack.push_back({&l[i], &r[i]});
+    }
+  }
+
+  return true;
+}
+
+bool memo_find(memo_op op, const expr &u, const expr *x, expr *r) {
+  if (limit.load(std::memory_order_relaxed) == 0 || !cacheable(u) ||
+      (x && !cacheable(*x))) {
+    return false;
+  }
+
+  size_t h = memo_hash(op, u, x);
+
+  memo_cache &c = cache();
+
+  std::lock_guard<std::mutex> guard(c.lock);
+
+  auto range = c.index.equal_range(h);
+
+  for (auto it = range.first; it != range.second; ++it) {
+    memo_entry &e = *it->second;
+
+    if (e.op != op || !same(e.key, u) || (x && !same(e.arg, *x))) {
+      continue;
+    }
+
+    c.entries.splice(c.entries.begin(), c.entries, it->second);
+
+    c.hits++;
+
+    *r = e.value;
+
+    return true;
+  }
+
+  c.misses++;
+
+  return false;
+}
+
+void memo_store(memo_op op, const expr &u, const expr *x, const expr &r) {
+  size_t max = limit.load(std::memory_order_relaxed);
+
+  if (max == 0 || !cacheable(u) || !cacheable(r) || (x && !cacheable(*x))) {
+    return;
+  }
+
+  // the entries outlive any arena
+  arena_suspend s;
+
+  memo_entry e;
+
+  e.op = op;
+  e.hash = memo_hash(op, u, x);
+
+  e.key = intern(u);
+  e.value = intern(r);
+
+  e.bytes = sizeof(memo_entry) + expr_bytes(e.key) + expr_bytes(e.value);
+
+  if (x) {
+    e.arg = intern(*x);
+    e.bytes += expr_bytes(e.arg);
+  }
+
+  if (e.bytes > max) {
+    return;
+  }
+
+  memo_cache &c = cache();
+
+  std::lock_guard<std::mutex> guard(c.lock);
+
+  auto range = c.index.equal_range(e.hash);
+
+  for (auto it = range.first; it != range.second; ++it) {
+    memo_entry &f = *it->second;
+
+    // another thread stored it first
+    if (f.op == op && same(f.key, u) && (!x || same(f.arg, *x))) {
+      return;
+    }
+  }
+
+  c.bytes += e.bytes;
+
+  c.entries.push_front(std::move(e));
+  c.index.insert(std::make_pair(c.entries.front().hash, c.entries.begin()));
+
+  c.shrink(max);
+}
+
+void memo_set_limit(size_t bytes) {
+  limit.store(bytes, std::memory_order_relaxed);
+
+  memo_cache &c = cache();
+
+  std::lock_guard<std::mutex> guard(c.lock);
+
+  c.shrink(bytes);
+}
+
+size_t memo_limit() { return limit.load(std::memory_order_relaxed); }
+
+void memo_set_thread_local(bool local) {
+  per_thread.store(local, std::memory_order_relaxed);
+}
+
+memo_stats memo_statistics() {
+  memo_cache &c = cache();
+
+  std::lock_guard<std::mutex> guard(c.lock);
+
+  memo_stats s;
+
+  s.hits = c.hits;
+  s.misses = c.misses;
+  s.entries = c.entries.size();
+  s.bytes = c.bytes;
+
+  return s;
+}
+
+void memo_clear() {
+  memo_cache &c = cache();
+
+  std::lock_guard<std::mutex> guard(c.lock);
+
+  c.shrink(0);
+
+  c.hits = 0;
+  c.misses = 0;
+}
+
+} // namespace alg
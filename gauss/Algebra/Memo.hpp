@@ -0,0 +1,52 @@
+#ifndef MEMO_HPP
+#define MEMO_HPP
+
+#include "Expression.hpp"
+
+#include <cstddef>
+
+namespace alg {
+
+// Memoization of the results of reduce, expand and calc::derivate. The
+// results are kept on a cache bounded by a number of bytes, the least
+// recently used ones are dropped first. The arguments are looked up by
+// their structural hash and compared operand by operand, without the
+// sorting of expr::operator==, the stored expressions are interned, so
+// copying a result out of the cache is O(1). The caches are safe to use
+// from many threads, by default all the threads share one, but every
+// thread can have its own instead. The caches are disabled until
+// memo_set_limit is called with a nonzero size.
+
+enum memo_op { MEMO_REDUCE, MEMO_EXPAND, MEMO_DERIVATE };
+
+struct memo_stats {
+  size_t hits;
+  size_t misses;
+  size_t entries;
+  size_t bytes;
+};
+
+// sets r to the result of op on u, and x for derivatives, returns false
+// if it is not on the cache
+bool memo_find(memo_op op, const expr &u, const expr *x, expr *r);
+
+// stores r as the result of op on u, and x for derivatives
+void memo_store(memo_op op, const expr &u, const expr *x, const expr &r);
+
+// maximum number of bytes of every cache, zero, the default, disables
+// the caches
+void memo_set_limit(size_t bytes);
+size_t memo_limit();
+
+// if true every thread uses its own cache, otherwise all of them share
+// the same one
+void memo_set_thread_local(bool local);
+
+// statistics and removal of the entries of the cache of the current
+// thread
+memo_stats memo_statistics();
+void memo_clear();
+
+} // namespace alg
+
+#endif
@@ -0,0 +1,291 @@
+#include "ModContext.hpp"
+
+#include "gauss/Error/error.hpp"
+
+#include <cassert>
+#include <climits>
+
+using bint_t = Int::bint_t;
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Montgomery reduction, returns t*2^-64 mod n for t < n*2^64
+static inline unsigned long long redc(uint128_t t, unsigned long long n,
+                                      unsigned long long ninv) {
+  unsigned long long m = (unsigned long long)t * ninv;
+
+  // t + m*n < 2^128 because n < 2^63
+  uint128_t u = (t + (uint128_t)m * n) >> 64;
+
+  return u >= n ? (unsigned long long)(u - n) : (unsigned long long)u;
+}
+#endif
+
+// outside of the class so pow is not the ModContext member
+static Int powerOfTwo(size_t e) {
+  return pow(Int(2), Int((unsigned long long)e));
+}
+
+ModContext::ModContext(const Int &m, bool symmetric)
+    : p(m), sym(symmetric), word(false), n(0), ninv(0), r2(0), k(0) {
+  if (p <= 1) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  p.to_long_if_small();
+
+  half = p / 2;
+
+#ifdef __SIZEOF_INT128__
+  if (!p.flag) {
+    word = true;
+
+    n = (unsigned long long)p.x;
+
+    if (n & 1) {
+      // Newton iteration for n^-1 mod 2^64, every step doubles
+      // the number of correct bits, starting from 3
+      unsigned long long inv = n;
+
+      for (int i = 0; i < 5; i++) {
+        inv *= 2 - n * inv;
+      }
+
+      ninv = -inv;
+
+      uint128_t r = ((uint128_t)1 << 64) % n;
+
+      r2 = (unsigned long long)(r * r % n);
+    }
+
+    return;
+  }
+#endif
+
+  // without 128 bits words the moduli that fit on a long
+  // long are reduced with divisions
+  if (!p.flag) {
+    return;
+  }
+
+  k = bint_t::bit_length(p.val);
+
+  mu = powerOfTwo(2 * k) / p;
+}
+
+unsigned long long ModContext::wordReduce(const Int &a) const {
+  if (!a.flag) {
+    if (a.x >= 0) {
+      unsigned long long u = a.x;
+
+      return u < n ? u : u % n;
+    }
+
+    unsigned long long u = -(unsigned long long)a.x;
+
+    u = u < n ? u : u % n;
+
+    return u ? n - u : 0;
+  }
+
+  Int r = a % p;
+
+  if (r < 0) {
+    r += p;
+  }
+
+  return (unsigned long long)r.longValue();
+}
+
+unsigned long long ModContext::wordMul(unsigned long long a,
+                                       unsigned long long b) const {
+#ifdef __SIZEOF_INT128__
+  if (ninv) {
+    // a*b*2^-64*2^128*2^-64 = a*b
+    return redc((uint128_t)redc((uint128_t)a * b, n, ninv) * r2, n, ninv);
+  }
+
+  return (unsigned long long)((uint128_t)a * b % n);
+#else
+  (void)a;
+  (void)b;
+
+  assert(false);
+
+  return 0;
+#endif
+}
+
+Int ModContext::wordLift(unsigned long long r) const {
+  if (sym && r > n / 2) {
+    return (long long)r - (long long)n;
+  }
+
+  return (long long)r;
+}
+
+Int ModContext::barrett(const Int &a) const {
+  if (!a.flag) {
+    // p >= 2^63 so |a| < p
+    return a.x < 0 ? p + a : a;
+  }
+
+  bint_t t, q;
+
+  // q = ((a >> (k - 1))*mu) >> (k + 1), see [2] Algorithm 14.42
+  bint_t::rshift_to(a.val, k - 1, &t);
+  bint_t::mul(&t, mu.val, &q);
+  bint_t::rshift_to(&q, k + 1, &t);
+
+  // the estimation is at most 2 units bigger than |a| / p
+  bint_t *r = a.val->copy();
+
+  r->sign = 1;
+
+  bint_t::submul(r, &t, p.val);
+
+  while (bint_t::compare(r, p.val) >= 0) {
+    bint_t::add_in_place(r, p.val, -1);
+  }
+
+  if (a.val->sign < 0 && r->size) {
+    bint_t::add_in_place(r, p.val, -1);
+
+    r->sign = -r->sign;
+  }
+
+  Int v = r;
+
+  v.to_long_if_small();
+
+  return v;
+}
+
+Int ModContext::lift(const Int &r) const {
+  if (sym && r > half) {
+    return r - p;
+  }
+
+  return r;
+}
+
+Int ModContext::reduce(const Int &a) const {
+  if (word) {
+    return wordLift(wordReduce(a));
+  }
+
+  if (k && (!a.flag || bint_t::bit_length(a.val) <= 2 * k)) {
+    return lift(barrett(a));
+  }
+
+  Int r = a % p;
+
+  if (r < 0) {
+    r += p;
+  }
+
+  return lift(r);
+}
+
+Int ModContext::add(const Int &a, const Int &b) const {
+  if (word) {
+    unsigned long long x = wordReduce(a);
+    unsigned long long y = wordReduce(b);
+
+    // x + y < 2^64 because n < 2^63
+    unsigned long long s = x + y;
+
+    return wordLift(s >= n ? s - n : s);
+  }
+
+  return reduce(a + b);
+}
+
+Int ModContext::sub(const Int &a, const Int &b) const {
+  if (word) {
+    unsigned long long x = wordReduce(a);
+    unsigned long long y = wordReduce(b);
+
+    return wordLift(x >= y ? x - y : x + (n - y));
+  }
+
+  return reduce(a - b);
+}
+
+Int ModContext::mul(const Int &a, const Int &b) const {
+  if (word) {
+    return wordLift(wordMul(wordReduce(a), wordReduce(b)));
+  }
+
+  return reduce(a * b);
+}
+
+Int ModContext::pow(const Int &a, Int e) const {
+  if (e < 0) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  if (word) {
+    unsigned long long b = wordReduce(a);
+    unsigned long long r = 1 % n;
+
+    while (e > 0) {
+      if (e % 2 == 1) {
+        r = wordMul(r, b);
+      }
+
+      b = wordMul(b, b);
+
+      e /= 2;
+    }
+
+    return wordLift(r);
+  }
+
+  return lift(powMod(a, e, p));
+}
+
+Int ModContext::inverse(const Int &a) const {
+  if (word) {
+    // extended euclid on words, the cofactors are bounded by n
+    long long r0 = (long long)n;
+    long long r1 = (long long)wordReduce(a);
+
+    long long s0 = 0;
+    long long s1 = 1;
+
+    while (r1) {
+      long long q = r0 / r1;
+      long long t;
+
+      t = r0 - q * r1;
+      r0 = r1;
+      r1 = t;
+
+      t = s0 - q * s1;
+      s0 = s1;
+      s1 = t;
+    }
+
+    if (r0 != 1) {
+      raise(error(ErrorCode::NUMBER_HAVE_NO_MODULAR_INVERSE, 0));
+    }
+
+    return wordLift(s0 < 0 ? (unsigned long long)(s0 + (long long)n) : s0);
+  }
+
+  Int s, t;
+
+  Int r = a % p;
+
+  if (r < 0) {
+    r += p;
+  }
+
+  if (xgcd(r, p, s, t) != 1) {
+    raise(error(ErrorCode::NUMBER_HAVE_NO_MODULAR_INVERSE, 0));
+  }
+
+  return reduce(s);
+}
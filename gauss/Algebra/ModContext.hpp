@@ -0,0 +1,71 @@
+#ifndef MOD_CONTEXT_HPP
+#define MOD_CONTEXT_HPP
+
+// References:
+// [1] Montgomery, Peter L. Modular multiplication without trial division
+// [2] Handbook of Applied Cryptography, chapter 14.3
+
+#include "Integer.hpp"
+
+// Arithmetic modulo a fixed p > 1, the constants used by the
+// reductions are computed once when the context is created, so it
+// should be reused by every operation with the same modulus.
+//
+// Moduli smaller than 2^63 are handled on machine words, odd ones
+// with Montgomery multiplication [1]. Bigger moduli, like the p^l
+// used by the Hensel lifting, use Barrett reduction [2].
+//
+// The results are in the symmetric range (-p/2, p/2] if the context
+// is symmetric, and in [0, p) otherwise. The arguments can be any
+// integers.
+class ModContext {
+public:
+  ModContext(const Int &p, bool symmetric = true);
+
+  const Int &modulus() const { return p; }
+
+  bool isSymmetric() const { return sym; }
+
+  // returns a mod p
+  Int reduce(const Int &a) const;
+
+  Int add(const Int &a, const Int &b) const;
+  Int sub(const Int &a, const Int &b) const;
+  Int mul(const Int &a, const Int &b) const;
+
+  // returns a^e mod p, e >= 0
+  Int pow(const Int &a, Int e) const;
+
+  // returns the inverse of a mod p, raises if gcd(a, p) != 1
+  Int inverse(const Int &a) const;
+
+  // convert a residue in [0, p) to the context representation
+  Int lift(const Int &r) const;
+
+private:
+  Int p;
+  Int half;
+
+  bool sym;
+
+  // true if the modulus fits on a word
+  bool word;
+
+  // word sized modulus, -n^-1 mod 2^64 and 2^128 mod n
+  unsigned long long n;
+  unsigned long long ninv;
+  unsigned long long r2;
+
+  // bit length of p and the Barrett constant 4^k/p
+  size_t k;
+  Int mu;
+
+  unsigned long long wordReduce(const Int &a) const;
+  unsigned long long wordMul(unsigned long long a, unsigned long long b) const;
+  Int wordLift(unsigned long long r) const;
+
+  // returns |a| mod p for |a| < p^2
+  Int barrett(const Int &a) const;
+};
+
+#endif
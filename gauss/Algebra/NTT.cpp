@@ -0,0 +1,351 @@
+#include "NTT.hpp"
+#include "gauss/Error/error.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ntt {
+
+montgomery::montgomery(uint32_t p) : p(p) {
+  // Newton iteration for p^-1 mod 2^32, p*p = 1 mod 8 so the
+  // initial value is correct in the first 3 bits and every
+  // iteration doubles the number of correct bits.
+  uint32_t inv = p;
+
+  for (int i = 0; i < 4; i++) {
+    inv *= 2 - p * inv;
+  }
+
+  pinv = -inv;
+
+  uint64_t r = ((uint64_t)1 << 32) % p;
+
+  r2 = (uint32_t)(r * r % p);
+}
+
+uint32_t powMod(uint32_t a, uint64_t e, uint32_t p) {
+  uint64_t r = 1 % p;
+  uint64_t b = a % p;
+
+  while (e) {
+    if (e & 1) {
+      r = r * b % p;
+    }
+
+    b = b * b % p;
+    e >>= 1;
+  }
+
+  return (uint32_t)r;
+}
+
+uint32_t primitiveRoot(uint32_t p) {
+  if (p == 2) {
+    return 1;
+  }
+
+  std::vector<uint32_t> f;
+
+  uint32_t n = p - 1;
+
+  for (uint32_t q = 2; (uint64_t)q * q <= n; q++) {
+    if (n % q == 0) {
+      f.push_back(q);
+
+      while (n % q == 0) {
+        n /= q;
+      }
+    }
+  }
+
+  if (n > 1) {
+    f.push_back(n);
+  }
+
+  for (uint32_t g = 2;; g++) {
+    bool root = true;
+
+    for (size_t i = 0; i < f.size() && root; i++) {
+      root = powMod(g, (p - 1) / f[i], p) != 1;
+    }
+
+    if (root) {
+      return g;
+    }
+  }
+}
+
+// Iterative radix 2 transform of a[0...n) modulo M.p using g as the
+// primitive root. The input is in the natural order and the twiddle
+// factors are kept in the montgomery form, so the coefficients never
+// need to be converted.
+static void transformDigits(uint32_t *a, size_t n, const montgomery &M,
+                            uint32_t g, bool inverse) {
+  uint32_t p = M.p;
+
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+
+    j ^= bit;
+
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+
+  std::vector<uint32_t> w(n / 2 + 1);
+
+  for (size_t len = 2; len <= n; len <<= 1) {
+    size_t h = len >> 1;
+
+    uint32_t wl = powMod(g, (p - 1) / len, p);
+
+    if (inverse) {
+      wl = powMod(wl, p - 2, p);
+    }
+
+    uint32_t wm = M.to(wl);
+
+    w[0] = M.to(1);
+
+    for (size_t j = 1; j < h; j++) {
+      w[j] = M.mul(w[j - 1], wm);
+    }
+
+    for (size_t i = 0; i < n; i += len) {
+      uint32_t *x = a + i;
+      uint32_t *y = a + i + h;
+
+      for (size_t j = 0; j < h; j++) {
+        uint32_t u = x[j];
+        uint32_t v = M.mul(y[j], w[j]);
+
+        x[j] = u + v >= p ? u + v - p : u + v;
+        y[j] = u >= v ? u - v : u + p - v;
+      }
+    }
+  }
+
+  if (inverse) {
+    uint32_t ni = M.to(powMod((uint32_t)(n % p), p - 2, p));
+
+    for (size_t i = 0; i < n; i++) {
+      a[i] = M.mul(a[i], ni);
+    }
+  }
+}
+
+// Cyclic convolution of a[0...n) and b[0...m) modulo p with a transform
+// of length l, the result is saved on r[0...l).
+static void convolveDigits(const uint32_t *a, size_t n, const uint32_t *b,
+                           size_t m, size_t l, uint32_t p, uint32_t g,
+                           std::vector<uint32_t> &r) {
+  montgomery M(p);
+
+  bool square = a == b && n == m;
+
+  r.assign(l, 0);
+
+  for (size_t i = 0; i < n; i++) {
+    r[i] = a[i] % p;
+  }
+
+  transformDigits(r.data(), l, M, g, false);
+
+  if (square) {
+    for (size_t i = 0; i < l; i++) {
+      r[i] = M.mul(M.mul(r[i], r[i]), M.r2);
+    }
+  } else {
+    std::vector<uint32_t> t(l, 0);
+
+    for (size_t i = 0; i < m; i++) {
+      t[i] = b[i] % p;
+    }
+
+    transformDigits(t.data(), l, M, g, false);
+
+    for (size_t i = 0; i < l; i++) {
+      r[i] = M.mul(M.mul(r[i], t[i]), M.r2);
+    }
+  }
+
+  transformDigits(r.data(), l, M, g, true);
+}
+
+static size_t transformLength(size_t s) {
+  size_t l = 1;
+
+  while (l < s) {
+    l <<= 1;
+  }
+
+  return l;
+}
+
+// Convolution of a[0...n) and b[0...m) over the primes P0, P1 and P2
+static void convolveThreePrimes(const uint32_t *a, size_t n, const uint32_t *b,
+                                size_t m, std::vector<uint32_t> r[3]) {
+  size_t l = transformLength(n + m - 1);
+
+  if (l > MAX_LENGTH) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  convolveDigits(a, n, b, m, l, P0, 3, r[0]);
+  convolveDigits(a, n, b, m, l, P1, 3, r[1]);
+  convolveDigits(a, n, b, m, l, P2, 3, r[2]);
+}
+
+// Garner's algorithm, recover the value x < P0*P1*P2 from its residues
+// modulo P0, P1 and P2 and save it on the 128 bits hi:lo.
+static inline void garner(uint32_t x0, uint32_t x1, uint32_t x2, uint64_t *lo,
+                          uint64_t *hi) {
+  // P0^-1 mod P1 and (P0*P1)^-1 mod P2
+  static const uint32_t i01 = powMod(P0 % P1, P1 - 2, P1);
+  static const uint32_t i012 =
+      powMod((uint32_t)((uint64_t)P0 * P1 % P2), P2 - 2, P2);
+
+  static const uint64_t P01 = (uint64_t)P0 * P1;
+
+  uint64_t k1 = (uint64_t)(x1 + P1 - x0 % P1) % P1 * i01 % P1;
+
+  // v = x0 + P0*k1 < P0*P1
+  uint64_t v = x0 + (uint64_t)P0 * k1;
+
+  uint64_t k2 = (x2 + P2 - v % P2) % P2 * i012 % P2;
+
+  // x = v + P0*P1*k2
+  uint64_t plo = (P01 & 0xffffffff) * k2;
+  uint64_t phi = (P01 >> 32) * k2;
+
+  uint64_t l = plo + (phi << 32);
+  uint64_t h = (phi >> 32) + (l < plo);
+
+  *lo = l + v;
+  *hi = h + (*lo < l);
+}
+
+void transform(std::vector<uint32_t> &a, uint32_t p, bool inverse) {
+  size_t n = a.size();
+
+  if (n == 0 || (n & (n - 1)) || p % 2 == 0 || p >= (1u << 31) ||
+      (p - 1) % n) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  montgomery M(p);
+
+  for (size_t i = 0; i < n; i++) {
+    a[i] %= p;
+  }
+
+  transformDigits(a.data(), n, M, primitiveRoot(p), inverse);
+}
+
+std::vector<uint32_t> convolution(const std::vector<uint32_t> &a,
+                                  const std::vector<uint32_t> &b, uint32_t p) {
+  if (a.empty() || b.empty()) {
+    return std::vector<uint32_t>();
+  }
+
+  if (p == 0 || p >= (1u << 31)) {
+    raise(error(ErrorCode::ARG_IS_INVALID, 0));
+  }
+
+  size_t s = a.size() + b.size() - 1;
+  size_t l = transformLength(s);
+
+  std::vector<uint32_t> r;
+
+  if (p % 2 == 1 && (p - 1) % l == 0) {
+    convolveDigits(a.data(), a.size(), b.data(), b.size(), l, p,
+                   primitiveRoot(p), r);
+
+    r.resize(s);
+
+    return r;
+  }
+
+  std::vector<uint32_t> t[3];
+
+  std::vector<uint32_t> x(a.size()), y(b.size());
+
+  for (size_t i = 0; i < a.size(); i++) {
+    x[i] = a[i] % p;
+  }
+
+  for (size_t i = 0; i < b.size(); i++) {
+    y[i] = b[i] % p;
+  }
+
+  convolveThreePrimes(x.data(), x.size(), y.data(), y.size(), t);
+
+  // 2^64 mod p
+  uint64_t e = ((uint64_t)1 << 32) % p;
+
+  e = e * e % p;
+
+  r.resize(s);
+
+  for (size_t i = 0; i < s; i++) {
+    uint64_t lo, hi;
+
+    garner(t[0][i], t[1][i], t[2][i], &lo, &hi);
+
+    r[i] = (uint32_t)(((hi % p) * e + lo % p) % p);
+  }
+
+  return r;
+}
+
+void multiply(const uint32_t *a, size_t n, const uint32_t *b, size_t m,
+              unsigned bits, uint32_t *z) {
+  assert(bits >= 1 && bits <= 31);
+
+  if (n == 0 || m == 0) {
+    std::fill(z, z + n + m, 0);
+    return;
+  }
+
+  std::vector<uint32_t> t[3];
+
+  convolveThreePrimes(a, n, b, m, t);
+
+  uint32_t mask = ((uint32_t)1 << bits) - 1;
+
+  // 128 bits carry
+  uint64_t clo = 0;
+  uint64_t chi = 0;
+
+  size_t s = n + m - 1;
+
+  for (size_t i = 0; i < s; i++) {
+    uint64_t lo, hi;
+
+    garner(t[0][i], t[1][i], t[2][i], &lo, &hi);
+
+    clo += lo;
+    chi += hi + (clo < lo);
+
+    z[i] = (uint32_t)clo & mask;
+
+    clo = (clo >> bits) | (chi << (64 - bits));
+    chi = chi >> bits;
+  }
+
+  for (size_t i = s; i < n + m; i++) {
+    z[i] = (uint32_t)clo & mask;
+
+    clo = (clo >> bits) | (chi << (64 - bits));
+    chi = chi >> bits;
+  }
+
+  assert(clo == 0 && chi == 0);
+}
+
+} // namespace ntt
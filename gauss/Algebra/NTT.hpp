@@ -0,0 +1,78 @@
+#ifndef NTT_HPP
+#define NTT_HPP
+
+// References:
+// [1] Modern Computer Arithmetic by Richard Brent and Paul Zimmermann
+// [2] Montgomery, Peter L. Modular multiplication without trial division
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ntt {
+
+// Primes of the form c*2^k + 1 used by the multi prime transforms,
+// all of them have 3 as a primitive root.
+const uint32_t P0 = 998244353; // 119*2^23 + 1
+const uint32_t P1 = 167772161; // 5*2^25 + 1
+const uint32_t P2 = 469762049; // 7*2^26 + 1
+
+// Maximum length of a transform over the three primes above
+const size_t MAX_LENGTH = (size_t)1 << 23;
+
+// Montgomery arithmetic modulo an odd p < 2^31 with R = 2^32
+struct montgomery {
+  uint32_t p;
+
+  // -p^-1 mod 2^32
+  uint32_t pinv;
+
+  // R^2 mod p
+  uint32_t r2;
+
+  montgomery(uint32_t p);
+
+  // returns t*R^-1 mod p, it is assumed that t < p*R
+  inline uint32_t reduce(uint64_t t) const {
+    uint32_t m = (uint32_t)t * pinv;
+    uint32_t u = (uint32_t)((t + (uint64_t)m * p) >> 32);
+    return u >= p ? u - p : u;
+  }
+
+  inline uint32_t mul(uint32_t a, uint32_t b) const {
+    return reduce((uint64_t)a * b);
+  }
+
+  // convert a to the montgomery form a*R mod p
+  inline uint32_t to(uint32_t a) const { return reduce((uint64_t)a * r2); }
+
+  // convert a from the montgomery form
+  inline uint32_t from(uint32_t a) const { return reduce(a); }
+};
+
+uint32_t powMod(uint32_t a, uint64_t e, uint32_t p);
+
+// returns the smallest primitive root of the prime p
+uint32_t primitiveRoot(uint32_t p);
+
+// In place number theoretic transform of a modulo the prime p, the size
+// of a needs to be a power of two that divides p - 1. The inverse
+// transform is already scaled by 1/a.size().
+void transform(std::vector<uint32_t> &a, uint32_t p, bool inverse = false);
+
+// Returns the coefficients of the product of the polynomials with
+// coefficients a and b modulo p, for any p < 2^31. If p can't
+// hold a transform of the needed length the convolution is computed
+// over the primes P0, P1, P2 and reduced modulo p.
+std::vector<uint32_t> convolution(const std::vector<uint32_t> &a,
+                                  const std::vector<uint32_t> &b, uint32_t p);
+
+// Exact product of the integers with digits a[0...n) and b[0...m) in
+// base 2^bits, with bits <= 31. The result is saved on z[0...n + m).
+// It is assumed that n + m <= MAX_LENGTH.
+void multiply(const uint32_t *a, size_t n, const uint32_t *b, size_t m,
+              unsigned bits, uint32_t *z);
+
+} // namespace ntt
+
+#endif
@@ -0,0 +1,223 @@
+#include "Rational.hpp"
+
+#include "gauss/Error/error.hpp"
+
+// |v| < 2^31 on a machine word
+static inline bool isWord(const Int &v) {
+  return !v.flag && v.x > -2147483648LL && v.x < 2147483648LL;
+}
+
+static inline unsigned long long gcdWord(unsigned long long a,
+                                         unsigned long long b) {
+  while (b) {
+    unsigned long long t = a % b;
+
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+Rational::Rational() : n(0), d(1), reduced(true) {}
+
+Rational::Rational(int v) : n(v), d(1), reduced(true) {}
+
+Rational::Rational(long long v) : n(v), d(1), reduced(true) {}
+
+Rational::Rational(const Int &v) : n(v), d(1), reduced(true) {}
+
+Rational::Rational(const Int &a, const Int &b) : n(a), d(b), reduced(false) {
+  if (d == 0) {
+    raise(error(ErrorCode::DIVISION_BY_ZERO, 0));
+  }
+
+  if (d < 0) {
+    n = -n;
+    d = -d;
+  }
+
+  reduced = d == 1;
+}
+
+Rational Rational::coprime(const Int &a, const Int &b) {
+  Rational r(a, b);
+
+  r.reduced = true;
+
+  return r;
+}
+
+Rational Rational::fromWords(long long a, long long b) {
+  if (b < 0) {
+    a = -a;
+    b = -b;
+  }
+
+  long long g = (long long)gcdWord(a < 0 ? -a : a, b);
+
+  Rational r;
+
+  r.n = a / g;
+  r.d = b / g;
+
+  return r;
+}
+
+bool Rational::isSmall() const { return isWord(n) && isWord(d); }
+
+void Rational::reduce() const {
+  if (reduced) {
+    return;
+  }
+
+  if (n == 0) {
+    d = 1;
+  } else {
+    Int g = abs(gcd(n, d));
+
+    if (g != 1) {
+      n /= g;
+      d /= g;
+    }
+  }
+
+  reduced = true;
+}
+
+const Int &Rational::num() const {
+  reduce();
+
+  return n;
+}
+
+const Int &Rational::den() const {
+  reduce();
+
+  return d;
+}
+
+bool Rational::isInteger() const { return den() == 1; }
+
+int Rational::sign() const { return n < 0 ? -1 : n > 0 ? 1 : 0; }
+
+Rational Rational::operator+(const Rational &b) const {
+  if (isSmall() && b.isSmall()) {
+    return fromWords(n.x * b.d.x + b.n.x * d.x, d.x * b.d.x);
+  }
+
+  Rational r;
+
+  if (d == b.d) {
+    r.n = n + b.n;
+    r.d = d;
+  } else {
+    r.n = n * b.d;
+
+    addmul(r.n, b.n, d);
+
+    r.d = d * b.d;
+  }
+
+  r.reduced = r.d == 1;
+
+  return r;
+}
+
+Rational Rational::operator-(const Rational &b) const { return *this + -b; }
+
+Rational Rational::operator*(const Rational &b) const {
+  if (isSmall() && b.isSmall()) {
+    return fromWords(n.x * b.n.x, d.x * b.d.x);
+  }
+
+  reduce();
+  b.reduce();
+
+  // (x/y)*(w/z) = ((x/g)*(w/h))/((y/h)*(z/g)) with g = gcd(x, z) and
+  // h = gcd(w, y) is in lowest terms if both operands are
+  Int g = abs(gcd(n, b.d));
+  Int h = abs(gcd(b.n, d));
+
+  Rational r;
+
+  if (g == 1 && h == 1) {
+    r.n = n * b.n;
+    r.d = d * b.d;
+  } else {
+    r.n = (n / g) * (b.n / h);
+    r.d = (d / h) * (b.d / g);
+  }
+
+  if (r.n == 0) {
+    r.d = 1;
+  }
+
+  return r;
+}
+
+Rational Rational::operator/(const Rational &b) const {
+  if (b.n == 0) {
+    raise(error(ErrorCode::DIVISION_BY_ZERO, 0));
+  }
+
+  b.reduce();
+
+  Rational inv;
+
+  inv.n = b.n < 0 ? -b.d : b.d;
+  inv.d = abs(b.n);
+
+  return *this * inv;
+}
+
+Rational Rational::operator-() const {
+  Rational r;
+
+  r.n = -n;
+  r.d = d;
+  r.reduced = reduced;
+
+  return r;
+}
+
+Rational &Rational::operator+=(const Rational &b) {
+  return *this = *this + b;
+}
+
+Rational &Rational::operator-=(const Rational &b) {
+  return *this = *this - b;
+}
+
+Rational &Rational::operator*=(const Rational &b) {
+  return *this = *this * b;
+}
+
+Rational &Rational::operator/=(const Rational &b) {
+  return *this = *this / b;
+}
+
+bool Rational::operator==(const Rational &b) const {
+  if (reduced && b.reduced) {
+    return n == b.n && d == b.d;
+  }
+
+  return n * b.d == b.n * d;
+}
+
+bool Rational::operator!=(const Rational &b) const { return !(*this == b); }
+
+// the denominators are positive, so the cross products keep the order
+bool Rational::operator<(const Rational &b) const {
+  return n * b.d < b.n * d;
+}
+
+bool Rational::operator<=(const Rational &b) const {
+  return n * b.d <= b.n * d;
+}
+
+bool Rational::operator>(const Rational &b) const { return b < *this; }
+
+bool Rational::operator>=(const Rational &b) const { return b <= *this; }
+
+Rational abs(const Rational &a) { return a.sign() < 0 ? -a : a; }
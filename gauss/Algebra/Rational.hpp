@@ -0,0 +1,78 @@
+#ifndef RATIONAL_HPP
+#define RATIONAL_HPP
+
+#include "Integer.hpp"
+
+// Rational number n/d with d > 0.
+//
+// When the numerators and denominators fit on 32 bits the operations
+// are done on machine words, and the results are always in lowest
+// terms. Otherwise the sums and differences are not reduced, the gcd
+// is only computed when the value is read with num() or den(), so a
+// sequence of operations pays for a single gcd. Products cancel the
+// common factors of the crossed terms, so they stay in lowest terms
+// if the operands are.
+class Rational {
+public:
+  Rational();
+  Rational(int n);
+  Rational(long long n);
+  Rational(const Int &n);
+
+  // raises DIVISION_BY_ZERO if d is zero
+  Rational(const Int &n, const Int &d);
+
+  // n/d for n and d without common factors, like the powers of the
+  // terms of a reduced rational, their gcd is not computed. Raises
+  // DIVISION_BY_ZERO if d is zero.
+  static Rational coprime(const Int &n, const Int &d);
+
+  // numerator and denominator in lowest terms, with den() > 0
+  const Int &num() const;
+  const Int &den() const;
+
+  bool isInteger() const;
+
+  // returns -1, 0 or 1
+  int sign() const;
+
+  Rational operator+(const Rational &b) const;
+  Rational operator-(const Rational &b) const;
+  Rational operator*(const Rational &b) const;
+
+  // raises DIVISION_BY_ZERO if b is zero
+  Rational operator/(const Rational &b) const;
+
+  Rational operator-() const;
+
+  Rational &operator+=(const Rational &b);
+  Rational &operator-=(const Rational &b);
+  Rational &operator*=(const Rational &b);
+  Rational &operator/=(const Rational &b);
+
+  bool operator==(const Rational &b) const;
+  bool operator!=(const Rational &b) const;
+  bool operator<(const Rational &b) const;
+  bool operator<=(const Rational &b) const;
+  bool operator>(const Rational &b) const;
+  bool operator>=(const Rational &b) const;
+
+  friend Rational abs(const Rational &a);
+
+private:
+  // the representation is reduced lazily, so the accessors are const
+  mutable Int n;
+  mutable Int d;
+
+  mutable bool reduced;
+
+  // true if both terms fit on 32 bits words
+  bool isSmall() const;
+
+  void reduce() const;
+
+  // n/d in lowest terms for |n|, |d| < 2^62 and d != 0
+  static Rational fromWords(long long n, long long d);
+};
+
+#endif
@@ -3,14 +3,24 @@
 #include "Utils.hpp"
 #include "Sorting.hpp"
 #include "Expression.hpp"
+#include "Memo.hpp"
 #include "gauss/Error/error.hpp"
+#include "gauss/Primes/Factor.hpp"
 #include <cstddef>
+#include <unordered_map>
+#include <vector>
 
 
 namespace alg {
 
 using namespace utils;
 
+// true if a is a fraction with a zero denominator, like the ones
+// reduce_pow builds for 0^-n, they have no rational value
+static inline bool is_zero_den(expr *a) {
+  return is(a, kind::FRAC) && get_val(operand(a, 1)) == 0;
+}
+
 // a = a + b
 inline void expr_set_inplace_add_consts(expr *a, expr *b) {
   assert(is(a, kind::CONST));
@@ -23,56 +33,11 @@ inline void expr_set_inplace_add_consts(expr *a, expr *b) {
     return expr_set_to_int(a, x + y);
   }
 
-  if (is(a, kind::FRAC) && is(b, kind::FRAC)) {
-    Int x = get_val(operand(a, 0));
-    Int y = get_val(operand(a, 1));
-    Int w = get_val(operand(b, 0));
-    Int z = get_val(operand(b, 1));
-
-    Int e = x * z + w * y;
-    Int k = y * z;
-
-    if (e % k == 0) {
-      return expr_set_to_int(a, e / k);
-    }
-
-    Int g = abs(gcd(e, k));
-
-    return expr_set_to_fra(a, e / g, k / g);
-  }
-
-  if (is(a, kind::FRAC) && is(b, kind::INT)) {
-    Int x = get_val(operand(a, 0));
-    Int y = get_val(operand(a, 1));
-    Int w = get_val(b);
-
-    Int e = x + w * y;
-    Int k = y;
-
-    if (e % k == 0) {
-      return expr_set_to_int(a, e / k);
-    }
-
-    Int g = abs(gcd(e, k));
-    return expr_set_to_fra(a, e / g, k / g);
+  if (is_zero_den(a) || is_zero_den(b)) {
+    return expr_set_to_undefined(a);
   }
 
-  if (is(b, kind::FRAC) && is(a, kind::INT)) {
-    Int x = get_val(operand(b, 0));
-    Int y = get_val(operand(b, 1));
-    Int w = get_val(a);
-
-    Int e = x + w * y;
-    Int k = y;
-
-    if (e % k == 0) {
-      return expr_set_to_int(a, e / k);
-    }
-
-    Int g = abs(gcd(e, k));
-
-    return expr_set_to_fra(a, e / g, k / g);
-  }
+  return expr_set_to_rational(a, get_rational(a) + get_rational(b));
 }
 
 inline void expr_set_inplace_add_consts(expr *a, Int b) {
@@ -84,23 +49,11 @@ inline void expr_set_inplace_add_consts(expr *a, Int b) {
     return expr_set_to_int(a, x + b);
   }
 
-  if (is(a, kind::FRAC)) {
-    Int x = get_val(operand(a, 0));
-    Int y = get_val(operand(a, 1));
-
-    Int e = x + b * y;
-
-    if (e == 0) {
-      return expr_set_to_int(a, 0);
-    }
-
-    if (e % y == 0) {
-      return expr_set_to_int(a, e / y);
-    }
-
-    Int g = abs(gcd(e, y));
-    return expr_set_to_fra(a, e / g, y / g);
+  if (is_zero_den(a)) {
+    return expr_set_to_undefined(a);
   }
+
+  return expr_set_to_rational(a, get_rational(a) + Rational(b));
 }
 
 inline void expr_set_op_inplace_add_consts(expr *a, size_t i, expr *b) {
@@ -128,66 +81,11 @@ inline void expr_set_inplace_mul_consts(expr *a, expr *b) {
     return expr_set_to_int(a, x * y);
   }
 
-  if (is(a, kind::FRAC) && is(b, kind::FRAC)) {
-    Int x = get_val(operand(a, 0));
-    Int y = get_val(operand(a, 1));
-    Int w = get_val(operand(b, 0));
-    Int z = get_val(operand(b, 1));
-
-    Int e = x * w;
-    Int k = y * z;
-
-    if (e == 0) {
-      return expr_set_to_int(a, 0);
-    }
-
-    if (e % k == 0) {
-      return expr_set_to_int(a, e / k);
-    }
-
-    Int g = abs(gcd(e, k));
-    return expr_set_to_fra(a, e / g, k / g);
-  }
-
-  if (is(a, kind::FRAC) && is(b, kind::INT)) {
-    Int x = get_val(operand(a, 0));
-    Int y = get_val(operand(a, 1));
-    Int w = get_val(b);
-
-    Int e = x * w;
-    Int k = y;
-
-    if (e == 0) {
-      return expr_set_to_int(a, 0);
-    }
-
-    if (e % k == 0) {
-      return expr_set_to_int(a, e / k);
-    }
-
-    Int g = abs(gcd(e, k));
-    return expr_set_to_fra(a, e / g, k / g);
+  if (is_zero_den(a) || is_zero_den(b)) {
+    return expr_set_to_undefined(a);
   }
 
-  if (is(b, kind::FRAC) && is(a, kind::INT)) {
-    Int x = get_val(operand(b, 0));
-    Int y = get_val(operand(b, 1));
-    Int w = get_val(a);
-
-    Int e = x * w;
-    Int k = y;
-
-    if (e == 0) {
-      return expr_set_to_int(a, 0);
-    }
-
-    if (e % k == 0) {
-      return expr_set_to_int(a, e / k);
-    }
-
-    Int g = abs(gcd(e, k));
-    return expr_set_to_fra(a, e / g, k / g);
-  }
+  return expr_set_to_rational(a, get_rational(a) * get_rational(b));
 }
 
 inline void expr_set_inplace_mul_consts(expr *a, Int b) {
@@ -199,19 +97,11 @@ inline void expr_set_inplace_mul_consts(expr *a, Int b) {
     return expr_set_to_int(a, x * b);
   }
 
-  if (is(a, kind::FRAC)) {
-    Int x = get_val(operand(a, 0));
-    Int y = get_val(operand(a, 1));
-
-    Int e = x * b;
-
-    if (e % y == 0) {
-      return expr_set_to_int(a, e / y);
-    }
-
-    Int g = abs(gcd(e, y));
-    return expr_set_to_fra(a, e / g, y / g);
+  if (is_zero_den(a)) {
+    return expr_set_to_undefined(a);
   }
+
+  return expr_set_to_rational(a, get_rational(a) * Rational(b));
 }
 
 inline void expr_set_op_inplace_mul_consts(expr *a, size_t i, expr *b) {
@@ -313,13 +203,25 @@ inline void expr_set_op_pow_add_to_deg(expr *a, size_t i, Int e) {
 inline void expr_set_op_to_pow(expr *a, size_t i, Int v) {
   set_to_unreduced(a);
 
-  a->expr_childs[i] = create(kind::POW, {*operand(a, i), integer(v)});
+  // the operand is moved, reduce_div calls this on unreduced trees
+  expr p = create(kind::POW);
+
+  p.insert(std::move(a->expr_childs[i]));
+  p.insert(integer(v));
+
+  a->expr_childs[i] = std::move(p);
 }
 
 inline void expr_set_op_to_pow(expr *a, size_t i, expr *v) {
   set_to_unreduced(a);
 
-  a->expr_childs[i] = create(kind::POW, {*operand(a, i), *v});
+  // the operand is moved, reduce_div calls this on unreduced trees
+  expr p = create(kind::POW);
+
+  p.insert(std::move(a->expr_childs[i]));
+  p.insert(*v);
+
+  a->expr_childs[i] = std::move(p);
 }
 inline bool eval_add_consts(expr *u, size_t i, expr *v, size_t j) {
 
@@ -342,20 +244,13 @@ inline bool eval_add_int(expr *a, Int b) {
 
   assert(is(a, kind::FRAC));
 
-  Int num = get_val(operand(a, 0));
-  Int den = get_val(operand(a, 1));
-
-  num = b * den + num;
-
-  Int cff = abs(gcd(num, den));
-
-  if (den / cff == 1) {
-    expr_set_to_int(a, num / cff);
+  if (is_zero_den(a)) {
+    expr_set_to_undefined(a);
 
     return true;
   }
 
-  expr_set_to_fra(a, num / cff, den / cff);
+  expr_set_to_rational(a, get_rational(a) + Rational(b));
 
   return true;
 }
@@ -433,7 +328,7 @@ inline bool eval_add_nconst(expr *u, size_t i, expr *v, size_t j) {
 			return false;
 		}
 
-		if(strcmp(get_func_id(a), get_func_id(b)) != 0) {
+		if(get_sym_id(a) != get_sym_id(b)) {
 			return false;
 		}
 
@@ -507,12 +402,16 @@ inline bool eval_add_nconst(expr *u, size_t i, expr *v, size_t j) {
 
       if (is(operand(a, 0), kind::INT) && get_val(operand(a, 0)) == 0) {
         expr_set_to_int(a, 0);
+      } else if (is(operand(a, 0), kind::UNDEF)) {
+        expr_set_to_undefined(a);
       }
     } else if (ka & kind::CONST) {
       expr_set_op_inplace_add_consts(a, 0, 1);
 
       if (is(operand(a, 0), kind::INT) && get_val(operand(a, 0)) == 0) {
         expr_set_to_int(a, 0);
+      } else if (is(operand(a, 0), kind::UNDEF)) {
+        expr_set_to_undefined(a);
       }
     } else {
       expr_set_to_mul(2, a);
@@ -554,6 +453,8 @@ inline bool eval_add_nconst(expr *u, size_t i, expr *v, size_t j) {
 
       if (is(operand(a, 0), kind::INT) && get_val(operand(a, 0)) == 0) {
         expr_set_to_int(a, 0);
+      } else if (is(operand(a, 0), kind::UNDEF)) {
+        expr_set_to_undefined(a);
       }
 
       return true;
@@ -585,6 +486,8 @@ inline bool eval_add_nconst(expr *u, size_t i, expr *v, size_t j) {
 
       if (is(operand(a, 0), kind::INT) && get_val(operand(a, 0)) == 0) {
         expr_set_to_int(a, 0);
+      } else if (is(operand(a, 0), kind::UNDEF)) {
+        expr_set_to_undefined(a);
       }
 
       return true;
@@ -737,7 +640,7 @@ inline bool eval_mul_nconst(expr *u, size_t i, expr *v, size_t j) {
 			return false;
 		}
 
-		if(strcmp(get_func_id(a), get_func_id(b)) != 0) {
+		if(get_sym_id(a) != get_sym_id(b)) {
 			return false;
 		}
 
@@ -1034,11 +937,312 @@ inline bool eval_mul_int(expr *u, size_t i, Int v) {
   return true;
 }
 
+// kinds that the neighbour merging of reduce_add and reduce_mul gives
+// special meanings
+static const int special_kinds = kind::INF | kind::UNDEF | kind::FAIL |
+                                 kind::MAT | kind::LIST | kind::SET;
+
+// true if a is a term or a factor whose like terms can be collected
+// by hash, that is, if nor a nor its operands have special kinds or
+// are fractions with a zero denominator, that have no rational value
+static bool collectable(expr *a) {
+  if (is(a, special_kinds) || is_zero_den(a)) {
+    return false;
+  }
+
+  if (is(a, kind::MUL | kind::POW)) {
+    for (size_t i = 0; i < size_of(a); i++) {
+      if (is(operand(a, i), special_kinds) || is_zero_den(operand(a, i))) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Terms of a sum with the same non constant part, or factors of a
+// product with the same base
+struct like_terms {
+  // non constant part or base
+  expr key;
+
+  size_t hash;
+
+  // the first term of the group, kept as it is if it has no like terms
+  expr first;
+
+  // sum of the coefficients or of the constant exponents
+  Rational value;
+
+  // sum of the exponents that are not constants
+  expr rest;
+
+  size_t count;
+
+  // next group with the same hash, -1 if none
+  long next;
+};
+
+struct like_table {
+  std::unordered_map<size_t, long> heads;
+  std::vector<like_terms> groups;
+
+  // small tables are searched linearly, the map is only built when
+  // they grow past this size
+  static const size_t linear = 16;
+
+  // group of key, created if there is none
+  like_terms &find(const expr &key) {
+    size_t h = structural_hash(key);
+
+    long g = -1;
+
+    if (groups.size() <= linear) {
+      for (size_t k = 0; k < groups.size(); k++) {
+        if (groups[k].hash == h && groups[k].key == key) {
+          return groups[k];
+        }
+      }
+    } else {
+      std::unordered_map<size_t, long>::iterator it = heads.find(h);
+
+      g = it == heads.end() ? -1 : it->second;
+
+      for (long k = g; k != -1; k = groups[k].next) {
+        if (groups[k].key == key) {
+          return groups[k];
+        }
+      }
+    }
+
+    groups.push_back(like_terms());
+
+    like_terms &t = groups.back();
+
+    t.key = key;
+    t.hash = h;
+    t.count = 0;
+    t.next = -1;
+
+    if (groups.size() == linear + 1) {
+      for (size_t k = 0; k < groups.size(); k++) {
+        std::unordered_map<size_t, long>::iterator it =
+            heads.find(groups[k].hash);
+
+        groups[k].next = it == heads.end() ? -1 : it->second;
+
+        heads[groups[k].hash] = (long)k;
+      }
+    } else if (groups.size() > linear + 1) {
+      t.next = g;
+
+      heads[h] = (long)groups.size() - 1;
+    }
+
+    return t;
+  }
+};
+
+// Adds the like terms of the sum a on a hash table keyed on their non
+// constant parts, so they are collected in linear time even when the
+// order of compare does not keep them next to each other. The terms
+// that can't be collected are left for the merging of neighbours.
+static void collect_add(expr *a) {
+  like_table T;
+
+  T.groups.reserve(size_of(a));
+
+  std::vector<expr> rest;
+
+  Rational c = 0;
+
+  bool has_c = false;
+
+  for (size_t i = 0; i < size_of(a); i++) {
+    expr *t = operand(a, i);
+
+    if (is(t, kind::ADD)) {
+      // the operands of a reduced sum are terms, they are added to a
+      expr u = std::move(*t);
+
+      for (size_t j = 0; j < size_of(&u); j++) {
+        a->insert(*operand(&u, j));
+      }
+
+      continue;
+    }
+
+    if (!collectable(t)) {
+      rest.push_back(*t);
+      continue;
+    }
+
+    if (is(t, kind::CONST)) {
+      c += get_rational(t);
+      has_c = true;
+      continue;
+    }
+
+    Rational k = 1;
+
+    expr m;
+
+    if (is(t, kind::MUL) && is(operand(t, 0), kind::CONST)) {
+      k = get_rational(operand(t, 0));
+
+      if (size_of(t) == 2) {
+        m = *operand(t, 1);
+      } else {
+        m = *t;
+        m.expr_childs.erase(0);
+      }
+    } else {
+      m = *t;
+    }
+
+    like_terms &g = T.find(m);
+
+    if (g.count++ == 0) {
+      g.first = *t;
+      g.value = k;
+    } else {
+      g.value += k;
+    }
+  }
+
+  for (size_t i = 0; i < T.groups.size(); i++) {
+    like_terms &g = T.groups[i];
+
+    if (g.count == 1) {
+      rest.push_back(std::move(g.first));
+      continue;
+    }
+
+    if (g.value == 0) {
+      continue;
+    }
+
+    if (g.value == 1) {
+      rest.push_back(std::move(g.key));
+    } else if (is(&g.key, kind::MUL)) {
+      g.key.insert(number(g.value), 0);
+      rest.push_back(std::move(g.key));
+    } else {
+      rest.push_back(create(kind::MUL, {number(g.value), g.key}));
+    }
+  }
+
+  if (has_c) {
+    rest.push_back(number(c));
+  }
+
+  a->expr_childs = std::move(rest);
+}
+
+// Multiplies the factors of the product a with the same base on a hash
+// table keyed on their bases, the constants are multiplied together. The
+// factors that can't be collected are left for the merging of neighbours.
+static void collect_mul(expr *a) {
+  like_table T;
+
+  T.groups.reserve(size_of(a));
+
+  std::vector<expr> rest;
+
+  Rational c = 1;
+
+  bool has_c = false;
+
+  for (size_t i = 0; i < size_of(a); i++) {
+    expr *t = operand(a, i);
+
+    if (is(t, kind::MUL)) {
+      // the operands of a reduced product are factors, they are added to a
+      expr u = std::move(*t);
+
+      for (size_t j = 0; j < size_of(&u); j++) {
+        a->insert(*operand(&u, j));
+      }
+
+      continue;
+    }
+
+    if (!collectable(t) || (is(t, kind::POW) && is(operand(t, 0), kind::CONST))) {
+      // powers of numbers are left to reduce_pow
+      rest.push_back(*t);
+      continue;
+    }
+
+    if (is(t, kind::CONST)) {
+      c *= get_rational(t);
+      has_c = true;
+      continue;
+    }
+
+    bool p = is(t, kind::POW);
+
+    like_terms &g = T.find(p ? *operand(t, 0) : *t);
+
+    expr *e = p ? operand(t, 1) : 0;
+
+    if (g.count++ == 0) {
+      g.first = *t;
+      g.value = 0;
+    }
+
+    if (!e) {
+      g.value += 1;
+    } else if (is(e, kind::CONST)) {
+      g.value += get_rational(e);
+    } else if (is(&g.rest, kind::ADD)) {
+      g.rest.insert(*e);
+    } else if (is(&g.rest, kind::UNDEF)) {
+      g.rest = *e;
+    } else {
+      g.rest = create(kind::ADD, {g.rest, *e});
+    }
+  }
+
+  for (size_t i = 0; i < T.groups.size(); i++) {
+    like_terms &g = T.groups[i];
+
+    if (g.count == 1) {
+      rest.push_back(std::move(g.first));
+      continue;
+    }
+
+    expr e = number(g.value);
+
+    if (!is(&g.rest, kind::UNDEF)) {
+      e = g.value == 0 ? g.rest : create(kind::ADD, {g.rest, e});
+    }
+
+    expr f = create(kind::POW, {g.key, e});
+
+    reduce(&f);
+
+    rest.push_back(std::move(f));
+  }
+
+  if (has_c) {
+    rest.push_back(number(c));
+  }
+
+  a->expr_childs = std::move(rest);
+}
+
 void reduce_add(expr *a) {
   for (size_t i = 0; i < size_of(a); i++) {
     reduce(operand(a, i));
   }
 
+  collect_add(a);
+
+  if (size_of(a) == 0) {
+    return expr_set_to_int(a, 0);
+  }
+
   sort_childs(a, 0, size_of(a) - 1);
 
   if (is(operand(a, 0), kind::ADD)) {
@@ -1147,6 +1351,11 @@ void reduce_add(expr *a) {
       a->remove(j);
     }
 
+    if (reduced && is(operand(a, j), kind::UNDEF)) {
+      // constants with a zero denominator fold to undefined
+      return expr_set_to_undefined(a);
+    }
+
     if (reduced == false) {
       j = i;
     }
@@ -1169,6 +1378,8 @@ void reduce_mul(expr *a) {
   for (size_t i = 0; i < size_of(a); i++) {
     reduce(operand(a, i));
   }
+
+  collect_mul(a);
   sort_childs(a, 0, size_of(a) - 1);
 
   size_t j = 0;
@@ -1329,6 +1540,58 @@ void reduce_sub(expr *a) {
 
 
 
+// b^(p/q) = s*r^(1/q), where s is rational and r is a positive integer
+// with no q'th powers, only done for positive bases of at most 128
+// bits, whose factors are cheap to find.
+void reduce_int_root(expr *a) {
+  Int b = get_val(operand(a, 0));
+  Int p = get_val(operand(operand(a, 1), 0));
+  Int q = get_val(operand(operand(a, 1), 1));
+
+  if (b < 2 || q < 2 || q > 128 || b.ceil_log2() > 128) {
+    return;
+  }
+
+  Int n = 1, d = 1, r = 1;
+
+  std::vector<std::pair<Int, unsigned long long>> f = factorInt(b);
+
+  for (size_t i = 0; i < f.size(); i++) {
+    // f^(e*p/q) = f^u*f^(v/q) with 0 <= v < q
+    Int t = Int(f[i].second) * p;
+
+    Int u = t / q;
+    Int v = t % q;
+
+    if (v < 0) {
+      u -= 1;
+      v += q;
+    }
+
+    if (u > 0) {
+      n *= pow(f[i].first, u);
+    } else if (u < 0) {
+      d *= pow(f[i].first, -u);
+    }
+
+    r *= pow(f[i].first, v);
+  }
+
+  if (n == 1 && d == 1) {
+    return;
+  }
+
+  expr t = fraction(n, d);
+
+  if (r != 1) {
+    t = create(kind::MUL, {t, create(kind::POW, {integer(r), fraction(1, q)})});
+  }
+
+  expr_replace_with(a, &t);
+
+  return reduce(a);
+}
+
 void reduce_pow(expr *a) {
   reduce(operand(a, 1));
   reduce(operand(a, 0));
@@ -1370,7 +1633,9 @@ void reduce_pow(expr *a) {
     return expr_set_to_undefined(a);
   }
 
-	if(is(operand(a, 0), kind::SYM) && strcmp(operand(a, 0)->expr_sym, "i") == 0) {
+	static const unsigned id_i = symbol_id("i");
+
+	if(is(operand(a, 0), kind::SYM) && get_sym_id(operand(a, 0)) == id_i) {
 		if(is(operand(a, 1), kind::INT)) {
 
 			Int d = get_val(operand(a, 1));
@@ -1407,6 +1672,10 @@ void reduce_pow(expr *a) {
     return reduce(a);
   }
 
+  if (is(operand(a, 0), kind::INT) && is(operand(a, 1), kind::FRAC)) {
+    return reduce_int_root(a);
+  }
+
   if (!is(operand(a, 1), kind::INT)) {
     return;
   }
@@ -1437,29 +1706,21 @@ void reduce_pow(expr *a) {
     return;
   }
 
+  if (is_zero_den(operand(a, 0))) {
+    return expr_set_to_undefined(a);
+  }
+
   if (is(operand(a, 0), kind::FRAC)) {
-    Int b = get_val(operand(operand(a, 0), 0));
-    Int c = get_val(operand(operand(a, 0), 1));
+    Rational b = get_rational(operand(a, 0));
 
     Int d = get_val(operand(a, 1));
 
-    bool n = d < 0;
-
-    d = abs(d);
-
-    b = pow(b, d);
-    c = pow(c, d);
+    Int n = pow(b.num(), abs(d));
+    Int k = pow(b.den(), abs(d));
 
-    Int g = gcd(b, c);
-
-    b = b / g;
-    c = c / g;
-
-    if (!n) {
-      expr_set_to_fra(a, b, c);
-    } else {
-      expr_set_to_fra(a, c, b);
-    }
+    // the powers of coprime terms are coprime
+    expr_set_to_rational(a, d < 0 ? Rational::coprime(k, n)
+                                  : Rational::coprime(n, k));
 
     return;
   }
@@ -1501,6 +1762,9 @@ void reduce_pow(expr *a) {
   }
 }
 
+// Rewrites the division a to a product, u/v is u*v^-1. It runs before
+// the operands of a are reduced, so the product is reduced as a whole
+// and u*v/v is u*v*v^-1 instead of u*v/0.
 void reduce_div(expr *a) {
   if ((is_inf(operand(a, 0)) || is_neg_inf(operand(a, 0))) &&
       (is_inf(operand(a, 1)) || is_neg_inf(operand(a, 1)))) {
@@ -1536,7 +1800,7 @@ void reduce_div(expr *a) {
 
         expr_set_to_mat(operand(a, 1), t);
 
-        return reduce(a);
+        return;
       }
     }
 
@@ -1562,8 +1826,6 @@ void reduce_div(expr *a) {
   expr_set_kind(a, kind::MUL);
 
   expr_set_op_to_pow(a, 1, -1);
-
-  return reduce(a);
 }
 
 void reduce_sqr(expr *a) {
@@ -1617,27 +1879,14 @@ expr *reduce_fra(expr *a) {
     return a;
   }
 
-  if (b % c == 0) {
-    expr_set_to_int(a, b / c);
-    return a;
-  }
-
-  Int d = abs(gcd(b, c));
+  expr_set_to_rational(a, Rational(b, c));
 
-  if (c / d == 1) {
-    expr_set_to_int(a, b / d);
-  } else {
-    expr_set_to_fra(a, b / d, c / d);
-  }
   return a;
 }
 
 
-void reduce(expr *a) {
-  if (is_reduced(a)) {
-    return;
-  }
-
+// reduces a, whose operands are reduced
+static void reduce_node(expr *a) {
   if (is(a, kind::LIST)) {
     for (size_t i = 0; i < size_of(a); i++) {
       reduce(&a->expr_list->members[i]);
@@ -1656,8 +1905,6 @@ void reduce(expr *a) {
     reduce_mul(a);
   } else if (is(a, kind::SUB)) {
     reduce_sub(a);
-  } else if (is(a, kind::DIV)) {
-    reduce_div(a);
   } else if (is(a, kind::POW)) {
     reduce_pow(a);
   } else if (is(a, kind::ROOT)) {
@@ -1669,11 +1916,52 @@ void reduce(expr *a) {
   set_to_reduced(a);
 }
 
+static long reduce_enter(expr *a) {
+  if (is_reduced(a)) {
+    return -1;
+  }
+
+  if (is(a, kind::DIV)) {
+    reduce_div(a);
+
+    // the product is reduced like any other, the values are final
+    return is(a, kind::MUL) && !is_reduced(a) ? 0 : -1;
+  }
+
+  return 0;
+}
+
+// the operands are reduced deepest first, so the recursive calls of the
+// reductions of every kind return at once and deep trees don't overflow
+// the stack
+void reduce(expr *a) {
+  if (is_reduced(a)) {
+    return;
+  }
+
+  post_order(a, reduce_enter, reduce_node);
+}
+
 
 expr reduce(expr a) {
-  reduce(&a);
+  if (is_reduced(&a) || is(&a, kind::TERMINAL)) {
+    reduce(&a);
+    return a;
+  }
 
-  return a;
+  expr r;
+
+  if (memo_find(MEMO_REDUCE, a, 0, &r)) {
+    return r;
+  }
+
+  r = a;
+
+  reduce(&r);
+
+  memo_store(MEMO_REDUCE, a, 0, r);
+
+  return r;
 }
 
 }
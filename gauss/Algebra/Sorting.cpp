@@ -2,6 +2,7 @@
 #include "Expression.hpp"
 #include "Utils.hpp"
 #include <cstddef>
+#include <vector>
 
 namespace alg {
 
@@ -9,11 +10,43 @@ using namespace utils;
 
 inline bool should_revert_idx(kind ctx) { return ctx & (kind::ADD); }
 
+// identifiers with the same id are equal, so the names are only
+// compared to order different identifiers
 inline int compare_idents(expr *a, expr *b) {
+  if (get_sym_id(a) == get_sym_id(b)) {
+    return 0;
+  }
+
   return strcmp(get_id(a), get_id(b));
 }
 
-inline int expr_op_cmp(expr *a, expr *b, kind ctx) {
+// Comparison of two operands that is still pending, or if a is null,
+// the result of the comparisons deferred before it when all of them
+// were equal. The comparisons are made in the reverse order they are
+// deferred, and the first one that is not equal decides the result.
+struct pending_cmp {
+  expr *a;
+  expr *b;
+  kind ctx;
+  int r;
+};
+
+typedef work_stack<pending_cmp, 32> cmp_stack;
+
+static inline int defer(cmp_stack &s, expr *a, expr *b, kind ctx) {
+  s.push_back({a, b, ctx, 0});
+  return 0;
+}
+
+static inline int defer_result(cmp_stack &s, int r) {
+  if (r) {
+    s.push_back({0, 0, kind::UNDEF, r});
+  }
+
+  return 0;
+}
+
+inline int expr_op_cmp(expr *a, expr *b, kind ctx, cmp_stack &s) {
   long m = size_of(a);
   long n = size_of(b);
 
@@ -24,45 +57,15 @@ inline int expr_op_cmp(expr *a, expr *b, kind ctx) {
 
   if (ctx == kind::ADD) {
     if (is(a, kind::MUL) && is(b, kind::MUL)) {
-      for (long i = 0; i < l; i++) {
-
-        int order = compare(operand(a, m - i), operand(b, n - i), ctx);
-        // printf("    %s -- %s ", to_string(operand(a, i + j)).c_str(),
-        // to_string(operand(b, i + k)).c_str()); printf("result in %i\n",
-        // order);
+      defer_result(s, n - m);
 
-        if (order) {
-          return order;
-        }
+      for (long i = l - 1; i >= 0; i--) {
+        defer(s, operand(a, m - i), operand(b, n - i), ctx);
       }
 
-      // 	short j = is(operand(a, 0), kind::CONST) ? 1 : 0;
-      // 	short k = is(operand(b, 0), kind::CONST) ? 1 : 0;
-
-      // 	short r = j & k;
-
-      // 	if ((size_of(a) - j) - (size_of(b) - k) != 0) {
-      //     return n - m;
-      //   }
-
-      // 	printf("cmp %s -- %s\n", to_string(a).c_str(),
-      // to_string(b).c_str());
-
-      // 	for (long i = 0; i < l - r; i++) {
-
-      // 		int order = compare(operand(a, i + j), operand(b, i +
-      // k),
-      // ctx); 			printf("    %s -- %s ", to_string(operand(a, i +
-      // j)).c_str(), to_string(operand(b, i + k)).c_str());
-      // printf("result in %i\n", order);
-
-      //     if (order) {
-
-      // 			return order;
-      // 		}
-      //   }
-      // }
+      return 0;
     }
+
     return n - m;
   }
 
@@ -74,26 +77,30 @@ inline int expr_op_cmp(expr *a, expr *b, kind ctx) {
         return order;
     }
 
-    for (long i = 0; i < l; i++) {
-      int order = compare(operand(a, m - i), operand(b, n - i), ctx);
+    defer_result(s, n - m);
 
-      if (order)
-        return order;
+    for (long i = l - 1; i >= 0; i--) {
+      defer(s, operand(a, m - i), operand(b, n - i), ctx);
     }
 
-    return n - m;
+    return 0;
   }
 
   if (size_of(a) != size_of(b)) {
     return (long)size_of(b) - (long)size_of(a);
   }
 
-  for (long i = 0; i < l; i++) {
-    int order = compare(operand(a, l - 1 - i), operand(b, l - 1 - i), ctx);
+  for (long i = l - 1; i >= 0; i--) {
+    defer(s, operand(a, l - 1 - i), operand(b, l - 1 - i), ctx);
+  }
 
-    if (order) {
-      return order;
-    }
+  return 0;
+}
+
+// defers the comparison of the operands of a and b from the first one
+static int defer_operands(cmp_stack &s, expr *a, expr *b, kind ctx) {
+  for (size_t i = size_of(a); i > 0; i--) {
+    defer(s, operand(a, i - 1), operand(b, i - 1), ctx);
   }
 
   return 0;
@@ -150,7 +157,9 @@ int compare_consts(expr *a, expr *b) {
   return na > ct ? 1 : -1;
 }
 
-int compare(expr *const a, expr *const b, kind ctx) {
+// compares a and b, or defers the comparisons of their operands to s
+static int compare_node(expr *const a, expr *const b, kind ctx,
+                        cmp_stack &s) {
   if (a == b) {
     return 0;
   }
@@ -169,7 +178,7 @@ int compare(expr *const a, expr *const b, kind ctx) {
     }
 
     if (is(a, kind::POW) && is(b, kind::POW)) {
-      return compare(operand(a, 0), operand(b, 0), ctx);
+      return defer(s, operand(a, 0), operand(b, 0), ctx);
     }
 
     if (is(a, kind::SYM | kind::ADD) && is(b, kind::POW)) {
@@ -193,7 +202,7 @@ int compare(expr *const a, expr *const b, kind ctx) {
     }
 
     if (is(a, kind::FUNC) && is(b, kind::FUNC)) {
-			int order = strcmp(get_func_id(a), get_func_id(b));
+			int order = compare_idents(a, b);
 
 			if(order) return order;
 
@@ -201,20 +210,15 @@ int compare(expr *const a, expr *const b, kind ctx) {
 
 			if(order) return order;
 
-			for(size_t i = 0; i < size_of(a); i++) {
-				order = compare(operand(a, i), operand(b, i), kind::MUL);
-				if(order) return order;
-			}
-
-			return 0;
+			return defer_operands(s, a, b, kind::MUL);
     }
 
     if (is(a, kind::POW) && is(b, kind::FUNC)) {
-      return compare(operand(a, 0), b, kind::MUL);
+      return defer(s, operand(a, 0), b, kind::MUL);
     }
 
     if (is(b, kind::POW) && is(a, kind::FUNC)) {
-      return compare(b, operand(a, 0), kind::MUL);
+      return defer(s, b, operand(a, 0), kind::MUL);
     }
 
     if (is(a, kind::MUL) && is(b, kind::POW | kind::SYM | kind::FUNC)) {
@@ -252,11 +256,11 @@ int compare(expr *const a, expr *const b, kind ctx) {
     }
 
     if (is(a, kind::ADD) && is(b, kind::ADD)) {
-      return expr_op_cmp(a, b, ctx);
+      return expr_op_cmp(a, b, ctx, s);
     }
 
     if (is(a, kind::MUL) && is(b, kind::MUL)) {
-      return expr_op_cmp(a, b, ctx);
+      return expr_op_cmp(a, b, ctx, s);
     }
 
     if (is(a, kind::LIST) && is(b, kind::LIST)) {
@@ -286,13 +290,8 @@ int compare(expr *const a, expr *const b, kind ctx) {
     }
 
     if (is(a, kind::POW) && is(b, kind::POW)) {
-      int i = compare(operand(a, 1), operand(b, 1), ctx);
-
-      if (i != 0) {
-        return i;
-      }
-
-      return compare(operand(a, 0), operand(b, 0), ctx);
+      defer(s, operand(a, 0), operand(b, 0), ctx);
+      return defer(s, operand(a, 1), operand(b, 1), ctx);
     }
 
     if (is(a, kind::POW) && is(b, kind::MUL)) {
@@ -315,7 +314,7 @@ int compare(expr *const a, expr *const b, kind ctx) {
     }
 
 		if (is(a, kind::FUNC) && is(b, kind::FUNC)) {
-			int order = strcmp(get_func_id(a), get_func_id(b));
+			int order = compare_idents(a, b);
 
 			if(order) return order;
 
@@ -323,12 +322,7 @@ int compare(expr *const a, expr *const b, kind ctx) {
 
 			if(order) return order;
 
-			for(size_t i = 0; i < size_of(a); i++) {
-				order = compare(operand(a, i), operand(b, i), kind::MUL);
-				if(order) return order;
-			}
-
-			return 0;
+			return defer_operands(s, a, b, kind::MUL);
     }
 
     if (is(a, kind::ADD) && is(b, kind::SYM)) {
@@ -404,11 +398,11 @@ int compare(expr *const a, expr *const b, kind ctx) {
     }
 
     if (is(a, kind::ADD) && is(b, kind::ADD)) {
-      return expr_op_cmp(a, b, ctx);
+      return expr_op_cmp(a, b, ctx, s);
     }
 
     if (is(a, kind::MUL) && is(b, kind::MUL)) {
-      return expr_op_cmp(a, b, ctx);
+      return expr_op_cmp(a, b, ctx, s);
     }
 
     if (is(a, kind::LIST) && is(b, kind::LIST)) {
@@ -433,7 +427,19 @@ int compare(expr *const a, expr *const b, kind ctx) {
   }
 
   if (is(a, kind::FUNC) && is(b, kind::FUNC)) {
-    return strcmp(get_func_id(a), get_func_id(b));
+    int order = compare_idents(a, b);
+
+    if (order) {
+      return order;
+    }
+
+    order = size_of(a) - size_of(b);
+
+    if (order) {
+      return order;
+    }
+
+    return defer_operands(s, a, b, ctx);
   }
 
   if (is(a, kind::CONST) && is(b, kind::CONST)) {
@@ -445,43 +451,24 @@ int compare(expr *const a, expr *const b, kind ctx) {
   }
 
   if (is(a, kind::ADD) && is(b, kind::ADD)) {
-    return expr_op_cmp(a, b, ctx);
+    return expr_op_cmp(a, b, ctx, s);
   }
 
   if (is(a, kind::MUL) && is(b, kind::MUL)) {
-    return expr_op_cmp(a, b, ctx);
-  }
-
-  if (is(a, kind::POW) && is(b, kind::POW)) {
-    int cmp = compare(operand(a, 0), operand(b, 0), ctx);
-
-    if (cmp != 0) {
-      return cmp;
-    }
-
-    return compare(operand(a, 1), operand(b, 1), ctx);
+    return expr_op_cmp(a, b, ctx, s);
   }
 
-  if (is(a, kind::DIV) && is(b, kind::DIV)) {
-    int cmp = compare(operand(a, 0), operand(b, 0), ctx);
-
-    if (cmp != 0) {
-      return cmp;
-    }
-
-    return compare(operand(a, 1), operand(b, 1), ctx);
+  if (is(a, kind::POW | kind::DIV) && kind_of(a) == kind_of(b)) {
+    return defer_operands(s, a, b, ctx);
   }
 
   if (is(a, kind::ROOT) && is(b, kind::ROOT)) {
-		int r = compare(operand(a, 1), operand(b, 1), ctx);
-
-		if(r != 0) return r;
-
-		return compare(operand(a, 0), operand(b, 0), ctx);
+    defer(s, operand(a, 0), operand(b, 0), ctx);
+    return defer(s, operand(a, 1), operand(b, 1), ctx);
   }
 
   if (is(a, kind::FACT) && is(b, kind::FACT)) {
-    return compare(operand(a, 0), operand(b, 0), ctx);
+    return defer(s, operand(a, 0), operand(b, 0), ctx);
   }
 
   if (is(a, kind::LIST) && is(b, kind::LIST)) {
@@ -489,12 +476,8 @@ int compare(expr *const a, expr *const b, kind ctx) {
       return (long)size_of(a) - (long)size_of(b);
     }
 
-    for (size_t i = 0; i < size_of(a); i++) {
-      int order =
-          compare(&a->expr_list->members[i], &b->expr_list->members[i], ctx);
-      if (order != 0) {
-        return order;
-      }
+    for (size_t i = size_of(a); i > 0; i--) {
+      defer(s, &a->expr_list->members[i - 1], &b->expr_list->members[i - 1], ctx);
     }
 
     return 0;
@@ -505,12 +488,8 @@ int compare(expr *const a, expr *const b, kind ctx) {
       return (long)size_of(a) - (long)size_of(b);
     }
 
-    for (size_t i = 0; i < size_of(a); i++) {
-      int order =
-          compare(&a->expr_set->members[i], &b->expr_set->members[i], ctx);
-      if (order != 0) {
-        return order;
-      }
+    for (size_t i = size_of(a); i > 0; i--) {
+      defer(s, &a->expr_set->members[i - 1], &b->expr_set->members[i - 1], ctx);
     }
 
     return 0;
@@ -519,130 +498,207 @@ int compare(expr *const a, expr *const b, kind ctx) {
   return should_revert_idx(ctx) ? kind_of(a) - kind_of(b)
                                 : kind_of(b) - kind_of(a);
 }
+// the comparisons of the operands are made from a stack on the heap, so
+// deep trees don't overflow the stack of the thread
+int compare(expr *const a, expr *const b, kind ctx) {
+  cmp_stack pending;
+
+  int r = compare_node(a, b, ctx, pending);
+
+  while (r == 0 && !pending.empty()) {
+    pending_cmp p = pending.back();
+
+    pending.pop_back();
+
+    r = p.a ? compare_node(p.a, p.b, p.ctx, pending) : p.r;
+  }
+
+  return r;
+}
+
 // int compare(expr *const a, expr *const b, kind ctx) {
 // 	int t = compare_rec(a, b, ctx);
 // 	if(t == 0) return t;
 // 	return t <  0 ? -1 : 1;
 // }
-long int sort_split(expr *a, long l, long r) {
-  long int i = l - 1;
-
-  expr *p = operand(a, r);
-
-  for (long int j = l; j < r; j++) {
-    if (compare(operand(a, j), p, kind_of(a)) < 0) {
-      std::swap(a->expr_childs[++i], a->expr_childs[j]);
-    }
+// Rank of an operand that agrees with compare, operands with different
+// ranks are ordered by their ranks, and only the ones with equal ranks
+// need a full comparison. On sums and products compare places the
+// constants after and before every other operand, on other contexts it
+// orders operands of different kinds by their kinds, except integers
+// and fractions that are compared by their values.
+static inline long sort_rank(expr *a, kind ctx) {
+  if (ctx & kind::MUL) {
+    return is(a, kind::CONST) ? 0 : 1;
   }
 
-  std::swap(a->expr_childs[++i], a->expr_childs[r]);
+  if (ctx & kind::ADD) {
+    return is(a, kind::CONST) ? 1 : 0;
+  }
 
-  return i;
+  return is(a, kind::CONST) ? -(long)kind::INT : -(long)kind_of(a);
 }
 
-void sort_childs(expr *a, long int l, long int r) {
-  if (l < r) {
+struct sort_keys {
+  expr *e;
+  kind ctx;
 
-    long int m = sort_split(a, l, r);
+  std::vector<long> rank;
 
-    sort_childs(a, l, m - 1);
-    sort_childs(a, m + 1, r);
-  }
-}
+  inline bool less(size_t i, size_t j) const {
+    if (rank[i] != rank[j]) {
+      return rank[i] < rank[j];
+    }
 
-void sort(expr *a) {
-  if (is(a, kind::TERMINAL)) {
-    return;
+    return compare(e + i, e + j, ctx) < 0;
   }
+};
 
-  enum kind k = is(a, kind::ADD | kind::MUL) ? kind_of(a) : kind::UNDEF;
+// stable merge sort of the indexes p[l, r), runs that are already in
+// order are not merged, so sorted inputs take linear time
+static void merge_sort(const sort_keys &k, size_t *p, size_t *t, size_t l,
+                       size_t r) {
+  if (r - l <= 8) {
+    for (size_t i = l + 1; i < r; i++) {
+      size_t v = p[i];
+      size_t j = i;
+
+      while (j > l && k.less(v, p[j - 1])) {
+        p[j] = p[j - 1];
+        j--;
+      }
+
+      p[j] = v;
+    }
 
-  // NOTE: this may be causing bugs
-  if (is_sorted(a, k)) {
     return;
   }
 
-  set_to_sorted(a, k);
+  size_t m = l + (r - l) / 2;
 
-  if (is(a, kind::LIST)) {
-    for (size_t i = 0; i < size_of(a); i++) {
-      sort(&a->expr_list->members[i]);
-    }
+  merge_sort(k, p, t, l, m);
+  merge_sort(k, p, t, m, r);
 
+  if (!k.less(p[m], p[m - 1])) {
     return;
   }
 
-  if (is(a, kind::SET)) {
-    return a->expr_set->sort();
+  size_t i = l, j = m, o = l;
+
+  while (i < m && j < r) {
+    t[o++] = k.less(p[j], p[i]) ? p[j++] : p[i++];
   }
 
-  size_t i = is(a, kind::SUB) ? 1 : 0;
+  while (i < m) {
+    t[o++] = p[i++];
+  }
 
-  for (; i < size_of(a); i++) {
-    sort(operand(a, i));
+  while (j < r) {
+    t[o++] = p[j++];
   }
 
-  if (is(a, kind::ORDERED)) {
+  for (o = l; o < r; o++) {
+    p[o] = t[o];
+  }
+}
+
+void sort_range(expr *e, size_t n, kind ctx) {
+  if (n < 2) {
     return;
   }
 
-  sort_childs(a, 0, size_of(a) - 1);
-}
+  sort_keys k;
+
+  k.e = e;
+  k.ctx = ctx;
+  k.rank.resize(n);
 
-long int sort_split(expr *a, kind k, long l, long r) {
-  long int i = l - 1;
+  for (size_t i = 0; i < n; i++) {
+    k.rank[i] = sort_rank(e + i, ctx);
+  }
 
-  expr *p = operand(a, r);
+  std::vector<size_t> p(n), t(n);
 
-  for (long int j = l; j < r; j++) {
-    if (compare(operand(a, j), p, k) < 0) {
-      std::swap(a->expr_childs[++i], a->expr_childs[j]);
-    }
+  for (size_t i = 0; i < n; i++) {
+    p[i] = i;
+  }
+
+  merge_sort(k, p.data(), t.data(), 0, n);
+
+  size_t i = 0;
+
+  while (i < n && p[i] == i) {
+    i++;
+  }
+
+  if (i == n) {
+    return;
   }
 
-  std::swap(a->expr_childs[++i], a->expr_childs[r]);
+  std::vector<expr> v;
 
-  return i;
+  v.reserve(n);
+
+  for (i = 0; i < n; i++) {
+    v.push_back(std::move(e[p[i]]));
+  }
+
+  for (i = 0; i < n; i++) {
+    e[i] = std::move(v[i]);
+  }
 }
 
 void sort_childs(expr *a, kind k, long int l, long int r) {
   if (l < r) {
-    long int m = sort_split(a, k, l, r);
-
-    sort_childs(a, k, l, m - 1);
-    sort_childs(a, k, m + 1, r);
+    sort_range(operand(a, l), r - l + 1, k);
   }
 }
 
-void sort(expr *a, kind k) {
+void sort_childs(expr *a, long int l, long int r) {
+  sort_childs(a, kind_of(a), l, r);
+}
+
+// returns the index of the first operand of a that should be sorted
+// before a, or -1 if a is sorted on the context k. The members of lists
+// and sets are sorted on k if it is the context of the whole tree.
+static long sort_enter(expr *a, kind k, bool whole) {
   if (is(a, kind::TERMINAL)) {
-    return;
+    return -1;
   }
 
+  // NOTE: this may be causing bugs
   if (is_sorted(a, k)) {
-    return;
+    return -1;
   }
 
   set_to_sorted(a, k);
 
   if (is(a, kind::LIST)) {
     for (size_t i = 0; i < size_of(a); i++) {
-      sort(&a->expr_list->members[i], k);
+      if (whole) {
+        sort(&a->expr_list->members[i], k);
+      } else {
+        sort(&a->expr_list->members[i]);
+      }
     }
 
-    return;
+    return -1;
   }
 
   if (is(a, kind::SET)) {
-    return a->expr_set->sort(k);
-  }
-
-  size_t i = is(a, kind::SUB) ? 1 : 0;
+    if (whole) {
+      a->expr_set->sort(k);
+    } else {
+      a->expr_set->sort();
+    }
 
-  for (; i < size_of(a); i++) {
-    sort(operand(a, i), k);
+    return -1;
   }
 
+  return is(a, kind::SUB) ? 1 : 0;
+}
+
+static void sort_leave(expr *a, kind k) {
   if (is(a, kind::ORDERED)) {
     return;
   }
@@ -650,4 +706,22 @@ void sort(expr *a, kind k) {
   sort_childs(a, k, 0, size_of(a) - 1);
 }
 
+static inline kind sort_context(expr *a) {
+  return is(a, kind::ADD | kind::MUL) ? kind_of(a) : kind::UNDEF;
+}
+
+// the operands are sorted deepest first with a stack on the heap, so
+// deep trees don't overflow the stack
+void sort(expr *a) {
+  post_order(
+      a, [](expr *u) { return sort_enter(u, sort_context(u), false); },
+      [](expr *u) { sort_leave(u, sort_context(u)); });
+}
+
+void sort(expr *a, kind k) {
+  post_order(
+      a, [k](expr *u) { return sort_enter(u, k, true); },
+      [k](expr *u) { sort_leave(u, k); });
+}
+
 }
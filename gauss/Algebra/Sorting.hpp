@@ -9,6 +9,16 @@ int compare(expr *const a, expr *const b, kind ctx);
 
 void sort(expr *a, kind k);
 
+// Stable sort of the n expressions starting at e with the order given
+// by compare on the context ctx, takes O(n log n) comparisons and only
+// O(n) on inputs that are already sorted.
+//
+// compare is not a strict weak order on sums, so like terms may not be
+// next to each other after sorting. reduce_add and reduce_mul gather
+// them with collect_add and collect_mul before sorting, and don't rely
+// on this order to find them.
+void sort_range(expr *e, size_t n, kind ctx);
+
 void sort_childs(expr *a, kind k, long int l, long int r);
 
 void sort_childs(expr *a, long int l, long int r);
@@ -0,0 +1,67 @@
+#include "SymbolTable.hpp"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace alg {
+
+struct symbol_table {
+  std::mutex lock;
+
+  // the strings of a deque never move, so their contents can be
+  // referenced by the expressions
+  std::deque<std::string> names;
+
+  std::unordered_map<std::string, unsigned> ids;
+};
+
+// the table is never destroyed, since expressions with static storage
+// may still reference its names when the program exits
+static symbol_table &table() {
+  static symbol_table *t = new symbol_table();
+
+  return *t;
+}
+
+unsigned symbol_id(const char *name, const char **interned) {
+  symbol_table &t = table();
+
+  std::lock_guard<std::mutex> guard(t.lock);
+
+  std::unordered_map<std::string, unsigned>::iterator it = t.ids.find(name);
+
+  if (it == t.ids.end()) {
+    t.names.push_back(name);
+
+    it = t.ids.insert(std::make_pair(t.names.back(), t.names.size() - 1)).first;
+  }
+
+  if (interned) {
+    *interned = t.names[it->second].c_str();
+  }
+
+  return it->second;
+}
+
+const char *symbol_name(unsigned id) {
+  symbol_table &t = table();
+
+  std::lock_guard<std::mutex> guard(t.lock);
+
+  assert(id < t.names.size());
+
+  return t.names[id].c_str();
+}
+
+unsigned symbol_count() {
+  symbol_table &t = table();
+
+  std::lock_guard<std::mutex> guard(t.lock);
+
+  return t.names.size();
+}
+
+} // namespace alg
@@ -0,0 +1,24 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+namespace alg {
+
+// Identifiers of the symbols and functions. Every identifier is stored
+// once, with a small integer id, and both the id and the stored name
+// are valid until the end of the program, so the expressions keep them
+// instead of a copy of the name. The table is safe to use from many
+// threads.
+
+// returns the id of name, adding it to the table if needed, and sets
+// interned to the stored name if it is not null
+unsigned symbol_id(const char *name, const char **interned = 0);
+
+// name of an id returned by symbol_id
+const char *symbol_name(unsigned id);
+
+// number of identifiers on the table
+unsigned symbol_count();
+
+} // namespace alg
+
+#endif
@@ -63,13 +63,8 @@ bool is_negative(expr *a) {
 void set_to_expanded(expr *a) { a->expr_info |= info::EXPANDED; }
 
 void expr_set_kind(expr *a, kind kind) {
-  if (is(a, kind::SYM | kind::FUNC)) {
-    free(a->expr_sym);
-    a->expr_sym = 0;
-  }
-
   if (is(a, kind::INT)) {
-    delete a->expr_int;
+    arena_delete(a->expr_int);
     a->expr_int = 0;
   }
 
@@ -92,11 +87,17 @@ void expr_set_kind(expr *a, kind kind) {
 }
 
 void expr_set_to_int(expr *a, Int v) {
+  if (is(a, kind::INT)) {
+    *a->expr_int = v;
+
+    return;
+  }
+
   expr_set_kind(a, kind::INT);
 
   a->expr_childs.clear();
 
-  a->expr_int = new Int(v);
+  a->expr_int = arena_new<Int>(v);
 }
 
 void expr_set_to_mat(expr *a, matrix *v) {
@@ -125,6 +126,23 @@ void expr_set_to_fra(expr *a, Int u, Int v) {
   set_to_unreduced(a);
 }
 
+void expr_set_to_rational(expr *a, const Rational &v) {
+  if (v.isInteger()) {
+    return expr_set_to_int(a, v.num());
+  }
+
+  if (is(a, kind::FRAC) && is(operand(a, 0), kind::INT) &&
+      is(operand(a, 1), kind::INT)) {
+    // the nodes of the terms are reused
+    *operand(a, 0)->expr_int = v.num();
+    *operand(a, 1)->expr_int = v.den();
+
+    return set_to_unreduced(a);
+  }
+
+  expr_set_to_fra(a, v.num(), v.den());
+}
+
 void expr_set_op_to_fra(expr *a, size_t i, Int u, Int v) {
   expr_set_to_fra(operand(a, i), u, v);
 
@@ -134,7 +152,7 @@ void expr_set_op_to_fra(expr *a, size_t i, Int u, Int v) {
 void expr_set_to_sym(expr *a, const char *s) {
   expr_set_kind(a, kind::SYM);
 
-  a->expr_sym = strdup(s);
+  a->expr_sym_id = symbol_id(s, &a->expr_sym);
 
   set_to_reduced(a);
 }
@@ -206,8 +224,9 @@ bool expr_raise_to_first_op(expr *a) {
   if (is(operand(a, 0), kind::FUNC)) {
     a->expr_info = operand(a, 0)->expr_info;
 
-    a->expr_sym = strdup(get_id(operand(a, 0)));
     expr_set_kind(a, kind::FUNC);
+    a->expr_sym = get_id(operand(a, 0));
+    a->expr_sym_id = get_sym_id(operand(a, 0));
     a->expr_childs = expr(a->expr_childs[0]).expr_childs;
     return true;
   }
@@ -260,7 +279,8 @@ bool expr_replace_with(expr *a, expr *t) {
   if (is(t, kind::FUNC)) {
     expr_set_kind(a, kind::FUNC);
 
-    a->expr_sym = strdup(get_id(t));
+    a->expr_sym = get_id(t);
+    a->expr_sym_id = get_sym_id(t);
 
     a->expr_childs = std::vector<expr>();
 
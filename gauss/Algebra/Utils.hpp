@@ -23,6 +23,7 @@ void expr_set_to_int(expr *a, Int v);
 void expr_set_to_mat(expr *a, matrix *v);
 void expr_set_op_to_int(expr *a, size_t i, Int v);
 void expr_set_to_fra(expr *a, Int u, Int v);
+void expr_set_to_rational(expr *a, const Rational &v);
 void expr_set_op_to_fra(expr *a, size_t i, Int u, Int v);
 void expr_set_to_sym(expr *a, const char *s);
 void expr_set_op_to_sym(expr *a, size_t i, const char *s);
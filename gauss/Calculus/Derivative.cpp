@@ -1,6 +1,7 @@
 
 #include "Derivative.hpp"
 #include "gauss/Algebra/Expression.hpp"
+#include "gauss/Algebra/Memo.hpp"
 #include "gauss/Algebra/Reduction.hpp"
 #include "gauss/Algebra/Trigonometry.hpp"
 
@@ -9,6 +10,32 @@ using namespace trig;
 
 namespace calc {
 
+// ids of the functions with known derivatives
+static const unsigned id_sin = symbol_id("sin");
+static const unsigned id_cos = symbol_id("cos");
+static const unsigned id_tan = symbol_id("tan");
+static const unsigned id_cot = symbol_id("cot");
+static const unsigned id_sec = symbol_id("sec");
+static const unsigned id_csc = symbol_id("csc");
+static const unsigned id_abs = symbol_id("abs");
+static const unsigned id_ln = symbol_id("ln");
+static const unsigned id_log = symbol_id("log");
+static const unsigned id_exp = symbol_id("exp");
+static const unsigned id_sinh = symbol_id("sinh");
+static const unsigned id_cosh = symbol_id("cosh");
+static const unsigned id_tanh = symbol_id("tanh");
+static const unsigned id_coth = symbol_id("coth");
+static const unsigned id_sech = symbol_id("sech");
+static const unsigned id_csch = symbol_id("csch");
+static const unsigned id_arcsin = symbol_id("arcsin");
+static const unsigned id_arccos = symbol_id("arccos");
+static const unsigned id_arctan = symbol_id("arctan");
+static const unsigned id_arccot = symbol_id("arccot");
+static const unsigned id_arcsec = symbol_id("arcsec");
+static const unsigned id_arccsc = symbol_id("arccsc");
+static const unsigned id_arccosh = symbol_id("arccosh");
+static const unsigned id_arctanh = symbol_id("arctanh");
+
 // expr derivative(expr u, expr x) {
 // 	return expr(
 // 		Kind::Derivative,
@@ -19,31 +46,31 @@ namespace calc {
 expr derivateInverseTrig(expr u, expr x) {
   if (is(&u, kind::POW) && degree(u) == -1) {
     if (u[0].kind() == kind::FUNC) {
-      if (u[0].funName() == "sin") {
+      if (u[0].funId() == id_sin) {
         return reduce((1 / pow(1 - pow(u[0][0], 2), fraction(1,2))) *
                       derivate(u[0], x));
       }
 
-      if (u[0].funName() == "cos") {
+      if (u[0].funId() == id_cos) {
         return reduce(-1 * (1 / pow((1 - pow(u[0][0], 2)), fraction(1,2))) *
                       derivate(u[0], x));
       }
 
-      if (u[0].funName() == "tan") {
+      if (u[0].funId() == id_tan) {
         return reduce((1 / (1 + pow(u[0][0], 2))) * derivate(u[0], x));
       }
 
-      if (u[0].funName() == "cot") {
+      if (u[0].funId() == id_cot) {
         return reduce(-1 * (1 / (1 + pow(u[0][0], 2))) * derivate(u[0], x));
       }
 
-      if (u[0].funName() == "sec") {
+      if (u[0].funId() == id_sec) {
         return reduce(
             (1 / (abs(u[0][0]) * pow((pow(u[0][0], integer(2)) - 1), fraction(1,2)))) *
             derivate(u[0], x));
       }
 
-      if (u[0].funName() == "csc") {
+      if (u[0].funId() == id_csc) {
         return reduce(-1 *
                       (1 / (abs(u[0][0]) * pow((pow(u[0][0], 2) - 1), fraction(1,2)))) *
                       derivate(u[0], x));
@@ -96,15 +123,15 @@ expr derivateMul(expr u, expr x) {
 expr derivateFuncs(expr u, expr x) {
   if (u.kind() == kind::FUNC) {
 
-    if (u.funName() == "abs") {
+    if (u.funId() == id_abs) {
       return abs(derivate(u[0], x));
     }
 
-    if (u.funName() == "ln") {
+    if (u.funId() == id_ln) {
       return reduce(1 / u[0]);
     }
 
-    if (u.funName() == "log") {
+    if (u.funId() == id_log) {
       if (u.size() == 2) {
         return reduce(1 / (u[0] * ln(u[1])));
       } else {
@@ -112,90 +139,90 @@ expr derivateFuncs(expr u, expr x) {
       }
     }
 
-    if (u.funName() == "exp") {
+    if (u.funId() == id_exp) {
       return reduce(exp(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "tan") {
+    if (u.funId() == id_tan) {
       return reduce(pow(sec(u[0]), 2) * derivate(u[0], x));
     }
 
-    if (u.funName() == "sinh") {
+    if (u.funId() == id_sinh) {
       return reduce(cosh(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "cosh") {
+    if (u.funId() == id_cosh) {
       return reduce(sinh(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "tanh") {
+    if (u.funId() == id_tanh) {
       return reduce(pow(sech(u[0]), 2) * derivate(u[0], x));
     }
 
-    if (u.funName() == "sec") {
+    if (u.funId() == id_sec) {
       return reduce(sec(u[0]) * tan(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "csc") {
+    if (u.funId() == id_csc) {
       return reduce(-1 * cot(u[0]) * csc(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "cot") {
+    if (u.funId() == id_cot) {
       return reduce(-1 * pow(csc(u[0]), 2) * derivate(u[0], x));
     }
 
-    if (u.funName() == "coth") {
+    if (u.funId() == id_coth) {
       return reduce(-1 * pow(csch(u[0]), 2) * derivate(u[0], x));
     }
 
-    if (u.funName() == "sech") {
+    if (u.funId() == id_sech) {
       return reduce(-1 * tanh(u[0]) * sech(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "csch") {
+    if (u.funId() == id_csch) {
       return reduce(-1 * coth(u[0]) * csch(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "sin") {
+    if (u.funId() == id_sin) {
       return reduce(cos(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "cos") {
+    if (u.funId() == id_cos) {
       return reduce(-1 * sin(u[0]) * derivate(u[0], x));
     }
 
-    if (u.funName() == "arcsin") {
+    if (u.funId() == id_arcsin) {
       return reduce((1 / pow(1 - pow(u[0], 2), fraction(1,2))) * derivate(u[0], x));
     }
 
-    if (u.funName() == "arccos") {
+    if (u.funId() == id_arccos) {
       return reduce(-1 * (1 / pow((1 - pow(u[0], 2)), fraction(1,2))) *
                     derivate(u[0], x));
     }
 
-    if (u.funName() == "arctan") {
+    if (u.funId() == id_arctan) {
       return reduce((1 / (1 + pow(u[0], 2))) * derivate(u[0], x));
     }
 
-    if (u.funName() == "arccot") {
+    if (u.funId() == id_arccot) {
       return reduce(-1 * (1 / (1 + pow(u[0], 2))) * derivate(u[0], x));
     }
 
-    if (u.funName() == "arcsec") {
+    if (u.funId() == id_arcsec) {
       return reduce((1 / (abs(u[0]) * pow((pow(u[0], 2) - 1), fraction(1, 2)))) *
                     derivate(u[0], x));
     }
 
-    if (u.funName() == "arccsc") {
+    if (u.funId() == id_arccsc) {
       return reduce(-1 * (1 / (abs(u[0]) * pow((pow(u[0], 2) - 1), fraction(1, 2)))) *
                     derivate(u[0], x));
     }
 
-    if (u.funName() == "arccosh") {
+    if (u.funId() == id_arccosh) {
       return reduce((1 / pow((pow(u[0], 2) - 1), fraction(1,2))) * derivate(u[0], x));
     }
 
-    if (u.funName() == "arctanh") {
+    if (u.funId() == id_arctanh) {
       return reduce((1 / (1 - pow(u[0], 2))) * derivate(u[0], x));
     }
   }
@@ -203,7 +230,7 @@ expr derivateFuncs(expr u, expr x) {
   return undefined();
 }
 
-expr derivate(expr u, expr x) {
+static expr derivateAny(expr u, expr x) {
 	expr dx;
 
   if (u == x) {
@@ -245,4 +272,22 @@ expr derivate(expr u, expr x) {
 	return diff(u, x);
 }
 
+expr derivate(expr u, expr x) {
+  if (is(&u, kind::TERMINAL)) {
+    return derivateAny(u, x);
+  }
+
+  expr dx;
+
+  if (memo_find(MEMO_DERIVATE, u, &x, &dx)) {
+    return dx;
+  }
+
+  dx = derivateAny(u, x);
+
+  memo_store(MEMO_DERIVATE, u, &x, dx);
+
+  return dx;
+}
+
 } // namespace calculus
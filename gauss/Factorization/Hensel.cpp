@@ -160,18 +160,18 @@ expr henselSepPolyExpr(expr f, expr g, expr h, expr s, expr t, expr L, Int m,
 
   expr o = raisePolyExpr(1, 0, L[0]);
 
-  Int m2 = m * m;
+  ModContext m2(m * m, symmetric);
 
   t1 = mulPolyExpr(g, h);
   e = subPolyExpr(f, t1);
 
-  e = gfPolyExpr(e, m2, symmetric);
+  e = gfPolyExpr(e, m2);
 
   t2 = mulPolyExpr(s, e);
   t1 = divPolyExpr(t2, h, L, Z);
 
-  q = gfPolyExpr(t1[0], m2, symmetric);
-  r = gfPolyExpr(t1[1], m2, symmetric);
+  q = gfPolyExpr(t1[0], m2);
+  r = gfPolyExpr(t1[1], m2);
 
   t2 = mulPolyExpr(t, e);
   t3 = mulPolyExpr(q, g);
@@ -179,33 +179,33 @@ expr henselSepPolyExpr(expr f, expr g, expr h, expr s, expr t, expr L, Int m,
   t4 = addPolyExpr(t2, t3);
 
   G = addPolyExpr(g, t4);
-  G = gfPolyExpr(G, m2, symmetric);
+  G = gfPolyExpr(G, m2);
 
   H = addPolyExpr(h, r);
-  H = gfPolyExpr(H, m2, symmetric);
+  H = gfPolyExpr(H, m2);
 
   t2 = mulPolyExpr(s, G);
   t3 = mulPolyExpr(t, H);
   t4 = addPolyExpr(t2, t3);
 
   b = subPolyExpr(t4, o);
-  b = gfPolyExpr(b, m2, symmetric);
+  b = gfPolyExpr(b, m2);
 
   t2 = mulPolyExpr(s, b);
   t3 = divPolyExpr(t2, H, L, Z);
 
-  c = gfPolyExpr(t3[0], m2, symmetric);
-  d = gfPolyExpr(t3[1], m2, symmetric);
+  c = gfPolyExpr(t3[0], m2);
+  d = gfPolyExpr(t3[1], m2);
 
   S = subPolyExpr(s, d);
-  S = gfPolyExpr(S, m2, symmetric);
+  S = gfPolyExpr(S, m2);
 
   t2 = mulPolyExpr(t, b);
   t3 = mulPolyExpr(c, G);
   t1 = addPolyExpr(t2, t3);
 
   T = subPolyExpr(t, t1);
-  T = gfPolyExpr(T, m2, symmetric);
+  T = gfPolyExpr(T, m2);
 
   return list({G, H, S, T});
 }
@@ -343,13 +343,18 @@ expr multifactorHenselLiftingPolyExpr(expr v, expr H, expr L, Int p, Int l,
   s = e[1];
   t = e[2];
 
+  // m = p^(2^(j - 1)), squared in place on every step
+  Int m = p;
+
   for (j = 1; j <= d; j++) {
-    T = henselSepPolyExpr(f, g, h, s, t, L, pow(p, pow(2, j - 1)), symmetric);
+    T = henselSepPolyExpr(f, g, h, s, t, L, m, symmetric);
 
     g = T[0];
     h = T[1];
     s = T[2];
     t = T[3];
+
+    m *= m;
   }
 
   H0 = list({});
@@ -21,7 +21,7 @@ namespace factorization {
 
 Int comb(Int n, Int k)
 {
-	return fact(n) / (fact(k) * fact(n - k));
+	return binomial(n, k);
 }
 
 // Int landauMignotteBound(expr u, expr x)
@@ -2164,16 +2164,12 @@ expr wangEEZPolyExpr(expr U, expr u, expr lc, expr a, Int p, expr L, expr K) {
 // }
 
 expr factorsWangPolyExprRec(expr &f, expr &L, expr K, Int mod) {
-  long long i = 0;
   long long j = 0;
 
   Int B = mignotteBoundPolyExpr(f, L, K);
 
-  long p = primes[0];
-
-  while (p <= B) {
-    p = primes[++i];
-  }
+  // the first prime bigger than B, taken directly without sieving
+  Int p = nextPrime(B);
 
   Int nrm1 = std::numeric_limits<long long>::min();
   Int nrm2 = std::numeric_limits<long long>::min();
@@ -1,5 +1,6 @@
 #include "Zassenhaus.hpp"
 #include "gauss/Algebra/Expression.hpp"
+#include "gauss/Algebra/FixedInt.hpp"
 #include "Hensel.hpp"
 #include "SquareFree.hpp"
 #include "Utils.hpp"
@@ -10,6 +11,7 @@
 
 #include <cmath>
 #include <cstddef>
+#include <vector>
 
 using namespace alg;
 using namespace calc;
@@ -429,6 +431,215 @@ expr cantorZassenhausPolyExpr(expr f, expr L, Int m) {
 //   return F;
 // }
 
+#ifdef __SIZEOF_INT128__
+
+// Recombination of the factors lifted modulo m = p^l, see
+// zassenhausPolyExpr, with the residues on fixed width integers. The
+// candidate factors are only converted to expressions when they pass
+// the bound test.
+struct Recombination {
+  expr f, L, K, g, F;
+
+  Int m, B;
+
+  template <size_t N> void run() {
+    typedef fint<N> fint_t;
+    typedef std::vector<fint_t> poly_t;
+
+    fint_mod<N> M(m);
+
+    expr x = L[0];
+
+    std::vector<poly_t> P(g.size());
+
+    for (size_t i = 0; i < g.size(); i++) {
+      P[i] = toDense<N>(M, g[i]);
+    }
+
+    fint_t b = M.to(leadCoeffPolyExpr(f).value());
+
+    // residues bigger than m/2 are the negative ones
+    fint_t half = fint_t::fromInt(m / 2);
+
+    fint<2 * N + 2> bound = fint<2 * N + 2>::fromInt(B);
+
+    std::vector<size_t> T;
+
+    for (size_t i = 0; i < g.size(); i++) {
+      T.push_back(i);
+    }
+
+    F = list({});
+
+    size_t s = 1;
+
+    while (2 * s <= T.size()) {
+      bool stop = false;
+
+      // subsets of s positions of T in lexicographic order
+      std::vector<size_t> c(s);
+
+      for (size_t i = 0; i < s; i++) {
+        c[i] = i;
+      }
+
+      while (!stop) {
+        std::vector<bool> inS(T.size(), false);
+
+        for (size_t i = 0; i < s; i++) {
+          inS[c[i]] = true;
+        }
+
+        poly_t G(1, b), H(1, b);
+
+        for (size_t i = 0; i < T.size(); i++) {
+          if (inS[i]) {
+            G = mul<N>(M, G, P[T[i]]);
+          } else {
+            H = mul<N>(M, H, P[T[i]]);
+          }
+        }
+
+        // the symmetric residues are in (-m/2, m/2), so only the
+        // bound on the product of the l1 norms is checked
+        fint<N + 1> g1 = l1norm<N>(M, G, half);
+        fint<N + 1> h1 = l1norm<N>(M, H, half);
+
+        fint<2 * N + 2> t;
+
+        fint<N + 1>::mul(g1, h1, t);
+
+        if (fint<2 * N + 2>::compare(t, bound) <= 0) {
+          F.insert(ppPolyExpr(toExpr<N>(M, G, half, x), L, K));
+
+          f = ppPolyExpr(toExpr<N>(M, H, half, x), L, K);
+
+          b = M.to(leadCoeffPolyExpr(f).value());
+
+          std::vector<size_t> Z;
+
+          for (size_t i = 0; i < T.size(); i++) {
+            if (!inS[i]) {
+              Z.push_back(T[i]);
+            }
+          }
+
+          T = Z;
+
+          stop = true;
+
+          break;
+        }
+
+        // next subset
+        size_t i = s;
+
+        while (i > 0 && c[i - 1] == T.size() - s + i - 1) {
+          i--;
+        }
+
+        if (i == 0) {
+          break;
+        }
+
+        c[i - 1]++;
+
+        for (size_t j = i; j < s; j++) {
+          c[j] = c[j - 1] + 1;
+        }
+      }
+
+      if (!stop) {
+        s = s + 1;
+      }
+    }
+
+    F.insert(f);
+  }
+
+  // Montgomery representation of the coefficients of u
+  template <size_t N>
+  static std::vector<fint<N>> toDense(const fint_mod<N> &M, expr &u) {
+    expr d = degreePolyExpr(u);
+
+    std::vector<fint<N>> r(d.value().longValue() + 1, fint<N>::zero());
+
+    for (size_t k = 0; k < u.size(); k++) {
+      r[u[k][1][1].value().longValue()] = M.to(u[k][0].value());
+    }
+
+    return r;
+  }
+
+  template <size_t N>
+  static std::vector<fint<N>> mul(const fint_mod<N> &M,
+                                  const std::vector<fint<N>> &a,
+                                  const std::vector<fint<N>> &b) {
+    std::vector<fint<N>> r(a.size() + b.size() - 1, fint<N>::zero());
+
+    for (size_t i = 0; i < a.size(); i++) {
+      for (size_t j = 0; j < b.size(); j++) {
+        r[i + j] = M.add(r[i + j], M.mul(a[i], b[j]));
+      }
+    }
+
+    return r;
+  }
+
+  // sum of the absolute values of the symmetric residues of u
+  template <size_t N>
+  static fint<N + 1> l1norm(const fint_mod<N> &M, const std::vector<fint<N>> &u,
+                            const fint<N> &half) {
+    fint<N + 1> s = fint<N + 1>::zero();
+
+    for (size_t i = 0; i < u.size(); i++) {
+      fint<N> c = M.from(u[i]);
+
+      if (fint<N>::compare(c, half) > 0) {
+        fint<N>::sub(M.m, c, c);
+      }
+
+      fint<N + 1>::add(s, c.template widen<N + 1>(), s);
+    }
+
+    return s;
+  }
+
+  template <size_t N>
+  static expr toExpr(const fint_mod<N> &M, const std::vector<fint<N>> &u,
+                     const fint<N> &half, expr &x) {
+    expr r = create(kind::ADD, {});
+
+    for (size_t i = 0; i < u.size(); i++) {
+      fint<N> c = M.from(u[i]);
+
+      if (c.isZero()) {
+        continue;
+      }
+
+      Int v;
+
+      if (fint<N>::compare(c, half) > 0) {
+        fint<N>::sub(M.m, c, c);
+
+        v = Int(0) - c.toInt();
+      } else {
+        v = c.toInt();
+      }
+
+      r.insert(v * pow(x, Int((unsigned long long)i)));
+    }
+
+    if (r.size() == 0) {
+      r.insert(0 * pow(x, 0));
+    }
+
+    return r;
+  }
+};
+
+#endif
+
 // From modern computer algebra by Gathen
 expr zassenhausPolyExpr(expr f, expr L, expr K) {
   assert(L.kind() == kind::LIST && L.size() <= 1);
@@ -463,9 +674,7 @@ expr zassenhausPolyExpr(expr f, expr L, expr K) {
   double y = gamma.doubleValue();
   // choose a prime number p such that f be square free in Zp[x]
   // and such that p dont divide lc(f)
-  for (size_t i = 1; primes[i] <= 2 * y * std::log(y); i++) {
-    p = primes[i];
-
+  for (p = 3; p.doubleValue() <= 2 * y * std::log(y); p = nextPrime(p)) {
     if (b.value() % p == 0) {
       continue;
     }
@@ -498,10 +707,30 @@ expr zassenhausPolyExpr(expr f, expr L, expr K) {
     T.insert(integer(i));
   }
 
+#ifdef __SIZEOF_INT128__
+  // the candidate factors have coefficients smaller than p^l, so when
+  // it fits the recombination runs on fixed width integers
+  Recombination R;
+
+  R.f = f;
+  R.L = L;
+  R.K = K;
+  R.g = g;
+  R.m = pow(p, l);
+  R.B = B;
+
+  if (dispatchLimbs((size_t)R.m.ceil_log2().longValue(), R)) {
+    return R.F;
+  }
+#endif
+
 	F = list({});
 
   s = 1;
 
+  // every candidate factor is reduced modulo the same p^l
+  ModContext pl(pow(p, l), true);
+
   while (2 * s <= T.size()) {
     stop = false;
 
@@ -523,14 +752,14 @@ expr zassenhausPolyExpr(expr f, expr L, expr K) {
         H = mulPolyExpr(H, g[Z[i].value()]);
       }
 
-      G = gfPolyExpr(G, pow(p, l), true);
-      H = gfPolyExpr(H, pow(p, l), true);
+      G = gfPolyExpr(G, pl);
+      H = gfPolyExpr(H, pl);
 
-      if (normPolyExpr(G) > pow(p, l) / 2) {
+      if (normPolyExpr(G) > pl.modulus() / 2) {
         continue;
       }
 
-      if (normPolyExpr(H) > pow(p, l) / 2) {
+      if (normPolyExpr(H) > pl.modulus() / 2) {
         continue;
       }
 
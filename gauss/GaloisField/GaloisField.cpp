@@ -29,7 +29,13 @@ using namespace poly;
 namespace galoisField {
 
 Int mod(Int a, Int b, bool symmetric) {
-  Int n = (b + (a % b)) % b;
+  Int n = a % b;
+
+  if (b < 0) {
+    n = (b + n) % b;
+  } else if (n < 0) {
+    n += b;
+  }
 
   if (symmetric) {
     if (0 <= n && n <= b / 2) {
@@ -92,7 +98,7 @@ Int randomGf(Int p, bool symmetric) {
 // }
 
 Int inverseGf(Int a, Int b, bool symmetric) {
-  Int t, nt, r, nr, q, tmp;
+  Int s, t;
 
   if (b < 0)
     b = -b;
@@ -101,29 +107,13 @@ Int inverseGf(Int a, Int b, bool symmetric) {
   // non-symetric representation and
   // converted back at the end to its
   // right representation
-  a = mod(a, b, false);
-
-  t = 0;
-  nt = 1;
-  r = b;
-
-  nr = mod(a, b, false);
-
-  while (nr != 0) {
-    q = r / nr;
-    tmp = nt;
-    nt = t - q * nt;
-    t = tmp;
-    tmp = nr;
-    nr = r - q * nr;
-    r = tmp;
-  }
+  Int g = xgcd(mod(a, b, false), b, s, t);
 
-  if (r > 1) {
+  if (g > 1) {
 		raise(error(ErrorCode::NUMBER_HAVE_NO_MODULAR_INVERSE, 0));
   }
 
-  return mod(t, b, symmetric);
+  return mod(s, b, symmetric);
 }
 
 Int quoGf(Int s, Int t, Int p, bool symmetric) {
@@ -680,20 +670,20 @@ expr gf(expr u, Int s, bool symmetric) {
 //   return list({r1, s1, t1});
 // }
 
-expr gfPolyExpr(expr u, Int p, bool symmetric) {
+expr gfPolyExpr(expr u, const ModContext &m) {
   if (u.kind() == kind::INT) {
-    return mod(u.value(), p, symmetric);
+    return m.reduce(u.value());
   }
   if (u.kind() == kind::MUL) {
     assert(u.size() == 2);
-    return gfPolyExpr(u[0], p, symmetric) * u[1];
+    return gfPolyExpr(u[0], m) * u[1];
   }
   assert(u.kind() == kind::ADD);
   expr g = expr(kind::ADD);
   expr x = 0;
   for (Int i = 0; i < u.size(); i++) {
     assert(u[i].kind() == kind::MUL && u[i].size() == 2);
-    expr c = gfPolyExpr(u[i][0], p, symmetric);
+    expr c = gfPolyExpr(u[i][0], m);
     x = u[i][1][0];
     if (!isZeroPolyExpr(c)) {
       g.insert(c * u[i][1]);
@@ -705,6 +695,10 @@ expr gfPolyExpr(expr u, Int p, bool symmetric) {
   return g;
 }
 
+expr gfPolyExpr(expr u, Int p, bool symmetric) {
+  return gfPolyExpr(u, ModContext(p, symmetric));
+}
+
 expr addPolyExprGf(expr f, expr g, Int p, bool sym) {
   return gfPolyExpr(addPolyExpr(f, g), p, sym);
 }
@@ -748,7 +742,7 @@ expr divPolyExprGf(expr a, expr b, expr L, Int p, bool symmetric) {
 
   Int dq, dr;
 
-  Int t1, t2, t3, lb, d;
+  Int t1, t3, lb, d;
 
   std::vector<Int> A = std::vector<Int>(da.value().longValue() + 1, 0);
   std::vector<Int> B = std::vector<Int>(db.value().longValue() + 1, 0);
@@ -784,10 +778,13 @@ expr divPolyExprGf(expr a, expr b, expr L, Int p, bool symmetric) {
 
   t1 = leadCoeffPolyExpr(b).value();
 
-  // TODO: remove the false from here
-  lb = inverseGf(t1, p, false);
+  // the coefficients are kept on the non symmetric
+  // representation and converted at the end
+  ModContext m(p, false);
 
-  assert(mod(lb * t1, p, symmetric) == 1);
+  lb = m.inverse(t1);
+
+  assert(m.mul(lb, t1) == 1);
 
   for (long long k = da.value().longValue(); k >= 0; k--) {
 
@@ -796,19 +793,13 @@ expr divPolyExprGf(expr a, expr b, expr L, Int p, bool symmetric) {
     e = min(dr, k);
 
     for (long long j = s.longValue(); j <= e; j++) {
-      t2 = B[j] * A[k - j + db.value().longValue()];
-      t1 = t1 - t2;
+      submul(t1, B[j], A[k - j + db.value().longValue()]);
     }
 
-    t1 = mod(t1, p, symmetric);
-
-    // if (t1 < 0) {
-    //   t1 = mod(t1 + p, p, symmetric);
-    // }
+    t1 = m.reduce(t1);
 
     if (da.value() - k <= dq) {
-      // TODO: remove false from here
-      t1 = mod(t1 * lb, p, false);
+      t1 = m.mul(t1, lb);
     }
 
     A[k] = t1;
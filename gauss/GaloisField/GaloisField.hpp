@@ -3,6 +3,7 @@
 
 // #include "gauss/AST/AST.hpp"
 // #include "gauss/Algebra/List.hpp"
+#include "gauss/Algebra/ModContext.hpp"
 #include "gauss/Polynomial/Polynomial.hpp"
 
 namespace galoisField {
@@ -45,6 +46,17 @@ namespace galoisField {
  */
 alg::expr gfPolyExpr(alg::expr u, Int p, bool symmetric);
 
+/**
+ * @brief Compute the representation of a polynomial expression in Z[x] over
+ * Zp[x] using the constants of a precomputed modular context
+ *
+ * @param u A polynomial expression in Z[x]
+ * @param m The context of the modulus p, its representation
+ * 					is used on the result
+ * @return The representation of u(x) over Zp[x]
+ */
+alg::expr gfPolyExpr(alg::expr u, const ModContext &m);
+
 /**
  * @brief Compute the representation of u(x) in Z[x] over Zp[x] without
  * expansion
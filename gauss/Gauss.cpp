@@ -18,6 +18,7 @@
 #include "gauss/Polynomial/Polynomial.hpp"
 #include "gauss/Polynomial/Resultant.hpp"
 #include "gauss/Polynomial/Roots.hpp"
+#include "gauss/Primes/Factor.hpp"
 #include "gauss/Primes/Primes.hpp"
 
 namespace gauss {
@@ -34,9 +35,7 @@ expr numberFromDouble(double v) {
 
   alg::decimalToFraction(fractional, 99999999999999, n, d);
 
-  alg::expr r = Int(integral) + alg::fraction(n, d);
-
-  return alg::reduce(r);
+  return alg::number(Rational(Int(integral)) + Rational(n, d));
 }
 
 
@@ -428,6 +427,15 @@ std::string toLatex(expr a, bool p, unsigned long k) {
   return alg::to_latex(&a, p, k);
 }
 
+// p^e as an unevaluated power if e > 1
+static expr primePower(const Int &p, unsigned long long e) {
+  if (e == 1) {
+    return alg::integer(p);
+  }
+
+  return alg::create(kind::POW, {alg::integer(p), alg::integer(Int(e))});
+}
+
 expr algebra::prime(size_t i) { return intFromLong(primes[i]); }
 
 expr algebra::primeFactors(expr a) {
@@ -435,35 +443,57 @@ expr algebra::primeFactors(expr a) {
 		raise(error(ErrorCode::ARG_IS_NOT_INT_EXPR, 0));
   }
 
-  if (abs(a.value()) > std::numeric_limits<unsigned long long>::max()) {
-		raise(error(ErrorCode::INT_BIGGER_THAN_MAX_ULL, 0));
-  }
-
-  char s = 1;
-
   Int v = a.value();
 
-  if (v < 0) {
-    s = -1;
-    v = -v;
+  if (abs(v) < 2) {
+    return a;
   }
 
-  std::vector<unsigned long long> f = primes.factorsOf(v.longValue());
+  std::vector<std::pair<Int, unsigned long long>> f = factorInt(v);
 
   expr F = 1;
   size_t start = 0;
-  if (s == -1) {
+  if (v < 0) {
     F = -1;
   } else {
-    F = Int(f[0]);
+    F = primePower(f[0].first, f[0].second);
     start = 1;
   }
 
   for (size_t i = start; i < f.size(); i++) {
-    F = F * Int(f[i]);
+    F = F * primePower(f[i].first, f[i].second);
   }
 
   return F;
 }
 
+ArenaScope::ArenaScope(size_t blockSize) : region(blockSize) {
+  outer = alg::arena::activate(&region);
+}
+
+ArenaScope::~ArenaScope() {
+  // the copies are allocated from the enclosing arena, or the heap
+  alg::arena::activate(outer);
+
+  for (size_t i = 0; i < kept.size(); i++) {
+    expr t = *kept[i];
+
+    *kept[i] = std::move(t);
+  }
+}
+
+void ArenaScope::keep(expr &r) { kept.push_back(&r); }
+
+expr ArenaScope::escape(const expr &a) {
+  alg::arena *inner = alg::arena::activate(outer);
+
+  expr r = a;
+
+  alg::arena::activate(inner);
+
+  return r;
+}
+
+size_t ArenaScope::used() const { return region.used(); }
+
 } // namespace gauss
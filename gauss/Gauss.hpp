@@ -14,6 +14,7 @@
 #include <array>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 
 /**
@@ -424,8 +425,9 @@ expr prime(size_t i);
 /**
  * @brief Compute the unique prime factorization of an integer.
  * @details Compute the unique prime factorization of an integer and return
- * the product of all the prime factors, if the number is less than 0,
- * -1 is returned as the first element.
+ * the product of all the prime factors raised to their multiplicities, if
+ * the number is less than 0, -1 is returned as the first element. The
+ * integers -1, 0 and 1 are returned unchanged.
  * @param[in] A number of kind integer.
  * @return The product of all prime factors of a number;
  */
@@ -935,6 +937,70 @@ expr derivative(expr a, expr x);
 
 } // namespace calculus
 
+/**
+ * @brief Allocate the expressions of a computation from an arena.
+ *
+ * @details While the scope is alive, the operands and the integers of
+ * the expressions created on the current thread are allocated from a
+ * bump arena instead of the heap, and freeing them costs nothing. All
+ * the memory is released at once when the scope is destroyed, so the
+ * expressions created or modified inside the scope can't be used after
+ * it, except the ones registered with keep or copied with escape. Scopes
+ * can be nested, the kept expressions of a scope are moved to the one
+ * that encloses it.
+ *
+ * Lists, sets, matrices and the digits of big integers are always
+ * allocated from the heap.
+ */
+class ArenaScope {
+public:
+  /**
+   * @brief Activate an arena on the current thread.
+   *
+   * @param[in] blockSize Size in bytes of the blocks requested from the
+   * heap by the arena.
+   */
+  ArenaScope(size_t blockSize = 1 << 20);
+
+  /**
+   * @brief Copy the kept expressions out of the arena and release it.
+   */
+  ~ArenaScope();
+
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope &operator=(const ArenaScope &) = delete;
+
+  /**
+   * @brief Keep the value of an expression after the scope.
+   *
+   * @details The expression 'r' should outlive the scope, its value
+   * when the scope is destroyed is copied out of the arena.
+   *
+   * @param[in] r An expression declared outside of the scope.
+   */
+  void keep(expr &r);
+
+  /**
+   * @brief Copy an expression out of the arena.
+   *
+   * @param[in] a An algebraic expression.
+   *
+   * @return A copy of 'a' that can be used after the scope.
+   */
+  expr escape(const expr &a);
+
+  /**
+   * @brief Number of bytes allocated from the arena.
+   */
+  size_t used() const;
+
+private:
+  alg::arena region;
+  alg::arena *outer;
+
+  std::vector<expr *> kept;
+};
+
 /**
  * @brief Return a string corresponding to a given expression.
  *
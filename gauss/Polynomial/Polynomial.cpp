@@ -221,7 +221,7 @@ Int collectDegree(expr &u, expr &x) {
   }
 
   if (u.kind() == kind::SYM) {
-    if (u.identifier() == x.identifier()) {
+    if (get_sym_id(&u) == get_sym_id(&x)) {
       return 1;
     }
 
@@ -393,29 +393,29 @@ expr monicPolyExpr(expr u, expr L, expr K) {
   return quoPolyExpr(u, lc, L, K);
 }
 
-expr constDenLcmPolyExprRec(expr u, expr L, unsigned int j) {
+// g = lcm(g, d) for every denominator d of the coefficients of u
+void constDenLcmPolyExprRec(expr &u, expr &L, unsigned int j, Int &g) {
   if (L.size() == j) {
     assert(u.kind() == kind::INT || u.kind() == kind::FRAC);
 
     if (u.kind() == kind::FRAC) {
-      return u[1];
+      g = lcm(g, get_rational(&u).den());
     }
 
-    return 1;
+    return;
   }
 
-  expr g = 1;
-
   for (Int i = 0; i < u.size(); i++) {
-    expr t = constDenLcmPolyExprRec(u[i][0], L, j + 1);
-    g = lcm(g, t);
+    constDenLcmPolyExprRec(u[i][0], L, j + 1, g);
   }
-
-  return g;
 }
 
 expr constDenLcmPolyExpr(expr u, expr L) {
-  return constDenLcmPolyExprRec(u, L, 0);
+  Int g = 1;
+
+  constDenLcmPolyExprRec(u, L, 0, g);
+
+  return abs(g);
 }
 
 expr removeDenominatorsPolyExpr(expr u, expr L, expr K) {
@@ -577,6 +577,9 @@ expr mulPolyExpr(expr &&p1, expr &&p2) {
   expr x = p1[0][1][0];
   std::map<Int, expr> coeffs;
 
+  // integer coefficients are accumulated in place
+  std::map<Int, Int> ints;
+
   for (size_t i = 0; i < p1.size(); ++i) {
     assert(p1[i][1][0] == x);
 
@@ -589,6 +592,11 @@ expr mulPolyExpr(expr &&p1, expr &&p2) {
 
       Int e = u[1][1].value() + v[1][1].value();
 
+      if (u[0].kind() == kind::INT && v[0].kind() == kind::INT) {
+        addmul(ints[e], u[0].value(), v[0].value());
+        continue;
+      }
+
       expr c = mulPolyExpr(u[0], v[0]);
 
       if (coeffs.count(e) == 0) {
@@ -599,6 +607,17 @@ expr mulPolyExpr(expr &&p1, expr &&p2) {
     }
   }
 
+  for (std::map<Int, Int>::iterator it = ints.begin(); it != ints.end();
+       it++) {
+    expr c = it->second;
+
+    if (coeffs.count(it->first) == 0) {
+      coeffs[it->first] = c;
+    } else {
+      coeffs[it->first] = addPolyExpr(coeffs[it->first], c);
+    }
+  }
+
   expr g = expr(kind::ADD);
 
   for (std::map<Int, expr>::iterator it = coeffs.begin(); it != coeffs.end();
@@ -0,0 +1,756 @@
+#include "Factor.hpp"
+#include "Primes.hpp"
+
+#include "gauss/Algebra/ModContext.hpp"
+#include "gauss/Error/error.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+
+using bint_t = Int::bint_t;
+
+// number of bits of |n|
+static size_t bitLength(const Int &n) {
+	if (n.flag) {
+		return bint_t::bit_length(n.val);
+	}
+
+	unsigned long long x = n.x < 0 ? -(unsigned long long)n.x : n.x;
+
+	size_t b = 0;
+
+	while (x) {
+		b++;
+		x >>= 1;
+	}
+
+	return b;
+}
+
+// a^e mod p for p < 2^32
+static unsigned long long powModWord(unsigned long long a, unsigned long long e,
+                                     unsigned long long p) {
+	unsigned long long r = 1 % p;
+
+	a %= p;
+
+	while (e) {
+		if (e & 1) {
+			r = r * a % p;
+		}
+
+		a = a * a % p;
+		e >>= 1;
+	}
+
+	return r;
+}
+
+// Tonelli-Shanks, returns a square root of the quadratic residue a
+// modulo the odd prime p < 2^32, see [1] Algorithm 2.3.8
+static unsigned long long sqrtModWord(unsigned long long a,
+                                      unsigned long long p) {
+	a %= p;
+
+	if (a == 0) {
+		return 0;
+	}
+
+	if (p % 4 == 3) {
+		return powModWord(a, (p + 1) / 4, p);
+	}
+
+	unsigned long long q = p - 1;
+	unsigned long long s = 0;
+
+	while (q % 2 == 0) {
+		q /= 2;
+		s++;
+	}
+
+	unsigned long long z = 2;
+
+	while (powModWord(z, (p - 1) / 2, p) != p - 1) {
+		z++;
+	}
+
+	unsigned long long c = powModWord(z, q, p);
+	unsigned long long t = powModWord(a, q, p);
+	unsigned long long r = powModWord(a, (q + 1) / 2, p);
+
+	while (t != 1) {
+		unsigned long long i = 0;
+		unsigned long long u = t;
+
+		while (u != 1) {
+			u = u * u % p;
+			i++;
+		}
+
+		unsigned long long b = c;
+
+		for (unsigned long long j = 0; j + i + 1 < s; j++) {
+			b = b * b % p;
+		}
+
+		s = i;
+		c = b * b % p;
+		t = t * c % p;
+		r = r * b % p;
+	}
+
+	return r;
+}
+
+Int iroot(const Int &n, unsigned long long k) {
+	if (n < 0 || k == 0) {
+		raise(error(ErrorCode::ARG_IS_INVALID, 0));
+	}
+
+	if (n < 2 || k == 1) {
+		return n;
+	}
+
+	size_t b = bitLength(n);
+
+	if (k >= b) {
+		return 1;
+	}
+
+	// Newton iteration from 2^ceil(b/k) > n^(1/k), the iterates
+	// decrease until they reach the floor of the root
+	Int x = pow(Int(2), Int((unsigned long long)((b + k - 1) / k)));
+
+	Int K = Int(k);
+
+	while (true) {
+		Int y = ((K - 1) * x + n / pow(x, K - 1)) / K;
+
+		if (y >= x) {
+			return x;
+		}
+
+		x = y;
+	}
+}
+
+Int pollardRho(const Int &n, long long c, unsigned long long iterations) {
+	ModContext m(n, false);
+
+	// number of products accumulated before every gcd
+	const unsigned long long M = 128;
+
+	Int x, y = 2, ys, q = 1, g = 1;
+
+	unsigned long long r = 1;
+	unsigned long long it = 0;
+
+	do {
+		x = y;
+
+		for (unsigned long long i = 0; i < r; i++) {
+			y = m.add(m.mul(y, y), c);
+		}
+
+		for (unsigned long long k = 0; k < r && g == 1; k += M) {
+			ys = y;
+
+			for (unsigned long long i = 0; i < std::min(M, r - k); i++) {
+				y = m.add(m.mul(y, y), c);
+				q = m.mul(q, x - y);
+			}
+
+			it += std::min(M, r - k);
+
+			g = gcd(q, n);
+		}
+
+		r *= 2;
+	} while (g == 1 && it < iterations);
+
+	if (g == n) {
+		// the product vanished, repeat the last steps one by one
+		do {
+			ys = m.add(m.mul(ys, ys), c);
+			g = gcd(abs(x - ys), n);
+		} while (g == 1);
+	}
+
+	return g == n ? 1 : g;
+}
+
+Int pollardPm1(const Int &n, unsigned long long B1, unsigned long long B2) {
+	ModContext m(n, false);
+
+	size_t np = primes.countUpTo(std::max(B1, B2));
+
+	Int a = 2, g;
+
+	size_t i = 0;
+
+	// stage 1, a = 2^k where k is the product of the prime powers up to B1
+	for (; i < np && primes[i] <= B1; i++) {
+		unsigned long long q = primes[i];
+		unsigned long long e = q;
+
+		while (e <= B1 / q) {
+			e *= q;
+		}
+
+		a = m.pow(a, Int(e));
+	}
+
+	g = gcd(abs(a - 1), n);
+
+	if (g == n) {
+		return 1;
+	}
+
+	if (g > 1 || i == 0 || i == np) {
+		return g;
+	}
+
+	// stage 2, a^q for the primes B1 < q <= B2 are computed from
+	// the previous one with the powers a^d for the gaps d
+	std::vector<Int> d(1, Int(1));
+
+	Int a2 = m.mul(a, a);
+	Int b = m.pow(a, Int(primes[i]));
+	Int t = m.sub(b, 1);
+
+	for (i = i + 1; i < np; i++) {
+		size_t h = (primes[i] - primes[i - 1]) / 2;
+
+		while (d.size() <= h) {
+			d.push_back(m.mul(d.back(), a2));
+		}
+
+		b = m.mul(b, d[h]);
+		t = m.mul(t, m.sub(b, 1));
+
+		if (i % 1024 == 0 && gcd(t, n) != 1) {
+			break;
+		}
+	}
+
+	g = gcd(t, n);
+
+	return g == n ? 1 : g;
+}
+
+// point on the Montgomery curve By^2 = x^3 + Ax^2 + x, in the
+// projective coordinates X:Z without y
+struct ecmPoint {
+	Int x, z;
+};
+
+// [2]P, where a24 = (A + 2)/4
+static ecmPoint ecmDouble(const ModContext &m, const Int &a24,
+                          const ecmPoint &p) {
+	Int s = m.add(p.x, p.z);
+	Int d = m.sub(p.x, p.z);
+
+	s = m.mul(s, s);
+	d = m.mul(d, d);
+
+	Int t = m.sub(s, d);
+
+	ecmPoint r;
+
+	r.x = m.mul(s, d);
+	r.z = m.mul(t, m.add(d, m.mul(a24, t)));
+
+	return r;
+}
+
+// P + Q given P - Q
+static ecmPoint ecmAdd(const ModContext &m, const ecmPoint &p,
+                       const ecmPoint &q, const ecmPoint &d) {
+	Int u = m.mul(m.sub(p.x, p.z), m.add(q.x, q.z));
+	Int v = m.mul(m.add(p.x, p.z), m.sub(q.x, q.z));
+
+	Int s = m.add(u, v);
+	Int t = m.sub(u, v);
+
+	ecmPoint r;
+
+	r.x = m.mul(d.z, m.mul(s, s));
+	r.z = m.mul(d.x, m.mul(t, t));
+
+	return r;
+}
+
+// [k]P for k >= 1 by the Montgomery ladder
+static ecmPoint ecmMul(const ModContext &m, const Int &a24, const ecmPoint &p,
+                       unsigned long long k) {
+	ecmPoint r0 = p;
+	ecmPoint r1 = ecmDouble(m, a24, p);
+
+	int b = 63;
+
+	while (!((k >> b) & 1)) {
+		b--;
+	}
+
+	for (b--; b >= 0; b--) {
+		if ((k >> b) & 1) {
+			r0 = ecmAdd(m, r1, r0, p);
+			r1 = ecmDouble(m, a24, r1);
+		} else {
+			r1 = ecmAdd(m, r1, r0, p);
+			r0 = ecmDouble(m, a24, r0);
+		}
+	}
+
+	return r0;
+}
+
+Int ecm(const Int &n, unsigned long long B1, unsigned long long B2,
+        unsigned curves) {
+	// stage 2 steps by 2D
+	const unsigned long long D = 105;
+
+	if (B1 < 2 * D + 1) {
+		B1 = 2 * D + 1;
+	}
+
+	B2 = std::max(B1, B2);
+
+	static thread_local std::mt19937_64 rng(0x5eed);
+
+	ModContext m(n, false);
+
+	size_t np = primes.countUpTo(B2);
+
+	for (unsigned c = 0; c < curves; c++) {
+		// Suyama parametrization, see [1] Theorem 7.4.3
+		Int sigma = Int((unsigned long long)(rng() % 2147483640ULL + 6));
+
+		Int u = m.sub(m.mul(sigma, sigma), 5);
+		Int v = m.mul(sigma, 4);
+
+		Int u3 = m.mul(m.mul(u, u), u);
+
+		ecmPoint Q;
+
+		Q.x = u3;
+		Q.z = m.mul(m.mul(v, v), v);
+
+		Int w = m.sub(v, u);
+
+		Int num = m.mul(m.mul(m.mul(w, w), w), m.add(m.mul(u, 3), v));
+		Int den = m.mul(m.mul(u3, v), 16);
+
+		Int g = gcd(den, n);
+
+		if (g == n) {
+			continue;
+		}
+
+		if (g > 1) {
+			return g;
+		}
+
+		Int a24 = m.mul(num, m.inverse(den));
+
+		// stage 1
+		size_t i = 0;
+
+		for (; i < np && primes[i] <= B1; i++) {
+			unsigned long long q = primes[i];
+			unsigned long long e = q;
+
+			while (e <= B1 / q) {
+				e *= q;
+			}
+
+			Q = ecmMul(m, a24, Q, e);
+		}
+
+		g = gcd(Q.z, n);
+
+		if (g == n) {
+			continue;
+		}
+
+		if (g > 1) {
+			return g;
+		}
+
+		// stage 2, S[d] = [2d]Q and the primes q in (B, B2] are
+		// written as q = r + 2d for the multiples r of 2D
+		std::vector<ecmPoint> S(D + 1);
+		std::vector<Int> beta(D + 1);
+
+		S[1] = ecmDouble(m, a24, Q);
+		S[2] = ecmDouble(m, a24, S[1]);
+
+		for (unsigned long long d = 3; d <= D; d++) {
+			S[d] = ecmAdd(m, S[d - 1], S[1], S[d - 2]);
+		}
+
+		for (unsigned long long d = 1; d <= D; d++) {
+			beta[d] = m.mul(S[d].x, S[d].z);
+		}
+
+		unsigned long long B = B1 % 2 ? B1 : B1 - 1;
+
+		ecmPoint R = ecmMul(m, a24, Q, B);
+		ecmPoint T = ecmMul(m, a24, Q, B - 2 * D);
+
+		Int t = 1;
+
+		size_t j = i;
+
+		while (j < np && primes[j] <= B) {
+			j++;
+		}
+
+		for (unsigned long long r = B; r < B2; r += 2 * D) {
+			Int alpha = m.mul(R.x, R.z);
+
+			for (; j < np && primes[j] <= r + 2 * D; j++) {
+				unsigned long long d = (primes[j] - r) / 2;
+
+				Int e = m.mul(m.sub(R.x, S[d].x), m.add(R.z, S[d].z));
+
+				t = m.mul(t, m.add(m.sub(e, alpha), beta[d]));
+			}
+
+			ecmPoint N = ecmAdd(m, R, S[D], T);
+
+			T = R;
+			R = N;
+		}
+
+		g = gcd(t, n);
+
+		if (g > 1 && g < n) {
+			return g;
+		}
+	}
+
+	return 1;
+}
+
+Int quadraticSieve(const Int &n) {
+	size_t digits = bitLength(n) * 0.30103 + 1;
+
+	size_t size = digits <= 20   ? 100
+	              : digits <= 25 ? 200
+	              : digits <= 30 ? 350
+	              : digits <= 35 ? 600
+	              : digits <= 40 ? 1000
+	                             : 1800;
+
+	// factor base, the primes p such that n is a square mod p and
+	// the square roots of n mod p
+	std::vector<unsigned long long> fb, root;
+	std::vector<unsigned char> lg;
+
+	size_t np = primes.countUpTo(std::max<size_t>(1000, size * 40));
+
+	for (size_t i = 0; i < np && fb.size() < size; i++) {
+		unsigned long long p = primes[i];
+		unsigned long long np = (n % Int(p)).longValue();
+
+		if (np == 0) {
+			return n == Int(p) ? Int(1) : Int(p);
+		}
+
+		if (p == 2 || powModWord(np, (p - 1) / 2, p) == 1) {
+			fb.push_back(p);
+			root.push_back(p == 2 ? 1 : sqrtModWord(np, p));
+			lg.push_back((unsigned char)std::lround(std::log2((double)p)));
+		}
+	}
+
+	size_t k = fb.size();
+
+	// relations x^2 - n = (-1)^e[0]*fb[0]^e[1]*...
+	std::vector<Int> X;
+	std::vector<std::vector<unsigned>> E;
+
+	const long long L = 65536;
+
+	std::vector<unsigned char> sieve(L);
+	std::vector<unsigned long long> xm(k);
+
+	Int s = isqrt(n) + 1;
+
+	double slack = 1.5 * std::log2((double)fb.back()) + 2;
+
+	for (long long b = 0; X.size() < k + 16; b++) {
+		if (b > 4096) {
+			return 1;
+		}
+
+		// blocks alternate around sqrt(n)
+		long long j = b % 2 == 0 ? b / 2 : -(b + 1) / 2;
+
+		Int x0 = s + Int(j * L);
+
+		std::fill(sieve.begin(), sieve.end(), 0);
+
+		for (size_t i = 0; i < k; i++) {
+			unsigned long long p = fb[i];
+
+			long long r = (x0 % Int(p)).longValue();
+
+			xm[i] = r < 0 ? r + p : r;
+
+			unsigned long long r0 = root[i];
+			unsigned long long r1 = p - root[i];
+
+			for (unsigned long long t = (r0 + p - xm[i]) % p; t < (unsigned long long)L;
+			     t += p) {
+				sieve[t] += lg[i];
+			}
+
+			if (r1 != r0 && r1 != p) {
+				for (unsigned long long t = (r1 + p - xm[i]) % p;
+				     t < (unsigned long long)L; t += p) {
+					sieve[t] += lg[i];
+				}
+			}
+		}
+
+		// log2|x^2 - n| on the ends of the block bounds the values inside
+		Int q0 = abs(x0 * x0 - n);
+		Int q1 = abs((x0 + L) * (x0 + L) - n);
+
+		double top = std::log2(std::max(q0.doubleValue(), q1.doubleValue()) + 1);
+
+		double threshold = std::max(0.0, top - slack);
+
+		for (long long t = 0; t < L; t++) {
+			if (sieve[t] < threshold) {
+				continue;
+			}
+
+			Int x = x0 + t;
+			Int q = x * x - n;
+
+			std::vector<unsigned> e(k + 1, 0);
+
+			if (q < 0) {
+				e[0] = 1;
+				q = -q;
+			}
+
+			for (size_t i = 0; i < k && q > 1; i++) {
+				unsigned long long p = fb[i];
+				unsigned long long v = (xm[i] + t) % p;
+
+				if (v != root[i] && v != p - root[i]) {
+					continue;
+				}
+
+				Int f = Int(p);
+
+				while (q % f == 0) {
+					q /= f;
+					e[i + 1]++;
+				}
+			}
+
+			if (q == 1) {
+				X.push_back(x);
+				E.push_back(e);
+			}
+		}
+	}
+
+	// gaussian elimination over GF(2), every row keeps the set of
+	// relations that were added to it
+	size_t R = X.size();
+	size_t C = k + 1;
+
+	size_t cw = (C + 63) / 64;
+	size_t rw = (R + 63) / 64;
+
+	std::vector<std::vector<uint64_t>> M(R, std::vector<uint64_t>(cw, 0));
+	std::vector<std::vector<uint64_t>> H(R, std::vector<uint64_t>(rw, 0));
+
+	for (size_t i = 0; i < R; i++) {
+		for (size_t c = 0; c < C; c++) {
+			if (E[i][c] & 1) {
+				M[i][c / 64] |= (uint64_t)1 << (c % 64);
+			}
+		}
+
+		H[i][i / 64] |= (uint64_t)1 << (i % 64);
+	}
+
+	size_t rank = 0;
+
+	for (size_t c = 0; c < C && rank < R; c++) {
+		size_t p = rank;
+
+		while (p < R && !((M[p][c / 64] >> (c % 64)) & 1)) {
+			p++;
+		}
+
+		if (p == R) {
+			continue;
+		}
+
+		std::swap(M[p], M[rank]);
+		std::swap(H[p], H[rank]);
+
+		for (size_t i = 0; i < R; i++) {
+			if (i != rank && ((M[i][c / 64] >> (c % 64)) & 1)) {
+				for (size_t w = 0; w < cw; w++) {
+					M[i][w] ^= M[rank][w];
+				}
+
+				for (size_t w = 0; w < rw; w++) {
+					H[i][w] ^= H[rank][w];
+				}
+			}
+		}
+
+		rank++;
+	}
+
+	// the rows after the rank are dependencies, x1^2*...*xt^2 is
+	// congruent to a square y^2 mod n
+	for (size_t i = rank; i < R; i++) {
+		Int x = 1;
+
+		std::vector<unsigned long long> e(C, 0);
+
+		for (size_t r = 0; r < R; r++) {
+			if ((H[i][r / 64] >> (r % 64)) & 1) {
+				x = x * X[r] % n;
+
+				for (size_t c = 0; c < C; c++) {
+					e[c] += E[r][c];
+				}
+			}
+		}
+
+		Int y = 1;
+
+		for (size_t c = 1; c < C; c++) {
+			if (e[c]) {
+				y = y * powMod(Int(fb[c - 1]), Int(e[c] / 2), n) % n;
+			}
+		}
+
+		Int g = gcd(abs(x - y), n);
+
+		if (g > 1 && g < n) {
+			return g;
+		}
+	}
+
+	return 1;
+}
+
+// finds a non trivial factor of the odd composite n without prime
+// factors below 2^12 that is not a perfect power
+static Int findFactor(const Int &n) {
+	Int d = pollardRho(n, 1, 1 << 16);
+
+	if (d != 1) {
+		return d;
+	}
+
+	if (bitLength(n) <= 133) {
+		d = quadraticSieve(n);
+
+		if (d != 1) {
+			return d;
+		}
+	}
+
+	d = pollardPm1(n, 20000, 1000000);
+
+	if (d != 1) {
+		return d;
+	}
+
+	// the bounds from the table of GMP-ECM for factors of 20, 25, 30,
+	// 35 and 40 digits, the last one is repeated until a factor is found
+	const unsigned long long B1[] = {11000, 50000, 250000, 1000000, 3000000};
+	const unsigned curves[] = {90, 300, 700, 1800, 5100};
+
+	for (size_t l = 0;; l = std::min<size_t>(l + 1, 4)) {
+		d = ecm(n, B1[l], 50 * B1[l], curves[l]);
+
+		if (d != 1) {
+			return d;
+		}
+
+		d = pollardRho(n, 3 + l, 1 << 20);
+
+		if (d != 1) {
+			return d;
+		}
+	}
+}
+
+static void splitFactor(const Int &n, unsigned long long e,
+                        std::map<Int, unsigned long long> &F) {
+	if (n == 1) {
+		return;
+	}
+
+	if (isPrime(n)) {
+		F[n] += e;
+		return;
+	}
+
+	// n have no factors below 2^12, so it can only be the k'th power
+	// of a number if k <= log2(n)/12
+	size_t b = bitLength(n);
+
+	for (unsigned long long k = 2; k <= b / 12; k++) {
+		Int r = iroot(n, k);
+
+		if (pow(r, Int(k)) == n) {
+			return splitFactor(r, e * k, F);
+		}
+	}
+
+	Int d = findFactor(n);
+
+	splitFactor(d, e, F);
+	splitFactor(n / d, e, F);
+}
+
+std::vector<std::pair<Int, unsigned long long>> factorInt(const Int &n) {
+	std::map<Int, unsigned long long> F;
+
+	Int m = abs(n);
+
+	// trial division by the primes below 2^12
+	for (unsigned i = 0; primes[i] < 4096 && m > 1; i++) {
+		Int p = primes[i];
+
+		if (p * p > m) {
+			break;
+		}
+
+		unsigned long long e = 0;
+
+		while (m % p == 0) {
+			m /= p;
+			e++;
+		}
+
+		if (e) {
+			F[p] = e;
+		}
+	}
+
+	if (m > 1) {
+		splitFactor(m, 1, F);
+	}
+
+	return std::vector<std::pair<Int, unsigned long long>>(F.begin(), F.end());
+}
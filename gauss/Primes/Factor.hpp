@@ -0,0 +1,49 @@
+#ifndef FACTOR_H
+#define FACTOR_H
+
+// References:
+// [1] Crandall, Richard and Pomerance, Carl. Prime Numbers: A
+// Computational Perspective, chapters 5, 6 and 7
+// [2] Brent, Richard P. An improved Monte Carlo factorization algorithm
+// [3] Montgomery, Peter L. Speeding the Pollard and elliptic curve
+// methods of factorization
+
+#include "gauss/Algebra/Integer.hpp"
+
+#include <utility>
+#include <vector>
+
+// Returns the prime factorization of |n| as pairs of primes and
+// multiplicities sorted by the primes, the factorization of 0 and 1 is
+// empty. The small factors are removed by trial division and the
+// cofactors are split by the methods below, from the cheapest to the
+// most expensive one.
+std::vector<std::pair<Int, unsigned long long>> factorInt(const Int &n);
+
+// The methods below try to find a non trivial factor of the odd
+// composite n that is not a perfect power, they return 1 on failure,
+// the factors they return are not necessarily prime.
+
+// Pollard rho with the cycle detection of Brent [2], using the
+// polynomial x^2 + c and at most the given number of iterations.
+Int pollardRho(const Int &n, long long c, unsigned long long iterations);
+
+// Pollard p - 1 with a stage 1 bound B1 and the standard stage 2
+// continuation up to B2, see [1] section 5.4.
+Int pollardPm1(const Int &n, unsigned long long B1, unsigned long long B2);
+
+// Lenstra elliptic curve method on Montgomery curves with the Suyama
+// parametrization, with the stage 1 bound B1 and the stage 2 bound B2,
+// see [1] Algorithm 7.4.4 and [3]. At most the given number of curves
+// are tried.
+Int ecm(const Int &n, unsigned long long B1, unsigned long long B2,
+        unsigned curves);
+
+// Single polynomial quadratic sieve, see [1] section 6.1, it is meant
+// for numbers up to about 40 decimal digits.
+Int quadraticSieve(const Int &n);
+
+// returns floor(n^(1/k)) for n >= 0 and k >= 1
+Int iroot(const Int &n, unsigned long long k);
+
+#endif
@@ -1,70 +1,204 @@
 #include "Primes.hpp"
+#include "Factor.hpp"
+#include "gauss/Algebra/ModContext.hpp"
+#include "gauss/Error/error.hpp"
+
+#include <algorithm>
+#include <climits>
 #include <cstddef>
 #include <limits>
+#include <random>
 #include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 
-Primes primes = Primes();
+Primes primes;
 
-Primes::Primes()
-{
-	lp = std::vector<unsigned long long>();
+// the sieve works on the residues coprime to 30, each byte of a segment
+// represents 30 consecutive integers and the bit k of it the residue
+// wheel[k], so a segment of 32KB covers 983040 integers
+static const unsigned char wheel[8] = {1, 7, 11, 13, 17, 19, 23, 29};
 
-	primes = std::vector<unsigned long long>();
+static const size_t SEGMENT_BYTES = 32768;
 
-	cacheMorePrimes();
+// bit of the residue r mod 30 on the wheel, r coprime to 30
+static inline unsigned char wheelBit(unsigned long long r) {
+	switch (r) {
+	case 1: return 1 << 0;
+	case 7: return 1 << 1;
+	case 11: return 1 << 2;
+	case 13: return 1 << 3;
+	case 17: return 1 << 4;
+	case 19: return 1 << 5;
+	case 23: return 1 << 6;
+	default: return 1 << 7;
+	}
 }
 
-Primes::~Primes() {}
+// mark the multiples p*q >= max(p^2, lo) of the prime p > 5 on the
+// segment starting at lo, only the q coprime to 30 have multiples on it
+static void crossOff(unsigned char *s, unsigned long long lo, size_t bytes,
+                     unsigned long long p) {
+	unsigned long long start = std::max(p * p, lo);
+	unsigned long long q0 = (start + p - 1) / p;
+
+	for (int k = 0; k < 8; k++) {
+		unsigned long long q = q0 + (wheel[k] + 30 - q0 % 30) % 30;
+		unsigned long long n = p * q;
 
-int Primes::operator[](unsigned int idx) {
+		unsigned char b = wheelBit(n % 30);
+
+		// n + 30*p have the same residue as n
+		for (size_t i = (n - lo) / 30; i < bytes; i += p) {
+			s[i] |= b;
+		}
+	}
+}
 
-	while(idx >= this->primes.size()) {
-		cacheMorePrimes();
+Primes::Primes(size_t n) : size(0), high(0) {
+	for (size_t i = 0; i < MAX_CHUNKS; i++) {
+		chunks[i].store(nullptr, std::memory_order_relaxed);
 	}
 
-	return this->primes[idx];
+	std::lock_guard<std::mutex> guard(lock);
+
+	sieveNextSegment();
+
+	while (size.load(std::memory_order_relaxed) < n) {
+		sieveNextSegment();
+	}
 }
 
-unsigned int Primes::count() { return this->primes.size(); }
+Primes::~Primes() {
+	for (size_t i = 0; i < MAX_CHUNKS; i++) {
+		delete[] chunks[i].load(std::memory_order_relaxed);
+	}
+}
 
-void Primes::cacheMorePrimes() {
-	unsigned long long n = lp.size();
+size_t Primes::count() const { return size.load(std::memory_order_acquire); }
 
-	if(lp.size() > 2147483647) {
-		printf("trying to store to many primes!\n");
-		abort();
+unsigned long long Primes::limit() const {
+	return high.load(std::memory_order_acquire);
+}
+
+void Primes::sieveNextSegment() {
+	unsigned long long lo = high.load(std::memory_order_relaxed);
+
+	if (lo >= 4294967296ULL) {
+		raise(error(ErrorCode::ARG_IS_INVALID, 0));
 	}
 
-	for(size_t i = 0; i < 5000; i++) {
-		this->lp.push_back(0);
+	unsigned long long hi = lo + 30 * SEGMENT_BYTES;
+
+	std::vector<unsigned char> s(SEGMENT_BYTES, 0);
+
+	std::vector<uint32_t> found;
+
+	if (lo == 0) {
+		// 1 is not prime, and the primes of the first segment are
+		// found while it is sieved
+		s[0] |= 1;
+
+		found.push_back(2);
+		found.push_back(3);
+		found.push_back(5);
+
+		for (unsigned long long p = 7; p * p < hi; p += 2) {
+			if (p % 3 && p % 5 && !(s[p / 30] & wheelBit(p % 30))) {
+				crossOff(s.data(), lo, SEGMENT_BYTES, p);
+			}
+		}
+	} else {
+		// every prime up to sqrt(hi) is already on the table
+		size_t n = size.load(std::memory_order_relaxed);
+
+		for (size_t i = 3; i < n; i++) {
+			unsigned long long p = at(i);
+
+			if (p * p >= hi) {
+				break;
+			}
+
+			crossOff(s.data(), lo, SEGMENT_BYTES, p);
+		}
 	}
 
-	if(primes.size()) {
-		for (unsigned long long i = primes[primes.size() - 1]; i < n; ++i) {
-			for (
-					 size_t j=0;
-					 (j < primes.size()) &&
-						 (primes[j] <= lp[i]) &&
-						 (i * primes[j] <= lp.size());
-					 ++j) {
+	for (size_t i = 0; i < SEGMENT_BYTES; i++) {
+		for (int k = 0; k < 8; k++) {
+			unsigned long long p = lo + 30 * i + wheel[k];
 
-				lp[i * primes[j]] = primes[j];
+			if (!(s[i] & (1 << k)) && p < 4294967296ULL) {
+				found.push_back((uint32_t)p);
 			}
 		}
 	}
 
-	for (unsigned long long i= (n == 0 ? 2 : n); i < lp.size(); ++i) {
-		if (lp[i] == 0) {
-			lp[i] = i;
+	size_t n = size.load(std::memory_order_relaxed);
+
+	for (size_t i = 0; i < found.size(); i++, n++) {
+		uint32_t *c = chunks[n >> CHUNK_BITS].load(std::memory_order_relaxed);
+
+		if (c == nullptr) {
+			c = new uint32_t[CHUNK_SIZE];
 
-			primes.push_back(i);
+			chunks[n >> CHUNK_BITS].store(c, std::memory_order_relaxed);
 		}
 
-		for (size_t j=0; j < primes.size() && primes[j]<=lp[i] && i*primes[j] < lp.size(); ++j)
-			lp[i * primes[j]] = primes[j];
+		c[n & (CHUNK_SIZE - 1)] = found[i];
+	}
+
+	// publish the new primes, the release pairs with the acquire
+	// of the readers, so they see the chunks and their contents
+	size.store(n, std::memory_order_release);
+	high.store(std::min(hi, 4294967296ULL), std::memory_order_release);
+}
+
+void Primes::growToIndex(size_t idx) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	while (idx >= size.load(std::memory_order_relaxed)) {
+		sieveNextSegment();
+	}
+}
+
+void Primes::growToValue(unsigned long long x) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	while (x >= high.load(std::memory_order_relaxed)) {
+		sieveNextSegment();
+	}
+}
+
+void Primes::reserve(size_t n) {
+	if (n > size.load(std::memory_order_acquire)) {
+		growToIndex(n - 1);
+	}
+}
+
+size_t Primes::countUpTo(unsigned long long x) {
+	if (x >= high.load(std::memory_order_acquire)) {
+		growToValue(x);
+	}
+
+	// binary search for the first prime bigger than x
+	size_t l = 0;
+	size_t r = size.load(std::memory_order_acquire);
+
+	while (l < r) {
+		size_t m = l + (r - l) / 2;
+
+		if (at(m) <= x) {
+			l = m + 1;
+		} else {
+			r = m;
+		}
 	}
+
+	return l;
+}
+
+unsigned long long Primes::after(unsigned long long x) {
+	return (*this)[countUpTo(x)];
 }
 
 std::vector<unsigned long long> Primes::factorsOf(unsigned long long i) {
@@ -72,13 +206,305 @@ std::vector<unsigned long long> Primes::factorsOf(unsigned long long i) {
 
 	std::vector<unsigned long long> f;
 
-	while (k != 1) {
-		f.push_back(lp[k]);
+	if (i < 2) {
+		return f;
+	}
+
+	// trial division by the primes of the first segment
+	for (size_t j = 0; j < 6542 && k > 1; j++) {
+		unsigned long long p = at(j);
 
-		while(k % f.back() == 0) {
-			k = k / f.back();
+		if (p * p > k) {
+			break;
 		}
+
+		if (k % p == 0) {
+			f.push_back(p);
+
+			while (k % p == 0) {
+				k = k / p;
+			}
+		}
+	}
+
+	if (k == 1) {
+		return f;
+	}
+
+	if (k < 4294967296ULL || isPrime(Int(k))) {
+		// k has no factors smaller than 2^16
+		f.push_back(k);
+
+		return f;
+	}
+
+	std::vector<std::pair<Int, unsigned long long>> F = factorInt(Int(k));
+
+	for (size_t j = 0; j < F.size(); j++) {
+		// a factor bigger than LLONG_MAX can only be k itself
+		f.push_back(F[j].first > Int(LLONG_MAX) ? k : F[j].first.longValue());
 	}
 
 	return f;
 }
+
+// References:
+// [1] Baillie, Robert and Wagstaff, Samuel S. Lucas Pseudoprimes
+// [2] Crandall, Richard and Pomerance, Carl. Prime Numbers: A
+// Computational Perspective, sections 3.5 and 3.6
+
+// primes used to discard candidates by trial division
+static const unsigned smallPrimes[] = {
+		2,   3,   5,   7,   11,  13,  17,  19,  23,  29,  31,  37,  41,  43,
+		47,  53,  59,  61,  67,  71,  73,  79,  83,  89,  97,  101, 103, 107,
+		109, 113, 127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181,
+		191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251};
+
+// Miller-Rabin strong probable prime test of the odd n > 2 to the base a,
+// where n - 1 = d*2^s with d odd, see [2] Algorithm 3.5.2.
+static bool isStrongProbablePrime(const ModContext &m, const Int &a,
+                                  const Int &d, size_t s) {
+	const Int &n = m.modulus();
+
+	Int x = m.pow(a, d);
+
+	if (x == 1 || x == n - 1) {
+		return true;
+	}
+
+	for (size_t r = 1; r < s; r++) {
+		x = m.mul(x, x);
+
+		if (x == n - 1) {
+			return true;
+		}
+
+		if (x == 1) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+// Jacobi symbol (a/n) for an odd n > 0, see [2] Algorithm 2.3.5
+static int jacobi(Int a, Int n) {
+	int t = 1;
+
+	a = a % n;
+
+	if (a < 0) {
+		a += n;
+	}
+
+	while (a != 0) {
+		while (a % 2 == 0) {
+			a /= 2;
+
+			long long r = (n % 8).longValue();
+
+			if (r == 3 || r == 5) {
+				t = -t;
+			}
+		}
+
+		std::swap(a, n);
+
+		if (a % 4 == 3 && n % 4 == 3) {
+			t = -t;
+		}
+
+		a %= n;
+	}
+
+	return n == 1 ? t : 0;
+}
+
+// x/2 mod n for an odd n and 0 <= x < n
+static Int half(const Int &x, const Int &n) {
+	return x % 2 == 0 ? x / 2 : (x + n) / 2;
+}
+
+// Strong Lucas probable prime test of the odd n > 2 that is not a
+// perfect square, with the parameters chosen by the method A of
+// Selfridge, see [1] section 5 and [2] section 3.6.1.
+static bool isStrongLucasProbablePrime(const Int &n) {
+	long long D = 5;
+
+	while (true) {
+		int j = jacobi(D, n);
+
+		if (j == -1) {
+			break;
+		}
+
+		if (j == 0 && n != (D < 0 ? -D : D)) {
+			return false;
+		}
+
+		D = D < 0 ? -D + 2 : -D - 2;
+	}
+
+	// P = 1 and Q = (1 - D)/4
+	ModContext m(n, false);
+
+	Int Q = m.reduce((1 - D) / 4);
+
+	Int d = n + 1;
+
+	size_t s = 0;
+
+	while (d % 2 == 0) {
+		d /= 2;
+		s++;
+	}
+
+	// U_k, V_k and Q^k for the prefixes k of the bits of d
+	Int U = 0;
+	Int V = 2;
+	Int Qk = 1;
+
+	std::vector<bool> bits;
+
+	for (Int e = d; e > 0; e /= 2) {
+		bits.push_back(e % 2 == 1);
+	}
+
+	for (size_t i = bits.size(); i-- > 0;) {
+		// U_2k = U_k*V_k, V_2k = V_k^2 - 2*Q^k
+		U = m.mul(U, V);
+		V = m.sub(m.mul(V, V), m.add(Qk, Qk));
+		Qk = m.mul(Qk, Qk);
+
+		if (bits[i]) {
+			// U_k+1 = (U_k + V_k)/2, V_k+1 = (D*U_k + V_k)/2
+			Int u = half(m.add(U, V), n);
+			Int v = half(m.add(m.mul(D, U), V), n);
+
+			U = u;
+			V = v;
+			Qk = m.mul(Qk, Q);
+		}
+	}
+
+	if (U == 0 || V == 0) {
+		return true;
+	}
+
+	for (size_t r = 1; r < s; r++) {
+		V = m.sub(m.mul(V, V), m.add(Qk, Qk));
+		Qk = m.mul(Qk, Qk);
+
+		if (V == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool isPrime(const Int &n) {
+	if (n < 2) {
+		return false;
+	}
+
+	for (unsigned q : smallPrimes) {
+		if (n == q) {
+			return true;
+		}
+
+		if (n % q == 0) {
+			return false;
+		}
+	}
+
+	// n has no factor smaller than 256
+	if (n < 65536) {
+		return true;
+	}
+
+	Int d = n - 1;
+
+	size_t s = 0;
+
+	while (d % 2 == 0) {
+		d /= 2;
+		s++;
+	}
+
+	ModContext m(n, false);
+
+	if (n < Int(ULLONG_MAX)) {
+		// the first 12 primes are enough for n < 3.18*10^23
+		for (size_t i = 0; i < 12; i++) {
+			if (!isStrongProbablePrime(m, smallPrimes[i], d, s)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	if (!isStrongProbablePrime(m, 2, d, s)) {
+		return false;
+	}
+
+	Int r = isqrt(n);
+
+	if (r * r == n) {
+		return false;
+	}
+
+	return isStrongLucasProbablePrime(n);
+}
+
+Int nextPrime(const Int &n) {
+	if (n < 2) {
+		return 2;
+	}
+
+	// the table already covers n, it stops at 2^32 so the primes after
+	// 4294967291, the last one below it, are searched with isPrime
+	if (n < Int(primes.limit()) && n < Int(4294967291ULL)) {
+		return Int(primes.after(Int(n).longValue()));
+	}
+
+	Int p = n + 1;
+
+	if (p % 2 == 0 && p != 2) {
+		p += 1;
+	}
+
+	while (!isPrime(p)) {
+		p += 2;
+	}
+
+	return p;
+}
+
+Int randomPrime(size_t bits) {
+	if (bits < 2) {
+		raise(error(ErrorCode::ARG_IS_INVALID, 0));
+	}
+
+	static thread_local std::mt19937_64 rng(std::random_device{}());
+
+	Int top = pow(Int(2), Int((unsigned long long)bits - 1));
+
+	while (true) {
+		Int p = 0;
+
+		for (size_t i = 0; i < bits; i += 32) {
+			p = p * Int(4294967296ULL) + Int((unsigned long long)(rng() >> 32));
+		}
+
+		// keep the lower bits - 1 bits and set the top one
+		p = top + p % top;
+
+		p = nextPrime(p - 1);
+
+		if (p < 2 * top) {
+			return p;
+		}
+	}
+}
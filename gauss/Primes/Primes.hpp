@@ -1,31 +1,104 @@
 #ifndef PRIMES_H
 #define PRIMES_H
 
+#include "gauss/Algebra/Integer.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
+// Table of the primes below 2^32 in increasing order. The table grows
+// on demand by a segmented sieve of Eratosthenes over the numbers
+// coprime to 30, that keeps one bit per candidate and needs only one
+// segment and the primes up to the square root of the sieved range as
+// working memory.
+//
+// The primes are stored in fixed size chunks that are never moved, so
+// the primes already computed can be read from many threads without
+// locking, only the growth of the table is serialized.
 class Primes {
 private:
-	// array of primes
-	std::vector<unsigned long long> primes;
+	static const size_t CHUNK_BITS = 16;
+	static const size_t CHUNK_SIZE = (size_t)1 << CHUNK_BITS;
 
-	// array of least prime factor
-	std::vector<unsigned long long> lp;
+	// there are 203280221 primes below 2^32
+	static const size_t MAX_CHUNKS = 4096;
 
-	void cacheMorePrimes();
+	std::atomic<uint32_t *> chunks[MAX_CHUNKS];
 
-public:
+	// number of primes published to the readers
+	std::atomic<size_t> size;
+
+	// every prime smaller than high is on the table
+	std::atomic<unsigned long long> high;
+
+	std::mutex lock;
+
+	// sieve the next segment, the lock should be held
+	void sieveNextSegment();
 
-	Primes();
+	// grow the table until it have more than idx primes
+	void growToIndex(size_t idx);
+
+	// grow the table until every prime up to x is on it
+	void growToValue(unsigned long long x);
+
+	// read a prime already on the table
+	uint32_t at(size_t idx) const {
+		return chunks[idx >> CHUNK_BITS].load(std::memory_order_relaxed)[idx & (CHUNK_SIZE - 1)];
+	}
+
+public:
+	// precomputes at least the first n primes, the first segment of
+	// the sieve is always computed
+	Primes(size_t n = 0);
 
 	~Primes();
 
-	unsigned int count();
+	Primes(const Primes &) = delete;
+	Primes &operator=(const Primes &) = delete;
 
+	// number of primes already on the table
+	size_t count() const;
+
+	// every prime smaller than the limit is already on the table
+	unsigned long long limit() const;
+
+	// computes at least the first n primes
+	void reserve(size_t n);
+
+	// returns the number of primes smaller than or equal to x
+	size_t countUpTo(unsigned long long x);
+
+	// returns the smallest prime bigger than x, x < 4294967291
+	unsigned long long after(unsigned long long x);
+
+	// returns the distinct prime factors of i in increasing order
 	std::vector<unsigned long long> factorsOf(unsigned long long i);
 
-	int operator[](unsigned int idx);
+	// returns the idx'th prime, starting from 2
+	unsigned long long operator[](size_t idx) {
+		if (idx >= size.load(std::memory_order_acquire)) {
+			growToIndex(idx);
+		}
+
+		return at(idx);
+	}
 };
 
 extern Primes primes;
 
+// returns true if n is prime, the test is deterministic for n < 2^64,
+// bigger numbers are checked with the Baillie-PSW test, that have no
+// known counterexample
+bool isPrime(const Int &n);
+
+// returns the smallest prime bigger than n
+Int nextPrime(const Int &n);
+
+// returns a random prime with exactly the given number of bits, bits >= 2
+Int randomPrime(size_t bits);
+
 #endif
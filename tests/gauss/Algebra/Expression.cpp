@@ -11,6 +11,7 @@
 
 #include "gauss/Algebra/Expression.hpp"
 #include "gauss/Algebra/Reduction.hpp"
+#include "gauss/Algebra/Sorting.hpp"
 
 using namespace alg;
 
@@ -412,6 +413,7 @@ void should_simplify_pows() {
   expr exp4 = pow(symbol("x"), integer(0));
   expr exp5 = pow(integer(0), integer(0));
   expr exp6 = pow(integer(0), integer(3));
+  expr exp7 = pow(pow(integer(0), integer(-1)), integer(2));
 
   expr res_exp0 = reduce(exp0);
   expr res_exp1 = reduce(exp1);
@@ -420,6 +422,7 @@ void should_simplify_pows() {
   expr res_exp4 = reduce(exp4);
   expr res_exp5 = reduce(exp5);
   expr res_exp6 = reduce(exp6);
+  expr res_exp7 = reduce(exp7);
 
   assert(res_exp0 == 4);
   assert(res_exp1 == fraction(1, 4));
@@ -428,6 +431,14 @@ void should_simplify_pows() {
   assert(res_exp4 == 1);
   assert(res_exp5 == undefined());
   assert(res_exp6 == 0);
+  assert(res_exp7 == undefined());
+
+  // 0^-1 reduces to 1/0, merging it with other constants is undefined
+  expr z = pow(integer(0), integer(-1));
+
+  assert(reduce(z + 3) == undefined());
+  assert(reduce(2 * symbol("y") * z) == undefined());
+  assert(reduce(symbol("x") * z + symbol("x")) == undefined());
 }
 
 void should_simplify_divisions() {
@@ -482,6 +493,281 @@ void should_simplify_func_calls() {
 	assert(i == pow(f, 2)*g);
 }
 
+void should_intern_exprs() {
+	expr x = symbol("x");
+	expr y = symbol("y");
+
+	expr a = intern(pow(x + y, 2) * func_call("f", {x}));
+	expr b = intern(pow(x + y, 2) * func_call("f", {x}));
+
+	// structurally equal expressions share their operands
+	assert(a.expr_childs.frozen());
+	assert(a.expr_childs.frozen() == b.expr_childs.frozen());
+
+	// a non const access would copy the operands back to a
+	const operand_list &A = a.expr_childs;
+
+	const expr &p = A[0];
+	const expr &q = A[1];
+
+	assert(p.expr_childs.frozen() && q.expr_childs.frozen());
+	assert(p.expr_childs.frozen() != q.expr_childs.frozen());
+
+	expr c = a;
+
+	assert(c.expr_childs.frozen() == a.expr_childs.frozen());
+	assert(c == b);
+
+	// writes only change the copy that is written
+	c[0][1] = 3;
+
+	assert(!c.expr_childs.frozen());
+	assert(a.expr_childs.frozen() == b.expr_childs.frozen());
+	assert(a == pow(x + y, 2) * func_call("f", {x}));
+	assert(c == pow(x + y, 3) * func_call("f", {x}));
+
+	c.insert(y);
+
+	assert(c == pow(x + y, 3) * func_call("f", {x}) * y);
+	assert(a != c);
+
+	expr d = intern(create(kind::LIST, {x + y}));
+
+	assert(!d.expr_childs.frozen());
+}
+
+void should_intern_identifiers() {
+	expr x = symbol("x");
+	expr y = expr(std::string("y"));
+	expr f = func_call("x", {y});
+
+	// symbols and functions with the same name share the identifier
+	assert(get_sym_id(&x) == get_sym_id(&f));
+	assert(get_id(&x) == get_id(&f));
+	assert(get_sym_id(&x) != get_sym_id(&y));
+
+	assert(get_sym_id(&x) == symbol_id("x"));
+	assert(strcmp(symbol_name(get_sym_id(&y)), "y") == 0);
+	assert(symbol_count() > get_sym_id(&y));
+
+	expr z = x;
+
+	assert(get_id(&z) == get_id(&x));
+	assert(z == x && z != y);
+
+	assert(!f.freeOf(y));
+	assert(f.freeOf(x));
+	assert(!pow(x + y, 2).freeOf(x));
+	assert(pow(x + y, 2).freeOf(symbol("z")));
+}
+
+void should_hash_exprs() {
+	expr x = symbol("x");
+	expr y = symbol("y");
+
+	expr a = x + 2 * y + pow(x, 3);
+	expr b = pow(x, 3) + y * 2 + x;
+	expr c = create(kind::ADD, {x, create(kind::MUL, {fraction(4, 2), y}), pow(x, 3)});
+
+	assert(structural_hash(a) == structural_hash(b));
+	assert(structural_hash(a) == structural_hash(c));
+	assert(a == b);
+
+	expr d = x + 3 * y + pow(x, 3);
+
+	assert(structural_hash(a) != structural_hash(d));
+	assert(a != d);
+
+	// writes through operator[] reset the cached hashes
+	d[1][0] = 2;
+
+	assert(structural_hash(a) == structural_hash(d));
+	assert(a == d);
+
+	d.insert(y);
+
+	assert(structural_hash(a) != structural_hash(d));
+	assert(a != d);
+
+	d.remove(3);
+
+	assert(a == d);
+
+	assert(func_call("f", {x}) != func_call("f", {y}));
+	assert(func_call("f", {x}) == func_call("f", {x}));
+	assert(structural_hash(x) != structural_hash(y));
+}
+
+void should_store_operands_in_place() {
+	expr x = symbol("x");
+	expr y = symbol("y");
+
+	// leaves have no operands node
+	assert(!x.expr_childs.node);
+
+	expr a = create(kind::ADD);
+
+	for (int i = 0; i < 9; i++) {
+		a.insert(i);
+	}
+
+	a.insert(x, 0);
+	a.expr_childs.insert(5, a.expr_childs[0]);
+
+	assert(a.size() == 11);
+	assert(a[0] == x && a[5] == x && a[6] == 4 && a[10] == 8);
+
+	expr b = a;
+
+	b.remove(0);
+	b.remove(4);
+	b.expr_childs.pop_back();
+
+	assert(b.size() == 8);
+	assert(b[0] == 0 && b[4] == 4 && b[7] == 7);
+	assert(a.size() == 11 && a[0] == x);
+
+	expr c = pow(x, y);
+
+	assert(c.expr_childs.node->capacity == 2);
+
+	c.expr_childs.clear();
+
+	assert(c.size() == 0 && !c.expr_childs.node);
+}
+
+void should_sort_big_sums() {
+	expr x = symbol("x");
+
+	expr a = create(kind::ADD);
+
+	for (int i = 20000; i > 0; i--) {
+		a.insert(pow(x, i));
+	}
+
+	a.insert(3, 0);
+	a.insert(fraction(1, 2));
+
+	sort_childs(&a, 0, size_of(&a) - 1);
+
+	// the higher degrees go first and the constants last on sums
+	assert(a[0] == pow(x, 20000));
+	assert(a[19999] == pow(x, 1));
+	assert(a[20000] == 3 && a[20001] == fraction(1, 2));
+
+	for (size_t i = 0; i + 1 < size_of(&a); i++) {
+		assert(compare(operand(&a, i), operand(&a, i + 1), kind::ADD) <= 0);
+	}
+
+	// sorted operands are left as they are
+	sort_childs(&a, 0, size_of(&a) - 1);
+
+	assert(a[0] == pow(x, 20000) && a[20001] == fraction(1, 2));
+}
+
+void should_collect_like_terms() {
+	expr x = symbol("x");
+	expr y = symbol("y");
+	expr n = symbol("n");
+	expr m = symbol("m");
+
+	assert(reduce(x + y + 2 * x + -1 * y + 3) == 3 * x + 3);
+	assert(reduce(x * y + 3 + 2 * y * x + -1 * x * y) == 2 * x * y + 3);
+	assert(reduce(x * y * pow(x, 2) * pow(y, -1) * 3 * x) == 3 * pow(x, 4));
+	assert(reduce(pow(x, n) * pow(x, m) * x) == pow(x, m + n + 1));
+
+	// 0^-1 reduces to 1/0, it is not collected, but the like terms next
+	// to it are, and it folds to undefined when merged with constants
+	expr z = pow(integer(0), integer(-1));
+
+	assert(to_string(reduce(x + 2 * x + z + y + 3 * y)) == "3*x + 4*y + 1/0");
+	assert(to_string(reduce(x * z * pow(x, 2) * y * y)) == "(1/0)*x^3*y^2");
+	assert(to_string(reduce(y * z)) == "(1/0)*y");
+	assert(reduce(0 * z) == 0);
+	assert(reduce(x + z + 2 * x + fraction(1, 2)) == undefined());
+	assert(reduce(x * z + x) == undefined());
+	assert(reduce(x * y * z + 2 * x * y) == undefined());
+
+	// like terms far from each other on a big sum
+	expr a = create(kind::ADD);
+	expr b = create(kind::ADD);
+
+	for (int i = 0; i < 100000; i++) {
+		a.insert(create(kind::MUL, {integer(i % 2 + 1), pow(x, i % 50), y}));
+	}
+
+	for (int e = 0; e < 50; e++) {
+		b.insert(create(kind::MUL, {integer(2000 * (e % 2 + 1)), pow(x, e), y}));
+	}
+
+	a = reduce(a);
+
+	assert(size_of(&a) == 50);
+	assert(a == reduce(b));
+}
+
+void should_handle_deep_trees() {
+	expr x = symbol("x");
+	expr y = symbol("y");
+	expr z = symbol("z");
+
+	// y*(y*(...*(y*x))) and x^(x^(...^x)), too deep for recursive
+	// traversals on the stack of a thread
+	long depth = 200000;
+
+	expr m = x;
+	expr p = x;
+
+	for (long i = 0; i < depth; i++) {
+		expr t = create(kind::MUL, {y});
+		t.insert(std::move(m));
+		m = std::move(t);
+
+		expr u = create(kind::POW, {x});
+		u.insert(std::move(p));
+		p = std::move(u);
+	}
+
+	expr c = m;
+	expr q = p;
+
+	assert(structural_hash(c) == structural_hash(m));
+	assert(c == m);
+	assert(q == p);
+
+	assert(to_string(m).size() == 4 * (size_t)depth - 1);
+	assert(to_string(p).size() == 2 * (size_t)depth + 1);
+
+	assert(p.freeOf(y));
+	assert(!m.freeOf(x));
+
+	expr r = replace(m, y, z);
+
+	assert(r.freeOf(y));
+	assert(!r.freeOf(z));
+
+	sort(&q, kind::UNDEF);
+	assert(compare(&q, &p, kind::UNDEF) == 0);
+
+	assert(reduce(m) == x * pow(y, depth));
+	assert(expand(m) == x * pow(y, depth));
+
+	intern(&c);
+	assert(c == m);
+
+	// y/(y/(...(y/x))), the divisions are rewritten to products before
+	// their operands are reduced, and y/(y/x) is x
+	expr d = x;
+
+	for (long i = 0; i < depth; i++) {
+		expr t = create(kind::DIV, {y});
+		t.insert(std::move(d));
+		d = std::move(t);
+	}
+
+	assert(reduce(d) == x);
+}
+
 int main() {
   TEST(should_construct_expr)
   TEST(should_eval_equality)
@@ -497,5 +783,12 @@ int main() {
   TEST(should_simplify_divisions)
 	TEST(should_simplify_expressions_matrix)
 	TEST(should_simplify_func_calls)
+	TEST(should_intern_exprs)
+	TEST(should_intern_identifiers)
+	TEST(should_hash_exprs)
+	TEST(should_store_operands_in_place)
+	TEST(should_sort_big_sums)
+	TEST(should_collect_like_terms)
+	TEST(should_handle_deep_trees)
   return 0;
 }
@@ -0,0 +1,100 @@
+#include "gauss/Algebra/FixedInt.hpp"
+#include "test.hpp"
+
+#include <cassert>
+
+void should_operate_on_fixed_ints() {
+	Int a = pow(Int(2), Int(100)) + 12345;
+	Int b = pow(Int(3), Int(60)) + 7;
+
+	fint<2> x = fint<2>::fromInt(a);
+	fint<2> y = fint<2>::fromInt(b);
+
+	assert(x.toInt() == a);
+	assert(y.toInt() == b);
+
+	assert(fint<2>::compare(x, y) == 1);
+	assert(fint<2>::compare(y, x) == -1);
+	assert(fint<2>::compare(x, x) == 0);
+
+	fint<2> z;
+
+	assert(fint<2>::add(x, y, z) == 0);
+	assert(z.toInt() == a + b);
+
+	assert(fint<2>::sub(x, y, z) == 0);
+	assert(z.toInt() == a - b);
+
+	assert(fint<2>::sub(y, x, z) == 1);
+	assert(z.toInt() == pow(Int(2), Int(128)) + b - a);
+
+	fint<4> w;
+
+	fint<2>::mul(x, y, w);
+
+	assert(w.toInt() == a * b);
+	assert(x.widen<4>().toInt() == a);
+
+	assert(fint<2>::zero().isZero());
+	assert(!fint<2>::word(1).isZero());
+}
+
+template <size_t N> void check_montgomery(const Int &m) {
+	fint_mod<N> M(m);
+
+	Int a = m / 3 + 11;
+	Int b = m - 5;
+	Int c = Int(0) - m / 7;
+
+	fint<N> x = M.to(a);
+	fint<N> y = M.to(b);
+	fint<N> z = M.to(c);
+
+	assert(M.from(x).toInt() == a % m);
+	assert(M.from(z).toInt() == (c % m + m) % m);
+
+	assert(M.from(M.mul(x, y)).toInt() == (a * b) % m);
+	assert(M.from(M.add(x, y)).toInt() == (a + b) % m);
+	assert(M.from(M.sub(x, y)).toInt() == (a - b + m) % m);
+	assert(M.from(M.sub(y, x)).toInt() == (b - a) % m);
+	assert(M.from(M.mul(x, z)).toInt() == ((a * c) % m + m) % m);
+}
+
+void should_operate_on_montgomery_residues() {
+#ifdef __SIZEOF_INT128__
+	check_montgomery<2>(pow(Int(3), Int(79)));
+	check_montgomery<4>(pow(Int(5), Int(107)));
+	check_montgomery<8>(pow(Int(7), Int(181)));
+#endif
+}
+
+struct Kernel {
+	size_t limbs;
+
+	template <size_t N> void run() { limbs = N; }
+};
+
+void should_dispatch_on_the_bit_length() {
+	Kernel k;
+
+	k.limbs = 0;
+
+#ifdef __SIZEOF_INT128__
+	assert(dispatchLimbs(100, k) && k.limbs == 2);
+	assert(dispatchLimbs(126, k) && k.limbs == 2);
+	assert(dispatchLimbs(127, k) && k.limbs == 4);
+	assert(dispatchLimbs(510, k) && k.limbs == 8);
+
+	k.limbs = 0;
+
+	assert(!dispatchLimbs(511, k) && k.limbs == 0);
+#else
+	assert(!dispatchLimbs(100, k) && k.limbs == 0);
+#endif
+}
+
+int main() {
+	TEST(should_operate_on_fixed_ints)
+	TEST(should_operate_on_montgomery_residues)
+	TEST(should_dispatch_on_the_bit_length)
+}
@@ -602,6 +602,429 @@ void should_get_sqrt_of_bints() {
 	delete r;
 }
 
+bint<30> *random_bint(size_t n, unsigned long long *seed) {
+	bint<30> *a = new bint<30>();
+
+	a->resize(n);
+
+	for (size_t i = 0; i < n; i++) {
+		*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		a->digit[i] = (*seed >> 33) & ((1 << 30) - 1);
+	}
+
+	if (n) a->digit[n - 1] |= 1;
+
+	return a;
+}
+
+void should_multiply_large_bints() {
+	unsigned long long seed = 42;
+
+	size_t sizes[] = {1, 7, 39, 40, 41, 80, 119, 120, 121, 250, 400, 777};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(size_t); i++) {
+		for (size_t j = 0; j < sizeof(sizes) / sizeof(size_t); j++) {
+			bint<30> *a = random_bint(sizes[i], &seed);
+			bint<30> *b = random_bint(sizes[j], &seed);
+
+			bint<30> *c = new bint<30>();
+			bint<30> *d = new bint<30>();
+
+			b->sign = -1;
+
+			bint<30>::mul(a, b, c);
+
+			d->resize(a->size + b->size);
+
+			bint<30>::digits_mul_basecase(a->digit, a->size, b->digit, b->size, d->digit);
+
+			d->trim();
+			d->sign = -1;
+
+			assert(bint<30>::compare(c, d) == 0);
+
+			delete a;
+			delete b;
+			delete c;
+			delete d;
+		}
+	}
+}
+
+void should_square_large_bints() {
+	unsigned long long seed = 7;
+
+	size_t sizes[] = {1, 3, 63, 64, 65, 100, 159, 160, 161, 300, 1000};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(size_t); i++) {
+		bint<30> *a = random_bint(sizes[i], &seed);
+
+		bint<30> *c = new bint<30>();
+		bint<30> *d = new bint<30>();
+
+		bint<30>::mul(a, a, c);
+
+		d->resize(2 * a->size);
+
+		bint<30>::digits_mul_basecase(a->digit, a->size, a->digit, a->size, d->digit);
+
+		d->trim();
+
+		assert(bint<30>::compare(c, d) == 0);
+
+		delete a;
+		delete c;
+		delete d;
+	}
+}
+
+void should_divide_large_bints() {
+	unsigned long long seed = 11;
+
+	size_t sizes[][2] = {{130, 60},	 {200, 61},		{300, 100},	 {1000, 300},
+											 {1000, 999}, {2000, 1000}, {9000, 4100}, {49000, 16000}};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		bint<30> *a = random_bint(sizes[i][0], &seed);
+		bint<30> *b = random_bint(sizes[i][1], &seed);
+
+		if (i % 2) {
+			a->sign = -1;
+		}
+
+		if (i % 3 == 1) {
+			b->sign = -1;
+		}
+
+		bint<30> *q = new bint<30>();
+		bint<30> *r = new bint<30>();
+		bint<30> *t = new bint<30>();
+		bint<30> *s = new bint<30>();
+
+		bint<30>::div(a, b, q, r);
+
+		assert(q->sign == a->sign * b->sign);
+		assert(r->size == 0 || r->sign == a->sign * b->sign);
+
+		// |a| = |q|*|b| + |r| and |r| < |b|
+		a->sign = b->sign = q->sign = r->sign = 1;
+
+		bint<30>::mul(q, b, t);
+		bint<30>::add(t, r, s);
+
+		assert(bint<30>::compare(s, a) == 0);
+		assert(bint<30>::compare(r, b) < 0);
+
+		delete a;
+		delete b;
+		delete q;
+		delete r;
+		delete t;
+		delete s;
+	}
+}
+
+void should_get_gcd_of_large_bints() {
+	unsigned long long seed = 13;
+
+	size_t sizes[] = {2, 3, 10, 100, 700, 1500};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(size_t); i++) {
+		bint<30> *g = random_bint(sizes[i] / 2 + 1, &seed);
+		bint<30> *a = random_bint(sizes[i], &seed);
+		bint<30> *b = random_bint(sizes[i] + i % 2, &seed);
+
+		bint<30> *x = new bint<30>();
+		bint<30> *y = new bint<30>();
+
+		bint<30>::mul(a, g, x);
+		bint<30>::mul(b, g, y);
+
+		y->sign = -1;
+
+		// euclidean algorithm
+		bint<30> *u = x->copy();
+		bint<30> *v = y->copy();
+
+		u->sign = v->sign = 1;
+
+		while (v->size) {
+			bint<30> *q = new bint<30>();
+			bint<30> *r = new bint<30>();
+
+			bint<30>::div(u, v, q, r);
+
+			delete q;
+			delete u;
+
+			u = v;
+			v = r;
+		}
+
+		bint<30> *h = bint<30>::gcd(x, y);
+
+		assert(bint<30>::compare(h, u) == 0);
+
+		bint<30> *s = new bint<30>();
+		bint<30> *t = new bint<30>();
+
+		bint<30> *k = bint<30>::xgcd(x, y, s, t);
+
+		assert(bint<30>::compare(k, u) == 0);
+
+		bint<30> *p = new bint<30>();
+		bint<30> *w = new bint<30>();
+		bint<30> *z = new bint<30>();
+
+		bint<30>::mul(s, x, p);
+		bint<30>::mul(t, y, w);
+		bint<30>::add(p, w, z);
+
+		assert(bint<30>::compare(z, u) == 0);
+
+		delete g;
+		delete a;
+		delete b;
+		delete x;
+		delete y;
+		delete u;
+		delete v;
+		delete h;
+		delete s;
+		delete t;
+		delete k;
+		delete p;
+		delete w;
+		delete z;
+	}
+}
+
+void should_convert_large_bints_to_and_from_strings() {
+	unsigned long long seed = 17;
+
+	std::string p = "1" + std::string(1000, '0');
+
+	bint<30> *t = bint<30>::from_string(p.c_str(), p.size());
+
+	assert(t->to_string() == p);
+
+	delete t;
+
+	size_t sizes[] = {1, 39, 40, 41, 100, 1000, 5000};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(size_t); i++) {
+		bint<30> *a = random_bint(sizes[i], &seed);
+
+		if (i % 2) {
+			a->sign = -1;
+		}
+
+		// quadratic conversion
+		std::string s(bint<30>::decimal_size(a) + 1, '\0');
+
+		char *out = &s[0];
+
+		if (a->sign < 0) {
+			*out++ = '-';
+		}
+
+		s.resize(bint<30>::to_chars_basecase(a, out, 0) - &s[0]);
+
+		assert(a->to_string() == s);
+
+		char buf[32];
+
+		assert(a->to_chars(buf, sizeof(buf)) == s.size());
+		assert(s.size() >= sizeof(buf) || s == buf);
+
+		bint<30> *b = bint<30>::from_string(s.c_str(), s.size());
+
+		assert(bint<30>::compare(a, b) == 0);
+
+		delete a;
+		delete b;
+	}
+}
+
+void should_grow_bints_past_inline_digits() {
+	const size_t n = bint<30>::inline_digits;
+
+	bint<30> *a = bint<30>::from(1);
+	bint<30> *b = bint<30>::from(3);
+	bint<30> *c = a->copy();
+
+	// a = 2^(30*(2*n)) grows from the inline digits to the heap
+	for (size_t i = 0; i < 2 * n; i++) {
+		bint<30> *t = bint<30>::from(1 << 30);
+		bint<30>::mul_in_place(a, t);
+		delete t;
+
+		assert(a->size == i + 2);
+		assert(a->digit[i + 1] == 1);
+		assert(a->capacity >= a->size);
+	}
+
+	assert(a->digit != a->local);
+	assert(b->digit == b->local);
+
+	a->swap(b);
+
+	assert(a->size == 1 && a->digit[0] == 3 && a->digit == a->local);
+	assert(b->size == 2 * n + 1 && b->digit[2 * n] == 1);
+
+	c->set(b);
+	assert(bint<30>::compare(c, b) == 0);
+
+	// shrinking keeps the memory that was already allocated
+	bint<30>::div_in_place(c, b, true);
+	assert(c->size == 1 && c->digit[0] == 1);
+	assert(c->capacity >= 2 * n + 1);
+
+	c->swap(a);
+	assert(a->size == 1 && a->digit[0] == 1);
+	assert(c->size == 1 && c->digit[0] == 3 && c->digit == c->local);
+
+	delete a;
+	delete b;
+	delete c;
+}
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef bint<62, uint64_t, unsigned __int128, int64_t, __int128>
+    bint62;
+
+// converts a bint to the 62 bits backend packing its bits
+bint62 *to_bint62(bint<30> *a) {
+	bint62 *b = new bint62();
+
+	b->resize((a->size * 30 + 61) / 62);
+
+	for (size_t i = 0; i < a->size * 30; i++) {
+		if ((a->digit[i / 30] >> (i % 30)) & 1) {
+			b->digit[i / 62] |= (uint64_t)1 << (i % 62);
+		}
+	}
+
+	b->sign = a->sign;
+	b->trim();
+
+	return b;
+}
+
+bool same_value(bint<30> *a, bint62 *b) {
+	bint62 *c = to_bint62(a);
+
+	bool r = bint62::compare(c, b) == 0;
+
+	delete c;
+
+	return r;
+}
+
+void should_agree_across_backends() {
+	unsigned long long seed = 7;
+
+	size_t sizes[][2] = {{1, 1},		 {2, 1},			{3, 2},				{9, 4},
+											 {40, 21},	 {130, 60},		{300, 290},		{1000, 300},
+											 {3000, 1100}, {9000, 9000}, {30000, 12000}, {40000, 26000}};
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		bint<30> *a = random_bint(sizes[i][0], &seed);
+		bint<30> *b = random_bint(sizes[i][1], &seed);
+
+		if (i % 2) {
+			a->sign = -1;
+		}
+
+		bint62 *x = to_bint62(a);
+		bint62 *y = to_bint62(b);
+
+		if (sizes[i][0] <= 3000) {
+			assert(a->to_string() == x->to_string());
+			assert(b->to_string() == y->to_string());
+		}
+
+		bint<30> *c = new bint<30>();
+		bint<30> *d = new bint<30>();
+
+		bint62 *z = new bint62();
+		bint62 *w = new bint62();
+
+		bint<30>::add(a, b, c);
+		bint62::add(x, y, z);
+		assert(same_value(c, z));
+
+		bint<30>::sub(a, b, c);
+		bint62::sub(x, y, z);
+		assert(same_value(c, z));
+
+		bint<30>::mul(a, b, c);
+		bint62::mul(x, y, z);
+		assert(same_value(c, z));
+
+		bint<30>::mul(a, a, c);
+		bint62::mul(x, x, z);
+		assert(same_value(c, z));
+
+		bint<30>::div(a, b, c, d);
+		bint62::div(x, y, z, w);
+		assert(same_value(c, z));
+		assert(same_value(d, w));
+
+		if (sizes[i][0] <= 3000) {
+			bint<30> *g = bint<30>::gcd(a, b);
+			bint62 *h = bint62::gcd(x, y);
+			assert(same_value(g, h));
+
+			delete g;
+			delete h;
+		}
+
+		bint<30> *e = bint<30>::lshift(a, 77);
+		bint62 *t = bint62::lshift(x, 77);
+		assert(same_value(e, t));
+
+		delete e;
+		delete t;
+
+		long long u = 0;
+		long long v = 0;
+
+		assert(bint<30>::to_long(b, &u) == bint62::to_long(y, &v));
+		assert(u == v);
+
+		delete a;
+		delete b;
+		delete c;
+		delete d;
+		delete x;
+		delete y;
+		delete z;
+		delete w;
+	}
+
+	long long vals[] = {0, 1, -1, 1LL << 40, -(1LL << 62), LLONG_MAX, LLONG_MIN + 1};
+
+	for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); i++) {
+		bint62 *x = bint62::from(vals[i]);
+
+		long long v = 0;
+
+		assert(bint62::to_long(x, &v) == 1 && v == vals[i]);
+		assert(x->to_string() == std::to_string(vals[i]));
+
+		delete x;
+	}
+
+	bint<30> *f = bint<30>::fact(bint<30>::from(2000));
+	bint62 *g = bint62::fact(bint62::from(2000));
+
+	assert(same_value(f, g));
+
+	delete f;
+	delete g;
+}
+#endif
 
 int main() {
 	TEST(should_get_quotient_of_div_by_powers_of_two)
@@ -622,4 +1045,13 @@ int main() {
 	TEST(should_get_ceil_log2)
 	TEST(should_shift_bints)
 	TEST(should_get_sqrt_of_bints)
+	TEST(should_multiply_large_bints)
+	TEST(should_square_large_bints)
+	TEST(should_divide_large_bints)
+	TEST(should_get_gcd_of_large_bints)
+	TEST(should_convert_large_bints_to_and_from_strings)
+	TEST(should_grow_bints_past_inline_digits)
+#ifdef __SIZEOF_INT128__
+	TEST(should_agree_across_backends)
+#endif
 }
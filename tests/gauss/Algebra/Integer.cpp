@@ -1,6 +1,7 @@
 #include "gauss/Algebra/Integer.hpp"
 #include "test.hpp"
 #include <cassert>
+#include <climits>
 
 void should_add_ints() {
 	assert(Int(1) + Int(0) == Int(1));
@@ -63,6 +64,67 @@ void should_pow_ints() {
 	assert(pow(Int(4), 0.5) == 2.0);
 	assert(pow(Int(-3), Int(2)) == Int(9));
 	assert(pow(Int(-3), Int(3)) == Int(-27));
+
+	// exponents with more than 8 digits
+	Int e = pow(Int(2), Int(300)) + 1;
+
+	assert(pow(Int(1), e) == Int(1));
+	assert(pow(Int(-1), e) == Int(-1));
+	assert(pow(Int(-1), e + 1) == Int(1));
+}
+
+Int naive_pow_mod(Int a, Int e, const Int &m) {
+	Int r = 1;
+
+	a = a % m;
+
+	while (e > 0) {
+		if (e % 2 == 1) {
+			r = r * a % m;
+		}
+
+		a = a * a % m;
+		e = e / 2;
+	}
+
+	r = r % m;
+
+	return r < 0 ? r + m : r;
+}
+
+void should_pow_mod_ints() {
+	assert(powMod(Int(3), Int(200), Int(1000007)) ==
+	       naive_pow_mod(Int(3), Int(200), Int(1000007)));
+	assert(powMod(Int(-2), Int(5), Int(7)) == Int(3));
+	assert(powMod(Int(-2), Int(5), Int(-7)) == Int(3));
+	assert(powMod(Int(5), Int(0), Int(7)) == Int(1));
+	assert(powMod(Int(5), Int(10), Int(1)) == Int(0));
+
+	// Fermat's little theorem on the prime 2^521 - 1
+	Int p = pow(Int(2), Int(521)) - 1;
+
+	assert(powMod(Int(3), p - 1, p) == Int(1));
+	assert(powMod(Int(-12345), p - 1, p) == Int(1));
+	assert(powMod(Int(3), p, p) == Int(3));
+
+	Int a = pow(Int(3), Int(150)) + 17;
+	Int e = pow(Int(7), Int(400)) + 3;
+
+	Int m[] = {pow(Int(2), Int(200)), pow(Int(2), Int(200)) + 1,
+	           pow(Int(10), Int(60)) + 7, Int(LLONG_MAX), Int(4294967311LL),
+	           Int(1000000007)};
+
+	for (const Int &n : m) {
+		assert(powMod(a, e, n) == naive_pow_mod(a, e, n));
+		assert(powMod(-a, e, n) == naive_pow_mod(-a, e, n));
+		assert(powMod(a, Int(77), n) == naive_pow_mod(a, Int(77), n));
+	}
+
+	try {
+		powMod(Int(2), Int(-1), Int(7));
+		assert(false);
+	} catch (...) {
+	}
 }
 
 void should_gcd_ints() {
@@ -72,6 +134,22 @@ void should_gcd_ints() {
 	assert(gcd(Int(-4), Int(-2)) == Int(-2));
 }
 
+void should_xgcd_ints() {
+	Int s, t;
+
+	assert(xgcd(Int(240), Int(46), s, t) == Int(2));
+	assert(s * 240 + t * 46 == Int(2));
+
+	assert(xgcd(Int(-3), Int(7), s, t) == Int(1));
+	assert(s * -3 + t * 7 == Int(1));
+
+	Int a = pow(Int(2), Int(100)) * 35;
+	Int b = pow(Int(3), Int(60)) * 35;
+
+	assert(xgcd(a, b, s, t) == Int(35));
+	assert(s * a + t * b == Int(35));
+}
+
 void should_lcm_ints() {
 	assert(lcm(Int(4), Int(2)) == Int(4));
 	assert(lcm(Int(4), Int(3)) == Int(12));
@@ -112,6 +190,117 @@ void should_invert_ints() {
 	assert(+i = 1);
 }
 
+void should_compare_ints() {
+	Int a = pow(Int(7), Int(80));
+	Int b = pow(Int(3), Int(120));
+
+	assert(b < a && a > b);
+	assert(Int(0) - a < Int(0) - b);
+	assert(Int(0) - b > Int(0) - a);
+	assert(Int(0) - a <= Int(0) - a);
+	assert(Int(0) - a < -5 && Int(-5) > Int(0) - a);
+	assert(Int(0) - a < b);
+
+	Int c = Int(0) - pow(Int(2), Int(62)) * 3;
+
+	assert(c < Int(LLONG_MIN) && Int(LLONG_MIN) > c);
+}
+
+void should_convert_ints_from_and_to_strings() {
+	assert(Int::fromString("12") == Int(12));
+	assert(Int::fromString("-907") == Int(-907));
+	assert(Int::fromString("123456789012345678") == Int(123456789012345678));
+
+	Int a = Int::fromString("1267650600228229401496703205376");
+
+	assert(a == pow(Int(2), Int(100)));
+	assert(a.to_string() == "1267650600228229401496703205376");
+
+	char buf[64];
+
+	assert(a.to_chars(buf, sizeof(buf)) == 31);
+	assert(std::string(buf) == "1267650600228229401496703205376");
+	assert(Int(-42).to_chars(buf, sizeof(buf)) == 3);
+	assert(std::string(buf) == "-42");
+}
+
+void should_get_factorials_and_binomials() {
+	assert(fact(Int(0)) == Int(1));
+	assert(fact(Int(5)) == Int(120));
+	assert(fact(Int(25)) == Int::fromString("15511210043330985984000000"));
+
+	Int::bint_t *n = Int::bint_t::from(3000);
+
+	assert(fact(Int(3000)) == Int(Int::bint_t::fact(n)));
+
+	delete n;
+
+	assert(binomial(Int(5), Int(2)) == Int(10));
+	assert(binomial(Int(5), Int(7)) == Int(0));
+	assert(binomial(Int(100), Int(50)) ==
+				 Int::fromString("100891344545564193334812497256"));
+
+	assert(multinomial(Int(10), {Int(2), Int(3), Int(5)}) == Int(2520));
+	assert(multinomial(Int(10), {Int(2), Int(3)}) == Int(302400));
+}
+
+void should_update_ints_in_place() {
+	Int a = Int(LLONG_MAX) - 1;
+
+	a += 10;
+	assert(a == Int(LLONG_MAX) + 9);
+
+	a -= Int(LLONG_MAX);
+	assert(a == Int(9));
+
+	Int b = pow(Int(2), Int(100));
+	Int c = b;
+
+	c += c;
+	assert(c == pow(Int(2), Int(101)));
+
+	c -= b;
+	assert(c == b);
+
+	c *= c;
+	assert(c == pow(Int(2), Int(200)));
+
+	c /= b;
+	assert(c == b);
+
+	c %= Int(1000);
+	assert(c == b % Int(1000));
+
+	c = 7;
+	c *= Int(LLONG_MAX);
+	assert(c == Int(LLONG_MAX) * 7);
+
+	c %= Int(LLONG_MAX);
+	assert(c == Int(0));
+
+	Int d = 3;
+
+	addmul(d, Int(4), Int(5));
+	assert(d == Int(23));
+
+	submul(d, Int(2), Int(20));
+	assert(d == Int(-17));
+
+	addmul(d, b, b);
+	assert(d == b * b - 17);
+
+	submul(d, b, b);
+	assert(d == Int(-17));
+
+	d = 0;
+
+	for (int i = 1; i <= 100; i++) {
+		addmul(d, b, Int(i));
+	}
+
+	assert(d == b * 5050);
+}
+
 int main() {
 	TEST(should_add_ints)
 	TEST(should_sub_ints)
@@ -119,9 +308,15 @@ int main() {
 	TEST(should_div_ints)
 	TEST(should_rem_ints)
 	TEST(should_pow_ints)
+	TEST(should_pow_mod_ints)
 	TEST(should_gcd_ints)
+	TEST(should_xgcd_ints)
 	TEST(should_lcm_ints)
 	TEST(should_copy_ints)
 	TEST(should_increment_and_decrement_ints)
 	TEST(should_invert_ints)
+	TEST(should_compare_ints)
+	TEST(should_convert_ints_from_and_to_strings)
+	TEST(should_get_factorials_and_binomials)
+	TEST(should_update_ints_in_place)
 }
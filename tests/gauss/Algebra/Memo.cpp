@@ -0,0 +1,191 @@
+#include "test.hpp"
+
+#include <cassert>
+#include <thread>
+
+#include "gauss/Algebra/Expression.hpp"
+#include "gauss/Algebra/Memo.hpp"
+#include "gauss/Algebra/Reduction.hpp"
+#include "gauss/Calculus/Derivative.hpp"
+
+using namespace alg;
+
+void should_memoize_reductions() {
+	memo_clear();
+
+	expr x = symbol("x");
+	expr y = symbol("y");
+
+	expr a = x + 2 * y + 3 * x + y;
+
+	expr r0 = reduce(a);
+
+	memo_stats s0 = memo_statistics();
+
+	assert(s0.misses == 1);
+	assert(s0.hits == 0);
+	assert(s0.entries == 1);
+	assert(s0.bytes > 0);
+
+	expr r1 = reduce(x + 2 * y + 3 * x + y);
+
+	memo_stats s1 = memo_statistics();
+
+	assert(s1.hits == 1);
+	assert(r0 == r1);
+	assert(r1 == 4 * x + 3 * y);
+
+	// already reduced expressions are not looked up
+	reduce(r1);
+
+	assert(memo_statistics().hits == 1);
+}
+
+void should_memoize_expansions_and_derivatives() {
+	memo_clear();
+
+	expr x = symbol("x");
+	expr y = symbol("y");
+
+	expr e0 = expand(pow(x + y, 3));
+	expr e1 = expand(pow(x + y, 3));
+
+	assert(e0 == e1);
+
+	expr d0 = calc::derivate(pow(x, 3) + x * y, x);
+	expr d1 = calc::derivate(pow(x, 3) + x * y, x);
+	expr d2 = calc::derivate(pow(x, 3) + x * y, y);
+
+	assert(d0 == d1);
+	assert(d0 == reduce(3 * pow(x, 2) + y));
+	assert(d2 == x);
+
+	memo_stats s = memo_statistics();
+
+	assert(s.hits >= 2);
+	assert(s.misses >= 3);
+}
+
+void should_respect_the_memo_limit() {
+	size_t limit = memo_limit();
+
+	memo_clear();
+
+	expr x = symbol("x");
+
+	for (int i = 0; i < 200; i++) {
+		reduce(x + i + x);
+	}
+
+	size_t full = memo_statistics().bytes;
+
+	memo_set_limit(full / 4);
+
+	memo_stats s = memo_statistics();
+
+	assert(s.bytes <= full / 4);
+	assert(s.entries < 200);
+
+	for (int i = 0; i < 200; i++) {
+		reduce(x + i + x);
+	}
+
+	assert(memo_statistics().bytes <= full / 4);
+
+	// the most recently used entries are kept
+	size_t hits = memo_statistics().hits;
+
+	reduce(x + 199 + x);
+
+	assert(memo_statistics().hits == hits + 1);
+
+	memo_set_limit(0);
+
+	reduce(x + 199 + x);
+
+	assert(memo_statistics().hits == hits + 1);
+
+	memo_set_limit(limit);
+}
+
+void should_use_thread_local_caches() {
+	memo_clear();
+
+	memo_set_thread_local(true);
+
+	expr x = symbol("x");
+
+	reduce(2 * x + x);
+
+	memo_stats s0 = memo_statistics();
+
+	std::thread t([] {
+		expr x = symbol("x");
+
+		reduce(2 * x + x);
+
+		memo_stats s = memo_statistics();
+
+		assert(s.hits == 0);
+		assert(s.misses == 1);
+	});
+
+	t.join();
+
+	assert(memo_statistics().misses == s0.misses);
+
+	memo_clear();
+
+	memo_set_thread_local(false);
+}
+
+void should_not_memoize_matrices() {
+	memo_clear();
+
+	expr x = symbol("x");
+
+	expr I = identity_matrix(2, 2);
+	expr Z = mat(2, 2, {0, 0, 0, 0});
+
+	expr a = reduce(create(kind::ADD, {I, I, x}));
+	expr b = reduce(create(kind::ADD, {Z, Z, x}));
+
+	// matrices on sums are compared by their dimensions, so the members
+	// are checked instead
+	for (size_t i = 0; i < size_of(&b); i++) {
+		if (is(&b[i], kind::MAT)) {
+			assert(mat_get(b[i], 0, 0) == 0);
+			assert(mat_get(a[i], 0, 0) == 2);
+		}
+	}
+
+	memo_stats s = memo_statistics();
+
+	assert(s.hits == 0);
+	assert(s.entries == 0);
+}
+
+void should_be_disabled_by_default() {
+	assert(memo_limit() == 0);
+
+	expr x = symbol("x");
+
+	reduce(x + 2 * x);
+	reduce(x + 2 * x);
+
+	memo_stats s = memo_statistics();
+
+	assert(s.hits == 0 && s.misses == 0 && s.entries == 0);
+}
+
+int main() {
+	TEST(should_be_disabled_by_default)
+
+	memo_set_limit(16 << 20);
+
+	TEST(should_memoize_reductions)
+	TEST(should_memoize_expansions_and_derivatives)
+	TEST(should_respect_the_memo_limit)
+	TEST(should_use_thread_local_caches)
+	TEST(should_not_memoize_matrices)
+}
@@ -0,0 +1,147 @@
+#include "gauss/Algebra/ModContext.hpp"
+#include "test.hpp"
+
+#include <cassert>
+
+Int symmetric_mod(const Int &a, const Int &p) {
+	Int r = a % p;
+
+	if (r < 0) {
+		r += p;
+	}
+
+	if (r > p / 2) {
+		r -= p;
+	}
+
+	return r;
+}
+
+Int positive_mod(const Int &a, const Int &p) {
+	Int r = a % p;
+
+	if (r < 0) {
+		r += p;
+	}
+
+	return r;
+}
+
+Int random_int(const Int &bound, unsigned long long *seed) {
+	Int r = 0;
+
+	for (int i = 0; i < 8; i++) {
+		*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+		r = r * Int(1ULL << 31) + Int((unsigned long long)(*seed >> 33));
+	}
+
+	r = r % bound;
+
+	return (*seed >> 7) & 1 ? -r : r;
+}
+
+void check_context(const Int &p, unsigned long long seed) {
+	ModContext s(p, true);
+	ModContext n(p, false);
+
+	assert(s.modulus() == p);
+	assert(s.isSymmetric() && !n.isSymmetric());
+
+	for (int i = 0; i < 200; i++) {
+		Int a = random_int(p * p * 3, &seed);
+		Int b = random_int(p * 5, &seed);
+
+		assert(s.reduce(a) == symmetric_mod(a, p));
+		assert(n.reduce(a) == positive_mod(a, p));
+
+		assert(s.add(a, b) == symmetric_mod(a + b, p));
+		assert(n.add(a, b) == positive_mod(a + b, p));
+
+		assert(s.sub(a, b) == symmetric_mod(a - b, p));
+		assert(n.sub(a, b) == positive_mod(a - b, p));
+
+		assert(s.mul(a, b) == symmetric_mod(a * b, p));
+		assert(n.mul(a, b) == positive_mod(a * b, p));
+	}
+
+	Int a = random_int(p, &seed);
+
+	assert(n.pow(a, 0) == 1);
+	assert(n.pow(a, 1) == positive_mod(a, p));
+	assert(n.pow(a, 13) == positive_mod(pow(a, Int(13)), p));
+	assert(s.pow(a, 13) == symmetric_mod(pow(a, Int(13)), p));
+}
+
+void should_reduce_modulo_words() {
+	check_context(2, 1);
+	check_context(3, 2);
+	check_context(97, 3);
+	check_context(1024, 4);
+	check_context(1000000007, 5);
+	check_context(Int(4611686018427387847ULL), 6);
+	check_context(Int(9223372036854775783ULL), 7);
+	check_context(Int(9223372036854775806ULL), 8);
+}
+
+void should_reduce_modulo_big_integers() {
+	check_context(pow(Int(2), Int(63)), 9);
+	check_context(pow(Int(2), Int(100)) + 277, 10);
+	check_context(pow(Int(3), Int(200)), 11);
+	check_context(pow(Int(1000000007), Int(7)), 12);
+}
+
+void should_compute_inverses() {
+	ModContext p(97, false);
+
+	for (int a = 1; a < 97; a++) {
+		assert(p.mul(p.inverse(a), a) == 1);
+	}
+
+	assert(p.inverse(-3) == p.inverse(94));
+
+	ModContext q(pow(Int(5), Int(40)), true);
+
+	for (int a = 1; a < 50; a++) {
+		if (a % 5) {
+			assert(q.mul(q.inverse(a), a) == 1);
+		}
+	}
+
+	ModContext w(Int(9223372036854775783ULL), true);
+
+	assert(w.mul(w.inverse(123456789), 123456789) == 1);
+
+	try {
+		p.inverse(194);
+		assert(false);
+	} catch (...) {
+	}
+
+	try {
+		q.inverse(25);
+		assert(false);
+	} catch (...) {
+	}
+}
+
+void should_raise_on_invalid_modulus() {
+	try {
+		ModContext p(1);
+		assert(false);
+	} catch (...) {
+	}
+
+	try {
+		ModContext p(-7);
+		assert(false);
+	} catch (...) {
+	}
+}
+
+int main() {
+	TEST(should_reduce_modulo_words)
+	TEST(should_reduce_modulo_big_integers)
+	TEST(should_compute_inverses)
+	TEST(should_raise_on_invalid_modulus)
+}
@@ -0,0 +1,135 @@
+#include "gauss/Algebra/Int.hpp"
+#include "gauss/Algebra/NTT.hpp"
+#include "test.hpp"
+
+#include <cassert>
+#include <vector>
+
+std::vector<uint32_t> naive_convolution(std::vector<uint32_t> &a,
+                                        std::vector<uint32_t> &b, uint32_t p) {
+	std::vector<uint32_t> c(a.size() + b.size() - 1, 0);
+
+	for (size_t i = 0; i < a.size(); i++) {
+		for (size_t j = 0; j < b.size(); j++) {
+			c[i + j] = (c[i + j] + (uint64_t)a[i] * b[j]) % p;
+		}
+	}
+
+	return c;
+}
+
+std::vector<uint32_t> random_vector(size_t n, uint32_t p, unsigned long long *seed) {
+	std::vector<uint32_t> a(n);
+
+	for (size_t i = 0; i < n; i++) {
+		*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		a[i] = (*seed >> 33) % p;
+	}
+
+	return a;
+}
+
+void should_find_primitive_roots() {
+	assert(ntt::primitiveRoot(7) == 3);
+	assert(ntt::primitiveRoot(17) == 3);
+	assert(ntt::primitiveRoot(ntt::P0) == 3);
+	assert(ntt::primitiveRoot(ntt::P1) == 3);
+	assert(ntt::primitiveRoot(ntt::P2) == 3);
+}
+
+void should_invert_transforms() {
+	unsigned long long seed = 3;
+
+	std::vector<uint32_t> a = random_vector(1024, ntt::P0, &seed);
+	std::vector<uint32_t> b = a;
+
+	ntt::transform(b, ntt::P0);
+
+	assert(a != b);
+
+	ntt::transform(b, ntt::P0, true);
+
+	assert(a == b);
+
+	std::vector<uint32_t> c = random_vector(16, 17, &seed);
+	std::vector<uint32_t> d = c;
+
+	ntt::transform(d, 17);
+	ntt::transform(d, 17, true);
+
+	assert(c == d);
+}
+
+void should_compute_convolutions() {
+	unsigned long long seed = 5;
+
+	uint32_t P[] = {17, 998244353, 1000000007, 2147483647};
+	size_t S[] = {1, 3, 17, 200};
+
+	for (size_t i = 0; i < 4; i++) {
+		for (size_t j = 0; j < 4; j++) {
+			for (size_t k = 0; k < 4; k++) {
+				std::vector<uint32_t> a = random_vector(S[j], P[i], &seed);
+				std::vector<uint32_t> b = random_vector(S[k], P[i], &seed);
+
+				assert(ntt::convolution(a, b, P[i]) == naive_convolution(a, b, P[i]));
+			}
+		}
+	}
+}
+
+void should_multiply_big_integers() {
+	unsigned long long seed = 11;
+
+	size_t S[] = {1, 2, 100, 3000};
+
+	for (size_t i = 0; i < 4; i++) {
+		for (size_t j = 0; j < 4; j++) {
+			std::vector<uint32_t> a = random_vector(S[i], 1 << 30, &seed);
+			std::vector<uint32_t> b = random_vector(S[j], 1 << 30, &seed);
+
+			std::vector<uint32_t> c(a.size() + b.size());
+			std::vector<uint32_t> d(a.size() + b.size());
+
+			ntt::multiply(a.data(), a.size(), b.data(), b.size(), 30, c.data());
+
+			bint<30>::digits_mul_basecase(a.data(), a.size(), b.data(), b.size(), d.data());
+
+			assert(c == d);
+		}
+	}
+
+	std::vector<uint32_t> a = random_vector(500, 1 << 30, &seed);
+
+	std::vector<uint32_t> c(1000);
+	std::vector<uint32_t> d(1000);
+
+	ntt::multiply(a.data(), a.size(), a.data(), a.size(), 30, c.data());
+
+	bint<30>::digits_sqr_basecase(a.data(), a.size(), d.data());
+
+	assert(c == d);
+
+	bint<1> *x = bint<1>::from(123456789);
+	bint<1> *y = bint<1>::from(987654321);
+	bint<1> *z = new bint<1>();
+
+	z->resize(x->size + y->size);
+
+	bint<1>::digits_mul_ntt(x->digit, x->size, y->digit, y->size, z->digit);
+
+	z->trim();
+
+	assert(z->to_string() == "121932631112635269");
+
+	delete x;
+	delete y;
+	delete z;
+}
+
+int main() {
+	TEST(should_find_primitive_roots)
+	TEST(should_invert_transforms)
+	TEST(should_compute_convolutions)
+	TEST(should_multiply_big_integers)
+}
@@ -0,0 +1,113 @@
+#include "gauss/Algebra/Rational.hpp"
+#include "test.hpp"
+
+#include <cassert>
+
+void should_normalize_rationals() {
+	Rational a(6, -4);
+
+	assert(a.num() == -3);
+	assert(a.den() == 2);
+	assert(a.sign() == -1);
+	assert(!a.isInteger());
+
+	Rational b(0, -7);
+
+	assert(b.num() == 0 && b.den() == 1);
+	assert(b.sign() == 0 && b.isInteger());
+
+	Rational c(pow(Int(2), Int(100)), pow(Int(2), Int(98)) * 6);
+
+	assert(c.num() == 2);
+	assert(c.den() == 3);
+
+	try {
+		Rational d(1, 0);
+		assert(false);
+	} catch (...) {
+	}
+
+	Rational e = Rational::coprime(pow(Int(3), Int(40)), -pow(Int(2), Int(70)));
+
+	assert(e.num() == -pow(Int(3), Int(40)));
+	assert(e.den() == pow(Int(2), Int(70)));
+	assert(e == Rational(-pow(Int(3), Int(40)), pow(Int(2), Int(70))));
+}
+
+void should_operate_on_small_rationals() {
+	Rational a(1, 2);
+	Rational b(1, 3);
+
+	assert(a + b == Rational(5, 6));
+	assert(a - b == Rational(1, 6));
+	assert(a * b == Rational(1, 6));
+	assert(a / b == Rational(3, 2));
+	assert(-a == Rational(-1, 2));
+	assert(abs(-a) == a);
+
+	assert((a + a).isInteger());
+	assert((a * 4).num() == 2);
+
+	assert(b < a && a > b && a <= a && a >= b && a != b);
+	assert(Rational(-1, 2) < Rational(-1, 3));
+
+	// harmonic sum 1 + 1/2 + ... + 1/10
+	Rational h;
+
+	for (int i = 1; i <= 10; i++) {
+		h += Rational(1, i);
+	}
+
+	assert(h.num() == 7381);
+	assert(h.den() == 2520);
+
+	try {
+		a / Rational(0);
+		assert(false);
+	} catch (...) {
+	}
+}
+
+void should_operate_on_big_rationals() {
+	Int p = pow(Int(3), Int(60));
+	Int q = pow(Int(7), Int(40));
+
+	Rational a(p, q);
+	Rational b(q, p);
+
+	assert(a * b == 1);
+	assert((a / a).isInteger());
+	assert(a + b - b == a);
+	assert((a - a).sign() == 0);
+
+	Rational c = a * Rational(q, 5);
+
+	assert(c.num() == p);
+	assert(c.den() == 5);
+
+	// the sum is only reduced when it is read
+	Rational h;
+
+	for (int i = 1; i <= 40; i++) {
+		h += Rational(p, Int(i) * q);
+	}
+
+	Rational k;
+
+	for (int i = 1; i <= 40; i++) {
+		k += Rational(1, i);
+	}
+
+	assert(h == k * a);
+	assert(h.num() == (k * a).num());
+	assert(h.den() == (k * a).den());
+
+	assert(a < b);
+	assert(-b < -a);
+}
+
+int main() {
+	TEST(should_normalize_rationals)
+	TEST(should_operate_on_small_rationals)
+	TEST(should_operate_on_big_rationals)
+}
@@ -19,7 +19,56 @@ void should_factorize_polynomials() {
 	assert(factorPoly(f) == (x*y*z + -3)*(x*y*z + 3));
 }
 
+void should_get_prime_factors() {
+	assert(toString(primeFactors(12)) == "2^2*3");
+	assert(toString(primeFactors(-30)) == "-1*2*3*5");
+	assert(toString(primeFactors(pow(Int(2), Int(64)) + 1)) == "274177*67280421310721");
+}
+
+void should_reduce_integer_roots() {
+	assert(toString(reduce(algebra::sqrt(12))) == "2*3^1/2");
+	assert(toString(reduce(root(16, 4))) == "2");
+	assert(toString(reduce(root(250, 3))) == "5*2^1/3");
+	assert(toString(reduce(algebra::sqrt(7))) == "7^1/2");
+}
+
+void should_compute_on_an_arena() {
+	expr x = symbol("x");
+	expr y = symbol("y");
+
+	expr f = algebra::pow(x, 2)*algebra::pow(y, 2) + -9;
+
+	expr g, h, k;
+
+	{
+		ArenaScope scope(4096);
+
+		scope.keep(g);
+		scope.keep(k);
+
+		g = factorPoly(f);
+		h = scope.escape(algebra::expand(algebra::pow(x + y + 1, 4)));
+
+		{
+			ArenaScope inner;
+
+			inner.keep(k);
+
+			k = algebra::expand((x + 1)*(x + -1)*Int(pow(Int(2), Int(80))));
+		}
+
+		assert(scope.used() > 0);
+	}
+
+	assert(g == (x*y + -3)*(x*y + 3));
+	assert(h == algebra::expand(algebra::pow(x + y + 1, 4)));
+	assert(k == algebra::expand((x + 1)*(x + -1)*Int(pow(Int(2), Int(80)))));
+}
+
 int main() {
 	TEST(should_factorize_polynomials)
+	TEST(should_get_prime_factors)
+	TEST(should_reduce_integer_roots)
+	TEST(should_compute_on_an_arena)
 		return 0;
 }
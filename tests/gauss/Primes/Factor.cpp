@@ -0,0 +1,111 @@
+#include "gauss/Primes/Factor.hpp"
+#include "gauss/Primes/Primes.hpp"
+#include "test.hpp"
+
+#include <cassert>
+
+typedef std::vector<std::pair<Int, unsigned long long>> factors;
+
+Int product(const factors &f) {
+	Int r = 1;
+
+	for (size_t i = 0; i < f.size(); i++) {
+		r *= pow(f[i].first, Int(f[i].second));
+	}
+
+	return r;
+}
+
+void check_factors(const Int &n, const factors &f) {
+	assert(product(f) == abs(n));
+
+	for (size_t i = 0; i < f.size(); i++) {
+		assert(isPrime(f[i].first));
+		assert(i == 0 || f[i - 1].first < f[i].first);
+	}
+}
+
+void should_get_integer_roots() {
+	assert(iroot(0, 3) == 0);
+	assert(iroot(1, 3) == 1);
+	assert(iroot(26, 3) == 2);
+	assert(iroot(27, 3) == 3);
+	assert(iroot(28, 3) == 3);
+	assert(iroot(pow(Int(10), Int(40)), 2) == pow(Int(10), Int(20)));
+	assert(iroot(pow(Int(10), Int(40)) - 1, 2) == pow(Int(10), Int(20)) - 1);
+	assert(iroot(pow(Int(3), Int(100)), 5) == pow(Int(3), Int(20)));
+}
+
+void should_find_factors_with_each_method() {
+	// 2^64 + 1 = 274177*67280421310721
+	Int n = pow(Int(2), Int(64)) + 1;
+
+	Int d = pollardRho(n, 1, 1 << 20);
+	assert(d == 274177 || d == Int(67280421310721LL));
+
+	// 892371481 - 1 = 2^3*3*5*7*11*13*17*19*23 and the other prime q
+	// is such that (q - 1)/2 is prime
+	d = pollardPm1(Int(892371481) * Int(1000000000547LL), 100, 1000);
+	assert(d == 892371481);
+
+	n = Int(1000000000039LL) * Int(1000000000061LL);
+
+	d = ecm(n, 2000, 200000, 200);
+	assert(d == Int(1000000000039LL) || d == Int(1000000000061LL));
+
+	d = quadraticSieve(n);
+	assert(d == Int(1000000000039LL) || d == Int(1000000000061LL));
+
+	n = (pow(Int(10), Int(15)) + 37) * (pow(Int(10), Int(16)) + 61);
+
+	d = quadraticSieve(n);
+	assert(d == pow(Int(10), Int(15)) + 37 || d == pow(Int(10), Int(16)) + 61);
+
+}
+
+void should_factor_ints() {
+	assert(factorInt(0).empty());
+	assert(factorInt(1).empty());
+	assert(factorInt(-1).empty());
+
+	factors f = factorInt(-360);
+
+	assert(f.size() == 3);
+	assert(f[0].first == 2 && f[0].second == 3);
+	assert(f[1].first == 3 && f[1].second == 2);
+	assert(f[2].first == 5 && f[2].second == 1);
+
+	for (long long n = 2; n < 3000; n++) {
+		check_factors(n, factorInt(n));
+	}
+
+	Int p = Int(1000000007);
+
+	f = factorInt(pow(p, Int(5)) * 12);
+	check_factors(pow(p, Int(5)) * 12, f);
+	assert(f.back().first == p && f.back().second == 5);
+
+	Int n = pow(Int(2), Int(128)) + 1;
+	check_factors(n, factorInt(n));
+
+	n = fact(Int(30)) + 1;
+	check_factors(n, factorInt(n));
+
+	n = Int(1000000000039LL) * (pow(Int(2), Int(107)) - 1);
+	check_factors(n, factorInt(n));
+	assert(factorInt(n).size() == 2);
+
+	n = pow(pow(Int(2), Int(61)) - 1, Int(2)) * (pow(Int(2), Int(31)) - 1) * 3;
+	f = factorInt(n);
+	check_factors(n, f);
+	assert(f.size() == 3 && f[2].second == 2);
+
+	n = Int(18446744073709551557ULL) * Int(18446744073709551533ULL);
+	check_factors(n, factorInt(n));
+}
+
+int main() {
+	TEST(should_get_integer_roots)
+	TEST(should_find_factors_with_each_method)
+	TEST(should_factor_ints)
+}
@@ -0,0 +1,149 @@
+#include "gauss/Primes/Primes.hpp"
+#include "test.hpp"
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+void should_test_primality() {
+	// compare with the sieve
+	std::vector<bool> sieved(20000, false);
+
+	for (unsigned i = 0; primes[i] < 20000; i++) {
+		sieved[primes[i]] = true;
+	}
+
+	for (int n = -10; n < 20000; n++) {
+		assert(isPrime(n) == (n >= 0 && sieved[n]));
+	}
+
+	// Carmichael numbers and strong pseudoprimes to small bases
+	assert(!isPrime(561));
+	assert(!isPrime(41041));
+	assert(!isPrime(Int(3215031751LL)));
+	assert(!isPrime(Int(3825123056546413051LL)));
+
+	assert(isPrime(Int(2147483647)));
+	assert(isPrime(Int(9223372036854775783ULL)));
+	assert(isPrime(Int(18446744073709551557ULL)));
+	assert(!isPrime(Int(18446744073709551557ULL) * 3));
+
+	// Mersenne numbers
+	assert(isPrime(pow(Int(2), Int(127)) - 1));
+	assert(isPrime(pow(Int(2), Int(521)) - 1));
+	assert(!isPrime(pow(Int(2), Int(67)) - 1));
+	assert(!isPrime(pow(Int(2), Int(1009)) - 1));
+
+	Int p = pow(Int(2), Int(89)) - 1;
+	Int q = pow(Int(2), Int(107)) - 1;
+
+	assert(!isPrime(p * q));
+	assert(!isPrime(p * p));
+}
+
+void should_get_next_primes() {
+	assert(nextPrime(-5) == 2);
+	assert(nextPrime(0) == 2);
+	assert(nextPrime(2) == 3);
+	assert(nextPrime(3) == 5);
+	assert(nextPrime(24) == 29);
+	assert(nextPrime(1000000000) == Int(1000000007));
+	assert(nextPrime(4294967290ULL) == Int(4294967291ULL));
+	assert(nextPrime(4294967291ULL) == Int(4294967311ULL));
+	assert(nextPrime(pow(Int(2), Int(64))) == pow(Int(2), Int(64)) + 13);
+	assert(nextPrime(pow(Int(10), Int(30))) == pow(Int(10), Int(30)) + 57);
+}
+
+void should_get_random_primes() {
+	for (size_t bits = 2; bits < 200; bits += 13) {
+		Int p = randomPrime(bits);
+
+		assert(isPrime(p));
+		assert(p >= pow(Int(2), Int((unsigned long long)bits - 1)));
+		assert(p < pow(Int(2), Int((unsigned long long)bits)));
+	}
+}
+
+void should_sieve_primes() {
+	// compare with a plain sieve over a few segments
+	unsigned n = 3000000;
+
+	std::vector<bool> composite(n, false);
+	std::vector<unsigned> p;
+
+	for (unsigned i = 2; i < n; i++) {
+		if (!composite[i]) {
+			p.push_back(i);
+
+			for (unsigned long long j = (unsigned long long)i * i; j < n; j += i) {
+				composite[j] = true;
+			}
+		}
+	}
+
+	Primes table;
+
+	for (size_t i = 0; i < p.size(); i++) {
+		assert(table[i] == p[i]);
+	}
+
+	assert(table.countUpTo(1) == 0);
+	assert(table.countUpTo(2) == 1);
+	assert(table.countUpTo(1000000) == 78498);
+	assert(table.countUpTo(10000000) == 664579);
+	assert(table.limit() > 10000000);
+
+	assert(table.after(0) == 2);
+	assert(table.after(2) == 3);
+	assert(table.after(1000000) == 1000003);
+
+	Primes reserved(100000);
+
+	assert(reserved.count() >= 100000);
+	assert(reserved[99999] == 1299709);
+
+	assert(table.factorsOf(1).empty());
+	assert(table.factorsOf(360) == std::vector<unsigned long long>({2, 3, 5}));
+	assert(table.factorsOf(4294967291ULL) == std::vector<unsigned long long>({4294967291ULL}));
+	assert(table.factorsOf(18446744073709551557ULL) == std::vector<unsigned long long>({18446744073709551557ULL}));
+	assert(table.factorsOf(4294967291ULL * 3 * 3 * 65537) == std::vector<unsigned long long>({3, 65537, 4294967291ULL}));
+}
+
+void should_read_primes_from_many_threads() {
+	Primes table;
+
+	std::vector<std::thread> threads;
+	std::vector<unsigned long long> sums(4, 0);
+
+	for (size_t t = 0; t < sums.size(); t++) {
+		threads.push_back(std::thread([&table, &sums, t]() {
+			for (size_t i = 0; i < 300000; i++) {
+				sums[t] += table[i];
+			}
+		}));
+	}
+
+	for (size_t t = 0; t < threads.size(); t++) {
+		threads[t].join();
+	}
+
+	for (size_t t = 1; t < sums.size(); t++) {
+		assert(sums[t] == sums[0]);
+	}
+
+	unsigned long long s = 0;
+
+	for (size_t i = 0; i < 300000; i++) {
+		s += primes[i];
+	}
+
+	assert(s == sums[0]);
+}
+
+int main() {
+	TEST(should_test_primality)
+	TEST(should_get_next_primes)
+	TEST(should_get_random_primes)
+	TEST(should_sieve_primes)
+	TEST(should_read_primes_from_many_threads)
+}